@@ -23,21 +23,70 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 INCLUDEPATH += ./inc
 
+# CRC16 对大块数据使用 PCLMULQDQ 折叠(运行时检测 CPU 支持)
+contains(QT_ARCH, x86_64)|contains(QT_ARCH, i386): DEFINES += CRC16_PCLMUL
+
 SOURCES += \
+    autofocus.cpp \
+    cameradevice.cpp \
     camerathread.cpp \
+    capturestore.cpp \
     crc16.cpp \
+    diagnosticsdialog.cpp \
+    focusfusion.cpp \
+    frame.cpp \
+    framering.cpp \
+    imageexporter.cpp \
     login.cpp \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    mosaic.cpp \
+    mosaicscan.cpp \
+    motioncommand.cpp \
+    packetframer.cpp \
+    previewview.cpp \
+    profiler.cpp \
+    rawsequence.cpp \
+    recordthread.cpp \
+    seriallogmodel.cpp \
+    serialworker.cpp \
+    simulatedcamera.cpp \
+    stagemodel.cpp \
+    tilesource.cpp \
+    tileviewer.cpp \
+    zstack.cpp
 
 HEADERS += \
     CustomTitleBar.h \
+    autofocus.h \
+    cameradevice.h \
     camerathread.h \
+    capturestore.h \
     crc16.h \
+    diagnosticsdialog.h \
+    focusfusion.h \
+    frame.h \
+    framering.h \
+    imageexporter.h \
     login.h \
     mainwindow.h \
+    mosaic.h \
+    mosaicscan.h \
+    motioncommand.h \
     nncam.h \
+    packetframer.h \
+    previewview.h \
+    profiler.h \
+    rawsequence.h \
     rectItem.h \
+    recordthread.h \
+    seriallogmodel.h \
+    serialworker.h \
+    simulatedcamera.h \
+    stagemodel.h \
+    tilesource.h \
+    tileviewer.h \
+    zstack.h \
     myGraphicsScene.h
 
 FORMS += \
@@ -46,8 +95,13 @@ FORMS += \
 
 LIBS += -L$$PWD/x64 -lnncam
 
-CONFIG(debug, debug|release): LIBS += -L$$PWD/x64 -lopencv_world480d
-else:CONFIG(release, debug|release): LIBS += -L$$PWD/x64 -lopencv_world480
+win32 {
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/x64 -lopencv_world480d
+    else:CONFIG(release, debug|release): LIBS += -L$$PWD/x64 -lopencv_world480
+} else {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+}
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,14 @@
+# 顶层工程: 同时构建 ControlView 与基准测试 ControlViewBench
+# 两者各自编译共用的源文件，互不依赖；只需要应用程序时仍可直接打开 ControlView.pro
+# 基准测试使用模拟相机，不需要 nncam；x64 下没有 nncam 库时(如无相机的 Linux 构建机)只构建基准测试
+TEMPLATE = subdirs
+
+SUBDIRS += bench
+bench.file = bench/bench.pro
+
+exists($$PWD/x64/*nncam*) {
+    SUBDIRS += app
+    app.file = ControlView.pro
+} else {
+    message("nncam library not found in x64, building ControlViewBench only")
+}
@@ -0,0 +1,174 @@
+#include <opencv2/opencv.hpp>
+#include "autofocus.h"
+
+Autofocus::Autofocus(QObject *parent)
+    : QObject(parent)
+    , m_state(Idle)
+    , m_position(0), m_step(CoarseStep), m_direction(1)
+    , m_bestPosition(0), m_bestScore(0.0)
+    , m_probes(0), m_moving(false), m_moveTime(0)
+    , m_timer(new QTimer(this))
+{
+    m_sideScore[0] = m_sideScore[1] = 0.0;
+    m_sideKnown[0] = m_sideKnown[1] = false;
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &Autofocus::timeout);
+}
+
+void Autofocus::start()
+{
+    m_position = 0;
+    m_step = CoarseStep;
+    m_direction = 1;
+    m_bestPosition = 0;
+    m_bestScore = 0.0;
+    m_sideKnown[0] = m_sideKnown[1] = false;
+    m_probes = 0;
+    m_moving = false;
+    m_moveTime = frameClockNs();
+    m_state = Measuring;
+    m_timer->start(FrameTimeout);
+}
+
+void Autofocus::stop()
+{
+    if (isRunning())
+        finish(false, u8"已停止");
+}
+
+double Autofocus::sharpness(const Frame &frame)
+{
+    int width = int(frame.width());
+    int height = int(frame.height());
+    cv::Mat mat(height, width, CV_8UC3, const_cast<uchar*>(frame.data()), frame.stride());
+    cv::Mat gray;
+    cv::cvtColor(mat(cv::Rect(width / 4, height / 4, width / 2, height / 2)), gray, cv::COLOR_RGB2GRAY);
+
+    // 在预览分辨率下评价，整帧计算既慢又对噪声更敏感
+    if (gray.cols > ScoreWidth)
+        cv::resize(gray, gray, cv::Size(ScoreWidth, gray.rows * ScoreWidth / gray.cols), 0, 0, cv::INTER_AREA);
+
+    cv::Mat gx, gy;
+    cv::Sobel(gray, gx, CV_32F, 1, 0);
+    cv::Sobel(gray, gy, CV_32F, 0, 1);
+    return cv::mean(gx.mul(gx) + gy.mul(gy))[0];
+}
+
+void Autofocus::addFrame(const Frame &frame)
+{
+    if (!isRunning() || m_moving || frame.isNull())
+        return;
+
+    // 曝光开始时刻 = 到达时刻 - 曝光时间，须晚于移动后的稳定时刻
+    qint64 exposureStart = frame.arrival() - qint64(frame.params().expoTime) * 1000;
+    if (exposureStart < m_moveTime + qint64(SettleTime) * 1000000)
+        return;
+
+    if (Returning == m_state)
+    {
+        finish(true, QString());
+        return;
+    }
+
+    double score = sharpness(frame);
+    ++m_probes;
+
+    // 起点
+    if (1 == m_probes)
+    {
+        m_bestScore = score;
+        probe(m_bestPosition + m_direction * m_step);
+        return;
+    }
+
+    int ahead = m_direction > 0 ? 1 : 0;
+    if (score > m_bestScore)
+    {
+        // 变好: 原来的最清晰位置成为反方向一侧，继续沿同一方向
+        m_sideScore[1 - ahead] = m_bestScore;
+        m_sideKnown[1 - ahead] = true;
+        m_sideKnown[ahead] = false;
+        m_bestPosition = m_position;
+        m_bestScore = score;
+    }
+    else
+    {
+        m_sideScore[ahead] = score;
+        m_sideKnown[ahead] = true;
+        if (!m_sideKnown[1 - ahead])
+        {
+            m_direction = -m_direction;
+        }
+        else
+        {
+            // 两侧都变差，峰值在 ±step 以内
+            m_step /= 2;
+            m_sideKnown[0] = m_sideKnown[1] = false;
+            if (m_step < MinStep)
+            {
+                returnToBest();
+                return;
+            }
+            m_direction = m_sideScore[1] > m_sideScore[0] ? 1 : -1;
+        }
+    }
+
+    if (m_probes >= MaxProbes)
+    {
+        returnToBest();
+        return;
+    }
+    probe(m_bestPosition + m_direction * m_step);
+}
+
+void Autofocus::moveTo(qint32 position)
+{
+    qint32 steps = position - m_position;
+    m_position = position;
+    m_moveTime = frameClockNs();
+    m_timer->start(FrameTimeout);
+    if (!steps)
+        return;
+    m_moving = true;
+    emit move(steps);
+}
+
+void Autofocus::moveSent()
+{
+    if (!isRunning() || !m_moving)
+        return;
+    m_moving = false;
+    m_moveTime = frameClockNs();
+    m_timer->start(FrameTimeout);
+}
+
+void Autofocus::timeout()
+{
+    if (isRunning())
+        finish(false, u8"等待图像超时");
+}
+
+void Autofocus::probe(qint32 position)
+{
+    m_state = Measuring;
+    moveTo(position);
+}
+
+void Autofocus::returnToBest()
+{
+    if (m_position == m_bestPosition)
+    {
+        finish(true, QString());
+        return;
+    }
+    m_state = Returning;
+    moveTo(m_bestPosition);
+}
+
+void Autofocus::finish(bool ok, const QString &message)
+{
+    m_timer->stop();
+    m_state = Idle;
+    m_moving = false;
+    emit finished(ok, m_position, m_bestScore, message);
+}
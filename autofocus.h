@@ -0,0 +1,82 @@
+#ifndef AUTOFOCUS_H
+#define AUTOFOCUS_H
+
+#include <QObject>
+#include <QTimer>
+#include "frame.h"
+
+// Z 轴自动对焦
+// 爬山搜索: 沿一个方向按当前步长移动，清晰度变好就继续，变差就试另一侧，两侧都变差则步长减半，
+// 步长小于 MinStep 时回到最清晰的位置结束
+// 每次移动后只采用曝光开始时刻晚于 指令发出时刻 + 稳定时间 的帧，移动期间曝光的帧直接丢弃；
+// 指令发出时刻由调用方在移动指令全部写出串口后通过 moveSent 告知，与 ZStack/MosaicScan 相同
+// 本身不收发串口，移动通过 move 信号交给调用方，便于用合成的焦点序列离线验证
+class Autofocus : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum
+    {
+        CoarseStep = 64,        // 初始步长(步)
+        MinStep = 4,
+        SettleTime = 40,        // 最后一包移动指令发出后的稳定时间(ms)
+        FrameTimeout = 2000,    // 移动后等待有效帧的最长时间(ms)，相机不再出帧时由定时器结束
+        MaxProbes = 40,
+        ScoreWidth = 640        // 计算清晰度前把 ROI 缩小到的宽度
+    };
+
+    explicit Autofocus(QObject *parent = nullptr);
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_state != Idle; }
+
+    // move 请求的指令已全部写出串口
+    void moveSent();
+
+    // 交给每一帧，不需要的帧立即返回
+    void addFrame(const Frame &frame);
+
+    // 中央 1/2 x 1/2 区域的 Tenengrad 清晰度(Sobel 梯度平方的均值)
+    static double sharpness(const Frame &frame);
+
+    int probes() const { return m_probes; }
+
+signals:
+    // 请求 Z 轴移动 steps 步，正数为正向
+    void move(qint32 steps);
+    // position 为结束位置相对起点的步数
+    void finished(bool ok, qint32 position, double score, const QString &message);
+
+private slots:
+    void timeout();
+
+private:
+    enum State
+    {
+        Idle,
+        Measuring,      // 等待当前位置的有效帧
+        Returning       // 回到最清晰位置，等稳定后结束
+    };
+
+    void moveTo(qint32 position);
+    void probe(qint32 position);
+    void returnToBest();
+    void finish(bool ok, const QString &message);
+
+    State  m_state;
+    qint32 m_position;      // 相对起点的步数
+    qint32 m_step;
+    int    m_direction;
+    qint32 m_bestPosition;
+    double m_bestScore;
+    double m_sideScore[2];  // 当前步长下最清晰位置 -step/+step 两侧的得分
+    bool   m_sideKnown[2];
+    int    m_probes;
+    bool   m_moving;        // 已请求移动，指令尚未全部发出
+    qint64 m_moveTime;      // 最近一次移动指令发出的时刻(ns)
+    QTimer* m_timer;
+};
+
+#endif // AUTOFOCUS_H
@@ -0,0 +1,63 @@
+win32-msvc* {
+    QMAKE_CXXFLAGS += /source-charset:utf-8 /execution-charset:utf-8
+}
+
+# 帧处理链路的基准测试，与 ControlView 共用源文件
+# 使用模拟相机产生合成帧，不需要连接相机，也不链接 nncam
+QT       += core gui
+QT       -= widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = ControlViewBench
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += .. ../inc
+
+contains(QT_ARCH, x86_64)|contains(QT_ARCH, i386): DEFINES += CRC16_PCLMUL
+
+SOURCES += \
+    main.cpp \
+    ../autofocus.cpp \
+    ../camerathread.cpp \
+    ../crc16.cpp \
+    ../focusfusion.cpp \
+    ../frame.cpp \
+    ../framering.cpp \
+    ../mosaic.cpp \
+    ../motioncommand.cpp \
+    ../packetframer.cpp \
+    ../profiler.cpp \
+    ../rawsequence.cpp \
+    ../simulatedcamera.cpp \
+    ../stagemodel.cpp \
+    ../tilesource.cpp
+
+HEADERS += \
+    ../autofocus.h \
+    ../cameradevice.h \
+    ../camerathread.h \
+    ../crc16.h \
+    ../focusfusion.h \
+    ../frame.h \
+    ../framering.h \
+    ../mosaic.h \
+    ../motioncommand.h \
+    ../packetframer.h \
+    ../profiler.h \
+    ../rawsequence.h \
+    ../simulatedcamera.h \
+    ../stagemodel.h \
+    ../tilesource.h
+
+# Windows 使用随 SDK 放在 x64 下的 opencv_world；其他平台使用系统安装的 OpenCV
+# pkg-config 的头文件路径排在 INCLUDEPATH 之前，不会用到 inc 下与系统库版本不一致的 opencv2 头文件
+win32 {
+    CONFIG(debug, debug|release): LIBS += -L$$PWD/../x64 -lopencv_world480d
+    else:CONFIG(release, debug|release): LIBS += -L$$PWD/../x64 -lopencv_world480
+} else {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += opencv4
+}
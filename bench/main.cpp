@@ -0,0 +1,1262 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+#include "autofocus.h"
+#include "camerathread.h"
+#include "crc16.h"
+#include "focusfusion.h"
+#include "frame.h"
+#include "mosaic.h"
+#include "motioncommand.h"
+#include "packetframer.h"
+#include "profiler.h"
+#include "rawsequence.h"
+#include "simulatedcamera.h"
+#include "tilesource.h"
+
+// 统计 operator new 的调用次数，用于得到每帧的堆分配数
+// QImage 像素与 OpenCV Mat 的内存走 malloc / cv::fastMalloc，不在此计数内；
+// Windows 下 Qt/OpenCV DLL 内部的 new 也不经过这里
+static std::atomic<quint64> g_allocations(0);
+
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace
+{
+
+// 与 MainWindow 默认的预览区域大小一致
+const unsigned PreviewWidth = 1280;
+const unsigned PreviewHeight = 960;
+
+// 串口协议的包长: 15 字节数据 + 1 字节锁定位
+const int PacketBytes = 16;
+
+struct Result
+{
+    QString     name;
+    unsigned    width;
+    unsigned    height;
+    quint64     frames;
+    double      seconds;
+    quint64     allocations;
+    QJsonObject extra;
+
+    double fps() const { return seconds > 0 ? frames / seconds : 0; }
+    double nsPerPixel() const
+    {
+        double pixels = double(frames) * width * height;
+        return pixels > 0 ? seconds * 1e9 / pixels : 0;
+    }
+    double allocationsPerFrame() const { return frames ? double(allocations) / frames : 0; }
+
+    QJsonObject toJson() const
+    {
+        QJsonObject object;
+        object["name"] = name;
+        object["width"] = int(width);
+        object["height"] = int(height);
+        object["frames"] = double(frames);
+        object["seconds"] = seconds;
+        object["fps"] = fps();
+        object["ns_per_pixel"] = nsPerPixel();
+        object["allocs_per_frame"] = allocationsPerFrame();
+        if (!extra.isEmpty())
+            object["extra"] = extra;
+        return object;
+    }
+};
+
+// 合成帧: 随机噪声，避免编码器与缩放对纯色图像走捷径
+Frame syntheticFrame(unsigned width, unsigned height)
+{
+    Frame frame = Frame::allocate(width, height);
+    cv::Mat mat(int(height), int(width), CV_8UC3, frame.bits(), frame.stride());
+    cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(256));
+    return frame;
+}
+
+// 预热一次后循环调用 fn，直到累计时间达到 seconds
+template <typename Fn>
+Result runFor(const QString &name, unsigned width, unsigned height, double seconds, Fn fn)
+{
+    fn();
+
+    Result result;
+    result.name = name;
+    result.width = width;
+    result.height = height;
+    result.frames = 0;
+
+    quint64 allocations = g_allocations.load(std::memory_order_relaxed);
+    qint64 start = frameClockNs();
+    qint64 limit = start + qint64(seconds * 1e9);
+    qint64 now = start;
+    do
+    {
+        fn();
+        ++result.frames;
+        now = frameClockNs();
+    } while (now < limit);
+
+    result.seconds = (now - start) / 1e9;
+    result.allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+    return result;
+}
+
+// 采集链路: 模拟相机(不限速) -> cameraThread 拉取(PullMode)或接收回调数据(PushMode)并生成预览 -> FrameRing -> 主线程取帧
+// 主线程的处理与 MainWindow::handleImageCaptured 相同，帧率上限受模拟相机生成图像的速度限制
+Result runPipeline(cameraThread::AcquisitionMode mode, unsigned resolutionIndex, unsigned width, unsigned height, double seconds)
+{
+    SimulatedCamera::Config config;
+    config.fps = 0;
+    SimulatedCamera camera(config);
+    camera.put_eSize(resolutionIndex);
+
+    FrameRing ring(6, size_t(TDIBWIDTHBYTES(width * 24)) * height, FrameRing::DropOldest);
+    cameraThread thread(&camera, &ring, mode);
+    thread.setPreviewSize(PreviewWidth, PreviewHeight);
+
+    quint64 consumed = 0;
+    quint64 lastSeq = 0;
+    quint64 lost = 0;
+    QObject context;
+    QObject::connect(&thread, &cameraThread::imageCaptured, &context, [&]() {
+        Frame frame = Frame::take(&ring);
+        if (frame.isNull())
+            return;
+        Profiler::instance().record(Profiler::Deliver, frame.arrival(), frameClockNs());
+        if (frame.seq())
+        {
+            if (lastSeq && frame.seq() > lastSeq + 1)
+                lost += frame.seq() - lastSeq - 1;
+            lastSeq = frame.seq();
+        }
+        ++consumed;
+    });
+    QObject::connect(&thread, &cameraThread::previewReady, &context, [&](const QImage &, const QRectF &) {
+        thread.previewShown();
+    });
+
+    Profiler::instance().reset();
+    quint64 allocations = g_allocations.load(std::memory_order_relaxed);
+    QElapsedTimer timer;
+    timer.start();
+    thread.start();
+    thread.wait();
+
+    QEventLoop loop;
+    QTimer::singleShot(int(seconds * 1000), &loop, &QEventLoop::quit);
+    loop.exec();
+
+    Result result;
+    result.name = (cameraThread::PushMode == mode) ? "pipeline_push" : "pipeline_pull";
+    result.width = width;
+    result.height = height;
+    result.frames = consumed;
+    result.seconds = timer.nsecsElapsed() / 1e9;
+    result.allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+
+    // 停止后处理完队列中剩余的信号，lambda 引用的对象此时仍然有效
+    camera.Stop();
+    QCoreApplication::processEvents();
+
+    quint64 callbackFrames = 0, callbackNs = 0;
+    thread.takeCallbackStats(callbackFrames, callbackNs);
+    Profiler::Stats deliver = Profiler::instance().stats(Profiler::Deliver);
+    Profiler::Stats scale = Profiler::instance().stats(Profiler::Scale);
+    result.extra["ring_dropped"] = double(ring.droppedCount());
+    result.extra["lost_frames"] = double(lost);
+    result.extra["callback_ns_per_pixel"] = callbackFrames ? double(callbackNs) / (double(callbackFrames) * width * height) : 0.0;
+    result.extra["deliver_p50_us"] = deliver.p50 / 1000.0;
+    result.extra["deliver_p99_us"] = deliver.p99 / 1000.0;
+    result.extra["scale_p50_us"] = scale.p50 / 1000.0;
+    result.extra["scale_p99_us"] = scale.p99 / 1000.0;
+    return result;
+}
+
+// cameraThread::emitPreview 的缩放: INTER_AREA 后转为 Format_RGB32，写入重复使用的预览缓冲
+Result runPreviewResize(const Frame &frame, double seconds)
+{
+    QImage preview;
+    cv::Mat scratch;
+    QRectF shown;
+    return runFor("preview_resize", frame.width(), frame.height(), seconds, [&]() {
+        cameraThread::makePreview(frame.data(), frame.width(), frame.height(), frame.stride(), QRectF(0, 0, 1, 1),
+                                  QRectF(0, 0, 1, 1), PreviewWidth, PreviewHeight, preview, scratch, shown);
+    });
+}
+
+// 预览放大到 1:1 时只裁剪中央预览尺寸的区域
+Result runPreviewZoom(const Frame &frame, double seconds)
+{
+    double width = qMin(1.0, double(PreviewWidth) / frame.width());
+    double height = qMin(1.0, double(PreviewHeight) / frame.height());
+    QRectF region((1.0 - width) / 2, (1.0 - height) / 2, width, height);
+    QImage preview;
+    cv::Mat scratch;
+    QRectF shown;
+    return runFor("preview_zoom", frame.width(), frame.height(), seconds, [&]() {
+        cameraThread::makePreview(frame.data(), frame.width(), frame.height(), frame.stride(), QRectF(0, 0, 1, 1),
+                                  region, PreviewWidth, PreviewHeight, preview, scratch, shown);
+    });
+}
+
+// 预览裁剪: 整个视野与 INTER_AREA 缩小的结果相同，放大时与原图对应区域逐像素相同，
+// 硬件 ROI 的帧按 ROI 位置裁剪后得到同样的像素，平移到 ROI 之外时退回整帧
+bool crossCheckPreview(QTextStream &out)
+{
+    const int width = 1024;
+    const int height = 768;
+    Frame frame = syntheticFrame(width, height);
+    cv::Mat image(height, width, CV_8UC3, frame.bits(), frame.stride());
+    auto previewMat = [](const QImage &preview) {
+        cv::Mat rgb;
+        cv::cvtColor(cv::Mat(preview.height(), preview.width(), CV_8UC4, const_cast<uchar*>(preview.constBits()), size_t(preview.bytesPerLine())),
+                     rgb, cv::COLOR_BGRA2RGB);
+        return rgb;
+    };
+
+    QStringList failures;
+    QImage preview;
+    cv::Mat scratch;
+    QRectF full(0, 0, 1, 1);
+    QRectF shown;
+    cameraThread::makePreview(frame.data(), width, height, frame.stride(), full, full, 512, 512, preview, scratch, shown);
+    cv::Mat expected;
+    cv::resize(image, expected, cv::Size(512, 384), 0, 0, cv::INTER_AREA);
+    if (preview.size() != QSize(512, 384) || preview.format() != QImage::Format_RGB32 || shown != full
+        || cv::norm(previewMat(preview), expected, cv::NORM_INF) != 0)
+        failures << "full";
+
+    // 尺寸不变时原地写入同一缓冲
+    const uchar* bits = preview.constBits();
+    cameraThread::makePreview(frame.data(), width, height, frame.stride(), full, full, 512, 512, preview, scratch, shown);
+    if (preview.constBits() != bits)
+        failures << "reuse";
+
+    // 传感器 [256, 640) x [192, 576)，不超过最大尺寸时不缩放
+    QRectF region(0.25, 0.25, 0.375, 0.5);
+    cameraThread::makePreview(frame.data(), width, height, frame.stride(), full, region, 1280, 960, preview, scratch, shown);
+    if (preview.size() != QSize(384, 384) || shown != region
+        || cv::norm(previewMat(preview), image(cv::Rect(256, 192, 384, 384)), cv::NORM_INF) != 0)
+        failures << "zoom";
+
+    // 传感器 [128, 768) x [96, 672) 的硬件 ROI
+    cv::Mat roi = image(cv::Rect(128, 96, 640, 576)).clone();
+    QRectF roiRegion(0.125, 0.125, 0.625, 0.75);
+    cameraThread::makePreview(roi.data, 640, 576, unsigned(roi.step), roiRegion, region, 1280, 960, preview, scratch, shown);
+    if (preview.size() != QSize(384, 384) || shown != region
+        || cv::norm(previewMat(preview), image(cv::Rect(256, 192, 384, 384)), cv::NORM_INF) != 0)
+        failures << "roi";
+
+    cameraThread::makePreview(roi.data, 640, 576, unsigned(roi.step), roiRegion, QRectF(0, 0, 0.1, 0.1), 1280, 960, preview, scratch, shown);
+    if (preview.size() != QSize(640, 576) || shown != roiRegion)
+        failures << "outside roi";
+
+    bool ok = failures.isEmpty();
+    out << "preview cross-check " << (ok ? QString("passed") : "FAILED: " + failures.join(", ")) << "\n";
+    out.flush();
+    return ok;
+}
+
+// MainWindow::showCaptureTab 的缩放
+Result runImageScaled(const Frame &frame, double seconds)
+{
+    QImage image = frame.image();
+    QSize size(int(PreviewWidth), int(PreviewHeight));
+    return runFor("qimage_scaled", frame.width(), frame.height(), seconds, [&]() {
+        QImage scaled = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        Q_UNUSED(scaled);
+    });
+}
+
+// 自动对焦每个有效帧的清晰度评价
+Result runSharpness(const Frame &frame, double seconds)
+{
+    double sum = 0.0;
+    Result result = runFor("af_sharpness", frame.width(), frame.height(), seconds, [&]() {
+        sum += Autofocus::sharpness(frame);
+    });
+    Q_UNUSED(sum);
+    return result;
+}
+
+// recordThread::writeFrame 的 MJPG 路径: RGB -> BGR 后交给 VideoWriter
+Result runRecord(const Frame &frame, const QString &directory, double seconds)
+{
+    QString fileName = QDir(directory).filePath(QString("record_%1x%2.avi").arg(frame.width()).arg(frame.height()));
+    cv::Size frameSize(int(frame.width()), int(frame.height()));
+    cv::VideoWriter writer(fileName.toStdString(), cv::VideoWriter::fourcc('M','J','P','G'), 30.0, frameSize, true);
+    if (!writer.isOpened())
+    {
+        Result result;
+        result.name = "record_mjpg";
+        result.width = frame.width();
+        result.height = frame.height();
+        result.frames = 0;
+        result.seconds = 0;
+        result.allocations = 0;
+        result.extra["error"] = QString("VideoWriter open failed");
+        return result;
+    }
+
+    cv::Mat rgb(frameSize, CV_8UC3, const_cast<uchar*>(frame.data()), frame.stride());
+    cv::Mat bgr;
+    qint64 encodeNs = 0;
+    Result result = runFor("record_mjpg", frame.width(), frame.height(), seconds, [&]() {
+        qint64 start = frameClockNs();
+        cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
+        encodeNs += frameClockNs() - start;
+        writer.write(bgr);
+    });
+    writer.release();
+    QFile::remove(fileName);
+
+    // 预热的一次也计入了 encodeNs
+    result.extra["cvtcolor_ns_per_pixel"] = double(encodeNs) / (double(result.frames + 1) * frame.width() * frame.height());
+    return result;
+}
+
+// RawSequenceWriter/Reader 往返: 小分段强制多次切换分段，随机顺序读回并逐帧比较像素与元数据
+// 同一份数据再改写为版本 1 的索引(记录截断为 72 字节)，检查旧版本的读取路径
+bool crossCheckRawSequence(QTextStream &out, const QString &directory)
+{
+    const int count = 10;
+    const unsigned width = 64;
+    const unsigned height = 48;
+
+    QVector<Frame> frames;
+    for (int i = 0; i < count; ++i)
+    {
+        // 每隔几帧换一个尺寸，分段末尾的剩余空间不总是整帧
+        Frame frame = syntheticFrame(width + unsigned(i % 3) * 8, height);
+        NncamFrameInfoV3 info;
+        memset(&info, 0, sizeof(info));
+        info.width = frame.width();
+        info.height = frame.height();
+        info.flag = NNCAM_FRAMEINFO_FLAG_SEQ | NNCAM_FRAMEINFO_FLAG_TIMESTAMP;
+        info.seq = unsigned(100 + i);
+        info.timestamp = 1000000ull + quint64(i) * 33333;
+        info.expotime = unsigned(2000 + i);
+        info.expogain = ushort(100 + i);
+        frame.setInfo(info);
+        FrameParams params;
+        memset(&params, 0, sizeof(params));
+        params.expoTime = info.expotime;
+        params.expoGain = info.expogain;
+        params.temp = 6503;
+        params.tint = 1000 - i;
+        for (int axis = 0; axis < 5; ++axis)
+            params.stage[axis] = (axis + 1) * 1000 - i;
+        params.stageSource = 1;
+        frame.setParams(params);
+        frame.setArrival(qint64(i) * 1000000 + 7);
+        frames << frame;
+    }
+
+    // 每个分段只放得下两三帧
+    QString fileName = QDir(directory).filePath("sequence.rawseq");
+    RawSequenceWriter writer;
+    bool written = writer.open(fileName, qint64(frames.last().byteCount()) * 3 + 100);
+    for (int i = 0; written && i < count; ++i)
+        written = writer.write(frames[i]);
+    writer.close();
+
+    auto sameFrame = [](const Frame &a, const Frame &b, bool stage) {
+        if (a.isNull() || b.isNull() || a.width() != b.width() || a.height() != b.height() || a.stride() != b.stride()
+            || memcmp(a.data(), b.data(), a.byteCount()) != 0)
+            return false;
+        if (a.info().flag != b.info().flag || a.seq() != b.seq() || a.timestamp() != b.timestamp() || a.arrival() != b.arrival()
+            || a.params().expoTime != b.params().expoTime || a.params().expoGain != b.params().expoGain
+            || a.params().temp != b.params().temp || a.params().tint != b.params().tint)
+            return false;
+        // 版本 1 没有位移台位置，读回为 0
+        for (int axis = 0; axis < 5; ++axis)
+        {
+            if (b.params().stage[axis] != (stage ? a.params().stage[axis] : 0))
+                return false;
+        }
+        return b.params().stageSource == (stage ? a.params().stageSource : 0);
+    };
+
+    QStringList failures;
+    if (!written)
+        failures << "write";
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> pick(0, count - 1);
+    RawSequenceReader reader;
+    int segments = 0;
+    if (!reader.open(fileName) || reader.frameCount() != count)
+    {
+        failures << "open";
+    }
+    else
+    {
+        segments = int(reader.record(count - 1).segment) + 1;
+        if (segments < 3)
+            failures << "segments";
+        for (int n = 0; n < 3 * count; ++n)
+        {
+            int i = pick(rng);
+            if (!sameFrame(frames[i], reader.readFrame(i), true))
+            {
+                failures << QString("frame %1").arg(i);
+                break;
+            }
+        }
+        if (!reader.readFrame(count).isNull())
+            failures << "range";
+    }
+    reader.close();
+
+    // 版本 1 索引: completeBaseName 相同，共用上面的分段文件
+    QFile index(fileName);
+    QByteArray data = index.open(QIODevice::ReadOnly) ? index.readAll() : QByteArray();
+    index.close();
+    const int headerSize = 16;
+    const int recordSizeV1 = 72;
+    QString fileNameV1 = QDir(directory).filePath("sequence.v1");
+    QFile indexV1(fileNameV1);
+    if (data.size() == headerSize + count * int(sizeof(RawFrameRecord)) && indexV1.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QByteArray header = data.left(headerSize);
+        qToLittleEndian<quint32>(1, reinterpret_cast<uchar*>(header.data()) + 8);
+        qToLittleEndian<quint32>(recordSizeV1, reinterpret_cast<uchar*>(header.data()) + 12);
+        indexV1.write(header);
+        for (int i = 0; i < count; ++i)
+            indexV1.write(data.mid(headerSize + i * int(sizeof(RawFrameRecord)), recordSizeV1));
+        // 录制中断留下的不完整记录被忽略
+        indexV1.write(data.mid(headerSize, recordSizeV1 / 2));
+        indexV1.close();
+
+        if (!reader.open(fileNameV1) || reader.frameCount() != count)
+        {
+            failures << "open v1";
+        }
+        else
+        {
+            for (int n = 0; n < count; ++n)
+            {
+                int i = pick(rng);
+                if (!sameFrame(frames[i], reader.readFrame(i), false))
+                {
+                    failures << QString("v1 frame %1").arg(i);
+                    break;
+                }
+            }
+        }
+        reader.close();
+    }
+    else
+    {
+        failures << "index v1";
+    }
+
+    // 损坏的索引: 不存在的分段号、超出分段的偏移都返回空帧，其余记录照常读取
+    QString fileNameBad = QDir(directory).filePath("sequence.bad");
+    QFile indexBad(fileNameBad);
+    if (data.size() == headerSize + count * int(sizeof(RawFrameRecord)) && indexBad.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QByteArray bad = data;
+        RawFrameRecord* records = reinterpret_cast<RawFrameRecord*>(bad.data() + headerSize);
+        records[0].segment = 0xFFFFFFFFu;
+        records[1].segment = quint32(segments);
+        records[2].offset = ~quint64(0) - 16;
+        indexBad.write(bad);
+        indexBad.close();
+        if (!reader.open(fileNameBad) || !reader.readFrame(0).isNull() || !reader.readFrame(1).isNull()
+            || !reader.readFrame(2).isNull() || !sameFrame(frames[3], reader.readFrame(3), true))
+            failures << "corrupt index";
+        reader.close();
+    }
+    else
+    {
+        failures << "index corrupt";
+    }
+
+    bool ok = failures.isEmpty();
+    out << "raw sequence cross-check " << (ok ? QString("passed") : "FAILED: " + failures.join(", "))
+        << ": " << count << " frames, " << segments << " segments\n";
+    out.flush();
+    return ok;
+}
+
+typedef uint16_t (*CrcUpdate)(uint16_t crc, const void *data, size_t size);
+
+// CRC16 的一种实现对 size 字节数据的吞吐，ns_per_pixel 按 width x height 折算
+Result runCrc(const QString &name, CrcUpdate update, const void *data, size_t size, unsigned width, unsigned height, double seconds)
+{
+    volatile uint16_t sink = 0;
+    Result result = runFor(name, width, height, seconds, [&]() {
+        sink = CRC16::finalize(update(CRC16::init(), data, size));
+    });
+    Q_UNUSED(sink);
+    result.extra["ns_per_byte"] = result.frames ? result.seconds * 1e9 / (double(result.frames) * size) : 0.0;
+    return result;
+}
+
+// 整帧数据(3 字节/像素): CRC16::update 实际选用的实现、查表与逐位参考实现
+void runCrcFrame(QList<Result> &results, const Frame &frame, double seconds)
+{
+    results << runCrc("crc16", CRC16::update, frame.data(), frame.byteCount(), frame.width(), frame.height(), seconds);
+    results << runCrc("crc16_table", CRC16::updateTable, frame.data(), frame.byteCount(), frame.width(), frame.height(), seconds);
+    results << runCrc("crc16_bitwise", CRC16::updateBitwise, frame.data(), frame.byteCount(), frame.width(), frame.height(), seconds);
+}
+
+// 串口包大小，width 记为包长，height 为 1
+void runCrcPacket(QList<Result> &results, double seconds)
+{
+    uint8_t packet[PacketBytes];
+    for (int i = 0; i < PacketBytes; ++i)
+        packet[i] = uint8_t(i * 37 + 11);
+    results << runCrc("crc16_packet", CRC16::update, packet, sizeof(packet), PacketBytes, 1, seconds);
+    results << runCrc("crc16_packet_bit", CRC16::updateBitwise, packet, sizeof(packet), PacketBytes, 1, seconds);
+}
+
+// 各长度、各起始对齐、分段增量计算的结果都必须与逐位参考实现一致
+bool crossCheckCrc(QTextStream &out)
+{
+    std::vector<uint8_t> data(4096 + 16);
+    cv::Mat mat(1, int(data.size()), CV_8U, data.data());
+    cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    int failures = 0;
+    for (size_t size = 0; size <= 4096; size += (size < 300 ? 1 : 61))
+    {
+        for (size_t offset = 0; offset < 16; offset += 5)
+        {
+            const uint8_t* p = data.data() + offset;
+            uint16_t seed = uint16_t(0xFFFF - size);
+            uint16_t expected = CRC16::updateBitwise(seed, p, size);
+            size_t half = size / 3;
+            uint16_t split = CRC16::update(CRC16::update(seed, p, half), p + half, size - half);
+            if (CRC16::updateTable(seed, p, size) != expected || CRC16::updatePclmul(seed, p, size) != expected
+                || CRC16::update(seed, p, size) != expected || split != expected)
+            {
+                if (++failures <= 5)
+                    out << "crc16 mismatch: size " << size << " offset " << offset << "\n";
+            }
+        }
+    }
+
+    // CRC-16/MODBUS 的标准校验值
+    if (CRC16::calculate("123456789", 9) != 0x4B37)
+    {
+        ++failures;
+        out << "crc16 check value mismatch\n";
+    }
+    out << "crc16 cross-check " << (failures ? "FAILED" : "passed") << (CRC16::hasPclmul() ? " (pclmul)" : " (table)") << "\n";
+    out.flush();
+    return failures == 0;
+}
+
+// 合成位移台应答流，约 30% 的包被破坏: 位翻转、丢一个字节、包前插入噪声(噪声之后的包完好)
+// intact 收到应当被正确解出的包
+QByteArray syntheticStageStream(int packets, std::mt19937 &rng, QVector<StageStatus> *intact)
+{
+    QByteArray stream;
+    stream.reserve(packets * (PacketFramer::PacketSize + 8));
+    uchar packet[PacketFramer::PacketSize];
+    for (int i = 0; i < packets; ++i)
+    {
+        packet[0] = PacketFramer::StartByte;
+        for (int j = 1; j <= PacketFramer::PayloadSize + 1; ++j)
+            packet[j] = uchar(rng());
+        uint16_t crc = CRC16::calculate(packet + 1, PacketFramer::PayloadSize + 1);
+        packet[PacketFramer::PayloadSize + 2] = uchar(crc & 0xFF);
+        packet[PacketFramer::PayloadSize + 3] = uchar(crc >> 8);
+        packet[PacketFramer::PacketSize - 1] = PacketFramer::EndByte;
+
+        switch (rng() % 10)
+        {
+        case 0:
+            packet[1 + rng() % (PacketFramer::PacketSize - 1)] ^= uchar(1u << (rng() % 8));
+            stream.append(reinterpret_cast<const char*>(packet), PacketFramer::PacketSize);
+            break;
+        case 1:
+        {
+            int drop = int(rng() % PacketFramer::PacketSize);
+            stream.append(reinterpret_cast<const char*>(packet), drop);
+            stream.append(reinterpret_cast<const char*>(packet) + drop + 1, PacketFramer::PacketSize - drop - 1);
+            break;
+        }
+        case 2:
+            for (int n = int(rng() % 24); n > 0; --n)
+                stream.append(char((rng() % 3) ? rng() : PacketFramer::StartByte));
+            // fall through
+        default:
+            stream.append(reinterpret_cast<const char*>(packet), PacketFramer::PacketSize);
+            if (intact)
+                intact->append(PacketFramer::decode(packet));
+            break;
+        }
+    }
+    return stream;
+}
+
+bool sameStatus(const StageStatus &a, const StageStatus &b)
+{
+    return a.t == b.t && a.r == b.r && a.x == b.x && a.y == b.y && a.z == b.z && a.flags == b.flags && a.locked == b.locked;
+}
+
+// 把数据按 1~64 字节的随机长度分段送入分帧器，模拟每次 readAll 读到的长度不定
+void feedChunked(PacketFramer &framer, const QByteArray &stream, std::mt19937 &rng, QVector<StageStatus> &out)
+{
+    int pos = 0;
+    while (pos < stream.size())
+    {
+        int n = qMin(int(1 + rng() % 64), stream.size() - pos);
+        framer.feed(stream.constData() + pos, n, out);
+        pos += n;
+    }
+}
+
+// 破坏的包不能解出，完好的包必须按顺序全部解出
+bool crossCheckFramer(QTextStream &out)
+{
+    std::mt19937 rng(20240601);
+    QVector<StageStatus> expected;
+    QByteArray stream = syntheticStageStream(20000, rng, &expected);
+
+    PacketFramer framer;
+    QVector<StageStatus> decoded;
+    feedChunked(framer, stream, rng, decoded);
+
+    bool ok = decoded.size() == expected.size();
+    for (int i = 0; ok && i < decoded.size(); ++i)
+        ok = sameStatus(decoded[i], expected[i]);
+
+    const PacketFramer::Stats& stats = framer.stats();
+    out << "framer cross-check " << (ok ? "passed" : "FAILED") << ": " << decoded.size() << "/" << expected.size()
+        << " packets, crc " << stats.crcErrors << ", framing " << stats.framingErrors << ", discarded " << stats.discarded << "\n";
+    out.flush();
+    return ok;
+}
+
+// 按原先 MainWindow::createPacket 的方式由数据区拼出整包，CRC 用逐位参考实现
+QByteArray legacyPacket(const QByteArray &data, bool locked)
+{
+    QByteArray packet;
+    packet.append(char(0x55));
+    packet.append(data);
+    packet.append(char(locked ? 0x01 : 0x00));
+    uint16_t crc = CRC16::updateBitwise(CRC16::init(), packet.constData() + 1, size_t(packet.size() - 1));
+    packet.append(char(crc & 0xFF));
+    packet.append(char(crc >> 8));
+    packet.append(char(0xAA));
+    return packet;
+}
+
+// MotionCommand 的编码必须与原先写死的各指令数据区逐字节一致
+bool crossCheckMotion(QTextStream &out)
+{
+    struct Case
+    {
+        const char*      hex;
+        StageModel::Axis axis;
+        qint32           steps;
+    };
+    const Case cases[] = {
+        { "000000000000000002000200020000", StageModel::X, 0 },
+        { "000000000000000102000200020000", StageModel::R, 1 },
+        { "00000000ffffffff02000200020000", StageModel::R, -1 },
+        { "000000010000000002000200020000", StageModel::T, 1 },
+        { "ffffffff0000000002000200020000", StageModel::T, -1 },
+        { "000000000000006402000200020000", StageModel::R, MotionCommand::MediumSpeed },
+        { "00000000ffffff9c02000200020000", StageModel::R, -MotionCommand::MediumSpeed },
+        { "000000640000000002000200020000", StageModel::T, MotionCommand::MediumSpeed },
+        { "ffffff9c0000000002000200020000", StageModel::T, -MotionCommand::MediumSpeed },
+        { "00000000000003e802000200020000", StageModel::R, MotionCommand::HighSpeed },
+        { "00000000fffffc1802000200020000", StageModel::R, -MotionCommand::HighSpeed },
+        { "000003e80000000002000200020000", StageModel::T, MotionCommand::HighSpeed },
+        { "fffffc180000000002000200020000", StageModel::T, -MotionCommand::HighSpeed },
+        { "0000000000000000020001ff020000", StageModel::Y, 1 },
+        { "000000000000000002000201020000", StageModel::Y, -1 },
+        { "000000000000000001ff0200020000", StageModel::X, 1 },
+        { "000000000000000002010200020000", StageModel::X, -1 },
+        { "00000000000000000200020001ff00", StageModel::Z, 1 },
+        { "000000000000000002000200020100", StageModel::Z, -1 },
+    };
+
+    int failures = 0;
+    int checked = 0;
+    for (int locked = 0; locked < 2; ++locked)
+    {
+        for (const Case& c : cases)
+        {
+            MotionPacket packet = MotionCommand::move(c.axis, c.steps, locked != 0).packet();
+            ++checked;
+            if (QByteArray(packet.data(), MotionPacket::size()) != legacyPacket(QByteArray::fromHex(c.hex), locked != 0))
+            {
+                if (++failures <= 5)
+                    out << "motion mismatch: " << c.hex << (locked ? " locked" : "") << "\n";
+            }
+        }
+
+        MotionCommand bigShift;
+        bigShift.setLocked(locked != 0);
+        bigShift.setBigShift(true);
+        ++checked;
+        if (QByteArray(bigShift.packet().data(), MotionPacket::size())
+            != legacyPacket(QByteArray::fromHex("000000000000000002000200020020"), locked != 0))
+        {
+            ++failures;
+            out << "motion mismatch: big shift" << (locked ? " locked" : "") << "\n";
+        }
+    }
+
+    // 档位滑动条: 原先把 0x01ff - 档位 / 0x0201 + 档位 写入 X/Y/Z 字段
+    for (int value = 0; value <= 478; ++value)
+    {
+        for (int axis = StageModel::X; axis <= StageModel::Z; ++axis)
+        {
+            int offset = 8 + 2 * (axis - StageModel::X);
+            QByteArray forward = QByteArray::fromHex("000000000000000002000200020000");
+            QByteArray backward = forward;
+            forward[offset] = char((0x01ff - value) >> 8);
+            forward[offset + 1] = char((0x01ff - value) & 0xFF);
+            backward[offset] = char((0x0201 + value) >> 8);
+            backward[offset + 1] = char((0x0201 + value) & 0xFF);
+
+            MotionPacket f = MotionCommand::move(StageModel::Axis(axis), value + 1, false).packet();
+            MotionPacket b = MotionCommand::move(StageModel::Axis(axis), -(value + 1), false).packet();
+            checked += 2;
+            if (QByteArray(f.data(), MotionPacket::size()) != legacyPacket(forward, false)
+                || QByteArray(b.data(), MotionPacket::size()) != legacyPacket(backward, false))
+            {
+                if (++failures <= 5)
+                    out << "motion mismatch: axis " << axis << " step " << value << "\n";
+            }
+        }
+    }
+
+    // 编码出的包必须能被应答分帧器原样解出
+    MotionPacket packet = MotionCommand::move(StageModel::T, -MotionCommand::HighSpeed, true).packet();
+    PacketFramer framer;
+    QVector<StageStatus> decoded;
+    framer.feed(packet.data(), MotionPacket::size(), decoded);
+    if (decoded.size() != 1 || decoded[0].t != -MotionCommand::HighSpeed || !decoded[0].locked || decoded[0].x != MotionCommand::AxisNeutral)
+    {
+        ++failures;
+        out << "motion packet rejected by framer\n";
+    }
+
+    out << "motion cross-check " << (failures ? "FAILED" : "passed") << ": " << checked << " packets\n";
+    out.flush();
+    return failures == 0;
+}
+
+// 指令编码，width 记为包长，height 为 1
+Result runMotion(double seconds)
+{
+    MotionCommand command;
+    MotionPacket packet;
+    qint32 steps = 0;
+    return runFor("motion_encode", unsigned(MotionPacket::size()), 1, seconds, [&]() {
+        command.setSteps(StageModel::X, (++steps & 0xFF) - 0x80);
+        command.encode(packet);
+    });
+}
+
+// 合成焦点序列: 随机纹理按离焦距离做高斯模糊，对焦必须停在焦点 MinStep 以内
+// 帧的到达时刻设在稳定时间之后，按 30fps 预览估算实际耗时
+bool crossCheckAutofocus(QTextStream &out)
+{
+    Frame texture = syntheticFrame(PreviewWidth, PreviewHeight);
+    cv::Mat source(int(PreviewHeight), int(PreviewWidth), CV_8UC3, texture.bits(), texture.stride());
+    Frame frame = Frame::allocate(PreviewWidth, PreviewHeight);
+    cv::Mat blurred(int(PreviewHeight), int(PreviewWidth), CV_8UC3, frame.bits(), frame.stride());
+
+    const qint32 focusPositions[] = { 0, 37, -150, 300 };
+    int failures = 0;
+    for (qint32 focus : focusPositions)
+    {
+        Autofocus autofocus;
+        qint32 z = 0;
+        bool ok = false;
+        // 模拟串口线程立即写出指令
+        QObject::connect(&autofocus, &Autofocus::move, [&](qint32 steps) { z += steps; autofocus.moveSent(); });
+        QObject::connect(&autofocus, &Autofocus::finished, [&](bool success, qint32, double, const QString &) { ok = success; });
+
+        autofocus.start();
+        int frames = 0;
+        while (autofocus.isRunning() && frames < 4 * Autofocus::MaxProbes)
+        {
+            double sigma = 0.3 + std::abs(z - focus) / 16.0;
+            cv::GaussianBlur(source, blurred, cv::Size(0, 0), sigma);
+            frame.setArrival(frameClockNs() + qint64(Autofocus::SettleTime + 1) * 1000000);
+            autofocus.addFrame(frame);
+            ++frames;
+        }
+
+        bool passed = ok && std::abs(z - focus) <= Autofocus::MinStep;
+        if (!passed)
+            ++failures;
+        out << "autofocus focus " << focus << ": stopped at " << z << ", " << autofocus.probes() << " probes, ~"
+            << autofocus.probes() * (Autofocus::SettleTime + 33) << " ms" << (passed ? "" : " FAILED") << "\n";
+    }
+    out << "autofocus cross-check " << (failures ? "FAILED" : "passed") << "\n";
+    out.flush();
+    return failures == 0;
+}
+
+// 合成 Z 堆栈: 每层只有一条水平带是清晰的，其余部分模糊，融合结果应接近全清晰的原图
+bool crossCheckFusion(QTextStream &out)
+{
+    const int planes = 5;
+    Frame sharp = syntheticFrame(PreviewWidth, PreviewHeight);
+    cv::Mat source(int(PreviewHeight), int(PreviewWidth), CV_8UC3, sharp.bits(), sharp.stride());
+    cv::Mat blurred;
+    cv::GaussianBlur(source, blurred, cv::Size(0, 0), 3.0);
+
+    QVector<Frame> stack;
+    int band = int(PreviewHeight) / planes;
+    for (int k = 0; k < planes; ++k)
+    {
+        Frame plane = Frame::allocate(PreviewWidth, PreviewHeight);
+        cv::Mat mat(int(PreviewHeight), int(PreviewWidth), CV_8UC3, plane.bits(), plane.stride());
+        blurred.copyTo(mat);
+        cv::Rect rect(0, k * band, int(PreviewWidth), band);
+        source(rect).copyTo(mat(rect));
+        stack.append(plane);
+    }
+
+    Frame fused = FocusFusion::fuse(stack);
+    if (fused.isNull())
+    {
+        out << "fusion cross-check FAILED: no result\n";
+        return false;
+    }
+
+    // 与原图的 PSNR 须明显高于任何单层(单层最多只有 1/planes 清晰)
+    cv::Mat result(int(PreviewHeight), int(PreviewWidth), CV_8UC3, const_cast<uchar*>(fused.data()), fused.stride());
+    double best = 0.0;
+    for (const Frame& plane : stack)
+    {
+        cv::Mat mat(int(PreviewHeight), int(PreviewWidth), CV_8UC3, const_cast<uchar*>(plane.data()), plane.stride());
+        best = qMax(best, cv::PSNR(mat, source));
+    }
+    double psnr = cv::PSNR(result, source);
+    bool ok = psnr > best + 3.0;
+    out << "fusion cross-check " << (ok ? "passed" : "FAILED") << ": psnr " << QString::number(psnr, 'f', 1)
+        << " dB, best single plane " << QString::number(best, 'f', 1) << " dB\n";
+    out.flush();
+    return ok;
+}
+
+// 20 层景深融合，各层共享同一帧的像素，耗时与内容无关
+Result runFusion(const Frame &frame, double seconds)
+{
+    QVector<Frame> stack(20, frame);
+    return runFor("edf_fusion_20", frame.width(), frame.height(), seconds, [&]() {
+        Frame fused = FocusFusion::fuse(stack);
+        Q_UNUSED(fused);
+    });
+}
+
+// 合成拼接: 从一张平滑纹理上按带随机偏差的网格截取图像，蛇形顺序加入，
+// 相邻两张放置后的相对位置与真实值之差不超过 1 像素，并能写出分块金字塔
+bool crossCheckMosaic(QTextStream &out, const QString &directory)
+{
+    const int columns = 4;
+    const int rows = 3;
+    const int width = 640;
+    const int height = 480;
+    const int jitter = 12;
+    const double overlap = 0.2;
+    const double stepX = width * (1.0 - overlap);
+    const double stepY = height * (1.0 - overlap);
+
+    std::mt19937 rng(1);
+    cv::Mat texture(int(stepY * (rows - 1)) + height + 4 * jitter, int(stepX * (columns - 1)) + width + 4 * jitter, CV_8UC3);
+    cv::randu(texture, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::GaussianBlur(texture, texture, cv::Size(0, 0), 3.0);
+    cv::normalize(texture, texture, 0, 255, cv::NORM_MINMAX);
+
+    Mosaic mosaic(columns, rows, overlap);
+    std::uniform_int_distribution<int> offset(-jitter, jitter);
+    QVector<cv::Point> truth(columns * rows), placed(columns * rows);
+    int unregistered = 0;
+    for (int index = 0; index < columns * rows; ++index)
+    {
+        int row = index / columns;
+        int column = row % 2 ? columns - 1 - index % columns : index % columns;
+        cv::Rect rect(2 * jitter + int(column * stepX) + offset(rng), 2 * jitter + int(row * stepY) + offset(rng), width, height);
+
+        Frame tile = Frame::allocate(unsigned(width), unsigned(height));
+        cv::Mat mat(height, width, CV_8UC3, tile.bits(), tile.stride());
+        texture(rect).copyTo(mat);
+        Mosaic::Placement placement = mosaic.add(tile, column, row);
+        if (index > 0 && !placement.registered)
+            ++unregistered;
+        truth[row * columns + column] = rect.tl();
+        placed[row * columns + column] = cv::Point(cvRound(placement.x), cvRound(placement.y));
+    }
+
+    int worst = 0;
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int column = 0; column < columns; ++column)
+        {
+            int index = row * columns + column;
+            if (column + 1 < columns)
+            {
+                cv::Point error = (placed[index + 1] - placed[index]) - (truth[index + 1] - truth[index]);
+                worst = qMax(worst, qMax(std::abs(error.x), std::abs(error.y)));
+            }
+            if (row + 1 < rows)
+            {
+                cv::Point error = (placed[index + columns] - placed[index]) - (truth[index + columns] - truth[index]);
+                worst = qMax(worst, qMax(std::abs(error.x), std::abs(error.y)));
+            }
+        }
+    }
+
+    QDir dir(directory + "/mosaic");
+    bool saved = mosaic.save(dir.path()) && QFile::exists(dir.filePath("mosaic.ini")) && QFile::exists(dir.filePath("0/0_0.jpg"));
+    bool ok = unregistered == 0 && worst <= 1 && saved;
+    out << "mosaic cross-check " << (ok ? "passed" : "FAILED") << ": worst seam error " << worst << " px, "
+        << unregistered << " unregistered, " << mosaic.levels() << " levels" << (saved ? "" : ", save failed") << "\n";
+    out.flush();
+    return ok;
+}
+
+// 两张图像的配准与融合(含金字塔更新)，第二张与第一张相邻
+Result runMosaic(const Frame &frame, double seconds)
+{
+    return runFor("mosaic_add_2", frame.width(), frame.height(), seconds, [&]() {
+        Mosaic mosaic(2, 1, 0.2);
+        mosaic.add(frame, 0, 0);
+        mosaic.add(frame, 1, 0);
+    });
+}
+
+// 与 CaptureStore 相同的抓拍文件: RawFrameRecord + RGB24 像素
+QString writeCaptureFile(const Frame &frame, const QString &directory, RawFrameRecord &record)
+{
+    QString fileName = QDir(directory).filePath(QString("tiles_%1x%2.raw").arg(frame.width()).arg(frame.height()));
+    record = rawFrameRecord(frame);
+    record.offset = sizeof(RawFrameRecord);
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(reinterpret_cast<const char*>(&record), sizeof(record)) != qint64(sizeof(record))
+        || file.write(reinterpret_cast<const char*>(frame.data()), qint64(frame.byteCount())) != qint64(frame.byteCount()))
+        return QString();
+    return fileName;
+}
+
+// 块的像素与原图一致: level 0 逐像素相同，level 1 与对应区域 INTER_AREA 缩小的结果相同，边缘块尺寸向上取整
+bool crossCheckTiles(QTextStream &out, const QString &directory)
+{
+    const int width = 1000;
+    const int height = 700;
+    Frame frame = syntheticFrame(width, height);
+    RawFrameRecord record;
+    QString fileName = writeCaptureFile(frame, directory, record);
+
+    QStringList failures;
+    {
+        RawTileSource source(fileName, record);
+        cv::Mat image(height, width, CV_8UC3, frame.bits(), frame.stride());
+        auto tileMat = [](const QImage &tile) {
+            cv::Mat rgb;
+            cv::cvtColor(cv::Mat(tile.height(), tile.width(), CV_8UC4, const_cast<uchar*>(tile.constBits()), size_t(tile.bytesPerLine())),
+                         rgb, cv::COLOR_BGRA2RGB);
+            return rgb;
+        };
+
+        if (!source.isValid() || source.levels() != 3)
+            failures << QString("levels %1").arg(source.levels());
+
+        QImage tile = source.tile(0, 1, 1);
+        if (tile.size() != QSize(256, 256) || cv::norm(tileMat(tile), image(cv::Rect(256, 256, 256, 256)), cv::NORM_INF) != 0)
+            failures << "level 0";
+
+        tile = source.tile(0, 3, 2);
+        if (tile.size() != QSize(width - 768, height - 512))
+            failures << "edge size";
+
+        cv::Mat expected;
+        cv::resize(image(cv::Rect(0, 0, 512, 512)), expected, cv::Size(256, 256), 0, 0, cv::INTER_AREA);
+        tile = source.tile(1, 0, 0);
+        if (tile.size() != QSize(256, 256) || cv::norm(tileMat(tile), expected, cv::NORM_INF) != 0)
+            failures << "level 1";
+
+        tile = source.tile(2, 0, 0);
+        if (tile.size() != QSize((width + 3) / 4, (height + 3) / 4))
+            failures << "top size";
+        if (!source.tile(2, 1, 0).isNull())
+            failures << "outside";
+    }
+    QFile::remove(fileName);
+
+    bool ok = failures.isEmpty();
+    out << "tiles cross-check " << (ok ? QString("passed") : "FAILED: " + failures.join(", ")) << "\n";
+    out.flush();
+    return ok;
+}
+
+// 生成整幅图像第 level 级的全部块，相当于在该缩放下平移浏览一遍
+Result runTiles(const Frame &frame, const QString &directory, int level, double seconds)
+{
+    RawFrameRecord record;
+    QString fileName = writeCaptureFile(frame, directory, record);
+    Result result;
+    {
+        RawTileSource source(fileName, record);
+        int span = TileSource::TileSize << level;
+        int columns = (int(frame.width()) + span - 1) / span;
+        int rows = (int(frame.height()) + span - 1) / span;
+        result = runFor(QString("tiles_level%1").arg(level), frame.width(), frame.height(), seconds, [&]() {
+            for (int y = 0; y < rows; ++y)
+            {
+                for (int x = 0; x < columns; ++x)
+                {
+                    QImage tile = source.tile(level, x, y);
+                    Q_UNUSED(tile);
+                }
+            }
+        });
+    }
+    QFile::remove(fileName);
+    return result;
+}
+
+// 分帧吞吐，width 记为流的字节数，ns_per_pixel 即每字节耗时
+Result runFramer(double seconds)
+{
+    std::mt19937 rng(1);
+    QByteArray stream = syntheticStageStream(4096, rng, nullptr);
+    PacketFramer framer;
+    QVector<StageStatus> decoded;
+    decoded.reserve(4096);
+    return runFor("framer", unsigned(stream.size()), 1, seconds, [&]() {
+        decoded.clear();
+        for (int pos = 0; pos < stream.size(); pos += 64)
+            framer.feed(stream.constData() + pos, qMin(64, stream.size() - pos), decoded);
+    });
+}
+
+// 回放录下的串口字节流
+QJsonObject replayStream(const QString &fileName, QTextStream &out)
+{
+    QJsonObject object;
+    object["file"] = fileName;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        out << "failed to open " << fileName << "\n";
+        object["error"] = QString("open failed");
+        return object;
+    }
+
+    QByteArray stream = file.readAll();
+
+    // SerialWorker 的转储文件只取接收方向的记录，其他文件按原始字节流处理
+    if (stream.startsWith("CVSERIAL"))
+    {
+        QByteArray received;
+        int pos = 8;
+        while (pos + 12 <= stream.size())
+        {
+            const uchar* header = reinterpret_cast<const uchar*>(stream.constData() + pos);
+            int length = qFromLittleEndian<quint16>(header + 10);
+            if (pos + 12 + length > stream.size())
+                break;
+            if (0 == header[8])
+                received.append(stream.constData() + pos + 12, length);
+            pos += 12 + length;
+        }
+        stream = received;
+    }
+
+    std::mt19937 rng(1);
+    PacketFramer framer;
+    QVector<StageStatus> decoded;
+    feedChunked(framer, stream, rng, decoded);
+
+    const PacketFramer::Stats& stats = framer.stats();
+    object["bytes"] = stream.size();
+    object["packets"] = double(stats.packets);
+    object["crc_errors"] = double(stats.crcErrors);
+    object["framing_errors"] = double(stats.framingErrors);
+    object["discarded"] = double(stats.discarded);
+    out << "replay " << fileName << ": " << stream.size() << " bytes, " << stats.packets << " packets, crc "
+        << stats.crcErrors << ", framing " << stats.framingErrors << ", discarded " << stats.discarded << "\n";
+    out.flush();
+    return object;
+}
+
+void printResult(QTextStream &out, const Result &result)
+{
+    out << qSetFieldWidth(16) << left << result.name
+        << qSetFieldWidth(12) << right << QString("%1x%2").arg(result.width).arg(result.height)
+        << QString::number(result.fps(), 'f', 1)
+        << QString::number(result.nsPerPixel(), 'f', 3)
+        << QString::number(result.allocationsPerFrame(), 'f', 2)
+        << qSetFieldWidth(0) << "\n";
+    out.flush();
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ControlViewBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Frame pipeline benchmark");
+    parser.addHelpOption();
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "Result file (JSON).", "file", "bench_result.json");
+    QCommandLineOption secondsOption(QStringList() << "s" << "seconds", "Duration of each case.", "seconds", "2");
+    QCommandLineOption resolutionOption(QStringList() << "r" << "resolution", "Only run this resolution index.", "index");
+    parser.addOption(outputOption);
+    parser.addOption(secondsOption);
+    QCommandLineOption replayOption("replay", "Feed a recorded serial byte stream through the packet framer.", "file");
+    parser.addOption(resolutionOption);
+    parser.addOption(replayOption);
+    parser.process(app);
+
+    double seconds = qMax(0.1, parser.value(secondsOption).toDouble());
+    QTemporaryDir scratch(QDir::tempPath() + "/ControlViewBench-XXXXXX");
+    if (!scratch.isValid())
+    {
+        qWarning("Failed to create scratch directory");
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    bool crcValid = crossCheckCrc(out);
+    bool framerValid = crossCheckFramer(out);
+    bool motionValid = crossCheckMotion(out);
+    bool autofocusValid = crossCheckAutofocus(out);
+    bool fusionValid = crossCheckFusion(out);
+    bool mosaicValid = crossCheckMosaic(out, scratch.path());
+    bool tilesValid = crossCheckTiles(out, scratch.path());
+    bool previewValid = crossCheckPreview(out);
+    bool rawSequenceValid = crossCheckRawSequence(out, scratch.path());
+    QJsonObject replay;
+    if (parser.isSet(replayOption))
+        replay = replayStream(parser.value(replayOption), out);
+
+    out << qSetFieldWidth(16) << left << "case"
+        << qSetFieldWidth(12) << right << "size" << "frames/s" << "ns/pixel" << "allocs/frame"
+        << qSetFieldWidth(0) << "\n";
+
+    QList<Result> results;
+    int printed = 0;
+    const NncamModelV2* model = SimulatedCamera::model();
+    for (unsigned i = 0; i < model->preview; ++i)
+    {
+        if (parser.isSet(resolutionOption) && parser.value(resolutionOption).toUInt() != i)
+            continue;
+
+        unsigned width = model->res[i].width;
+        unsigned height = model->res[i].height;
+        Frame frame = syntheticFrame(width, height);
+
+        results << runPipeline(cameraThread::PullMode, i, width, height, seconds);
+        results << runPipeline(cameraThread::PushMode, i, width, height, seconds);
+        results << runPreviewResize(frame, seconds);
+        results << runPreviewZoom(frame, seconds);
+        results << runImageScaled(frame, seconds);
+        results << runRecord(frame, scratch.path(), seconds);
+        results << runSharpness(frame, seconds);
+        results << runFusion(frame, seconds);
+        results << runMosaic(frame, seconds);
+        results << runTiles(frame, scratch.path(), 0, seconds);
+        results << runTiles(frame, scratch.path(), 2, seconds);
+        runCrcFrame(results, frame, seconds);
+        for (; printed < results.size(); ++printed)
+            printResult(out, results[printed]);
+    }
+    runCrcPacket(results, seconds);
+    results << runFramer(seconds);
+    results << runMotion(seconds);
+    for (; printed < results.size(); ++printed)
+        printResult(out, results[printed]);
+
+    QJsonArray array;
+    for (const Result& result : results)
+        array.append(result.toJson());
+
+    QJsonObject root;
+    root["version"] = 1;
+    root["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["qt"] = QString(qVersion());
+    root["opencv"] = QString(CV_VERSION);
+    root["threads"] = QThread::idealThreadCount();
+    root["seconds"] = seconds;
+    root["crc16_pclmul"] = CRC16::hasPclmul();
+    root["crc16_cross_check"] = crcValid;
+    root["framer_cross_check"] = framerValid;
+    root["motion_cross_check"] = motionValid;
+    root["autofocus_cross_check"] = autofocusValid;
+    root["fusion_cross_check"] = fusionValid;
+    root["mosaic_cross_check"] = mosaicValid;
+    root["tiles_cross_check"] = tilesValid;
+    root["preview_cross_check"] = previewValid;
+    root["raw_sequence_cross_check"] = rawSequenceValid;
+    if (!replay.isEmpty())
+        root["replay"] = replay;
+    root["results"] = array;
+
+    QFile file(parser.value(outputOption));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("Failed to write %s", qPrintable(file.fileName()));
+        return 1;
+    }
+    file.write(QJsonDocument(root).toJson());
+    out << "results written to " << file.fileName() << "\n";
+    return (crcValid && framerValid && motionValid && autofocusValid && fusionValid && mosaicValid && tilesValid && previewValid && rawSequenceValid) ? 0 : 2;
+}
@@ -0,0 +1,41 @@
+#include <cstring>
+#include <QByteArray>
+#include "cameradevice.h"
+#include "simulatedcamera.h"
+
+namespace
+{
+
+#if defined(_WIN32)
+const wchar_t SimulatedCameraId[] = L"simulated";
+const wchar_t SimulatedCameraName[] = L"Simulated Camera";
+#else
+const char SimulatedCameraId[] = "simulated";
+const char SimulatedCameraName[] = "Simulated Camera";
+#endif
+
+}
+
+unsigned CameraDevice::EnumV2(NncamDeviceV2 arr[NNCAM_MAX])
+{
+    unsigned count = Nncam_EnumV2(arr);
+
+    if (qEnvironmentVariableIsSet("CONTROLVIEW_SIMCAM") && count < NNCAM_MAX)
+    {
+        NncamDeviceV2& device = arr[count++];
+        memset(&device, 0, sizeof(device));
+        memcpy(device.displayname, SimulatedCameraName, sizeof(SimulatedCameraName));
+        memcpy(device.id, SimulatedCameraId, sizeof(SimulatedCameraId));
+        device.model = SimulatedCamera::model();
+    }
+    return count;
+}
+
+CameraDevice* CameraDevice::Open(const NncamDeviceV2 &device)
+{
+    if (device.model == SimulatedCamera::model())
+        return new SimulatedCamera(SimulatedCamera::configFromString(QString::fromLocal8Bit(qgetenv("CONTROLVIEW_SIMCAM"))));
+
+    HNncam h = Nncam_Open(device.id);
+    return h ? new NncamCamera(h) : nullptr;
+}
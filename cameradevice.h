@@ -0,0 +1,132 @@
+#ifndef CAMERADEVICE_H
+#define CAMERADEVICE_H
+
+#include "nncam.h"
+
+// 相机设备抽象
+// 接口与 Nncam SDK 一一对应(去掉 Nncam_ 前缀和句柄参数)，
+// 真实相机由 NncamCamera 转发到 SDK，SimulatedCamera 生成合成帧用于无相机环境下的测试与性能分析
+class CameraDevice
+{
+public:
+    virtual ~CameraDevice() {}
+
+    // 枚举真实相机；设置环境变量 CONTROLVIEW_SIMCAM 时追加一台模拟相机，
+    // 变量值为模拟参数，见 SimulatedCamera::configFromString
+    static unsigned EnumV2(NncamDeviceV2 arr[NNCAM_MAX]);
+
+    // 按枚举得到的设备打开相机，失败返回 nullptr；delete 即关闭相机
+    static CameraDevice* Open(const NncamDeviceV2 &device);
+
+    // 采集
+    virtual HRESULT StartPullModeWithCallback(PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent) = 0;
+    virtual HRESULT StartPushModeV4(PNNCAM_DATA_CALLBACK_V4 funData, void* ctxData, PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent) = 0;
+    virtual HRESULT Stop() = 0;
+    virtual HRESULT PullImageV3(void* pImageData, int bStill, int bits, int rowPitch, NncamFrameInfoV3* pInfo) = 0;
+    virtual HRESULT PullStillImage(void* pImageData, int bits, unsigned* pnWidth, unsigned* pnHeight) = 0;
+    virtual HRESULT Snap(unsigned nResolutionIndex) = 0;
+    virtual HRESULT get_FrameRate(unsigned* nFrame, unsigned* nTime, unsigned* nTotalFrame) = 0;
+
+    // 分辨率
+    virtual HRESULT get_eSize(unsigned* pnResolutionIndex) = 0;
+    virtual HRESULT put_eSize(unsigned nResolutionIndex) = 0;
+    virtual HRESULT get_StillResolution(unsigned nResolutionIndex, int* pWidth, int* pHeight) = 0;
+    virtual HRESULT get_PixelSize(unsigned nResolutionIndex, float* x, float* y) = 0;
+    // 视频流的硬件 ROI，各值须为偶数，全部为 0 时恢复整个视野；切换分辨率后 ROI 复位
+    virtual HRESULT put_Roi(unsigned xOffset, unsigned yOffset, unsigned xWidth, unsigned yHeight) = 0;
+    virtual HRESULT get_Roi(unsigned* pxOffset, unsigned* pyOffset, unsigned* pxWidth, unsigned* pyHeight) = 0;
+
+    // 曝光
+    virtual HRESULT get_AutoExpoEnable(int* bAutoExposure) = 0;
+    virtual HRESULT put_AutoExpoEnable(int bAutoExposure) = 0;
+    virtual HRESULT get_AutoExpoTarget(unsigned short* Target) = 0;
+    virtual HRESULT put_AutoExpoTarget(unsigned short Target) = 0;
+    virtual HRESULT get_ExpTimeRange(unsigned* nMin, unsigned* nMax, unsigned* nDef) = 0;
+    virtual HRESULT get_ExpoTime(unsigned* Time) = 0;
+    virtual HRESULT put_ExpoTime(unsigned Time) = 0;
+    virtual HRESULT get_ExpoAGainRange(unsigned short* nMin, unsigned short* nMax, unsigned short* nDef) = 0;
+    virtual HRESULT get_ExpoAGain(unsigned short* Gain) = 0;
+    virtual HRESULT put_ExpoAGain(unsigned short Gain) = 0;
+    virtual HRESULT get_AEAuxRect(RECT* pAuxRect) = 0;
+    virtual HRESULT put_AEAuxRect(const RECT* pAuxRect) = 0;
+
+    // 白平衡、黑平衡与颜色
+    virtual HRESULT get_TempTint(int* nTemp, int* nTint) = 0;
+    virtual HRESULT put_TempTint(int nTemp, int nTint) = 0;
+    virtual HRESULT AwbOnce(PINNCAM_TEMPTINT_CALLBACK funTT, void* ctxTT) = 0;
+    virtual HRESULT get_AWBAuxRect(RECT* pAuxRect) = 0;
+    virtual HRESULT put_AWBAuxRect(const RECT* pAuxRect) = 0;
+    virtual HRESULT get_BlackBalance(unsigned short aSub[3]) = 0;
+    virtual HRESULT put_BlackBalance(unsigned short aSub[3]) = 0;
+    virtual HRESULT AbbOnce(PINNCAM_BLACKBALANCE_CALLBACK funBB, void* ctxBB) = 0;
+    virtual HRESULT get_ABBAuxRect(RECT* pAuxRect) = 0;
+    virtual HRESULT put_ABBAuxRect(const RECT* pAuxRect) = 0;
+    virtual HRESULT put_Hue(int Hue) = 0;
+    virtual HRESULT put_Saturation(int Saturation) = 0;
+    virtual HRESULT put_Brightness(int Brightness) = 0;
+    virtual HRESULT put_Contrast(int Contrast) = 0;
+    virtual HRESULT put_Gamma(int Gamma) = 0;
+
+    virtual HRESULT put_Option(unsigned iOption, int iValue) = 0;
+};
+
+// 真实相机，直接转发到 Nncam SDK
+class NncamCamera : public CameraDevice
+{
+public:
+    explicit NncamCamera(HNncam h) : h(h) {}
+    ~NncamCamera() override { Nncam_Close(h); }
+
+    HNncam handle() const { return h; }
+
+    HRESULT StartPullModeWithCallback(PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent) override { return Nncam_StartPullModeWithCallback(h, funEvent, ctxEvent); }
+    HRESULT StartPushModeV4(PNNCAM_DATA_CALLBACK_V4 funData, void* ctxData, PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent) override { return Nncam_StartPushModeV4(h, funData, ctxData, funEvent, ctxEvent); }
+    HRESULT Stop() override { return Nncam_Stop(h); }
+    HRESULT PullImageV3(void* pImageData, int bStill, int bits, int rowPitch, NncamFrameInfoV3* pInfo) override { return Nncam_PullImageV3(h, pImageData, bStill, bits, rowPitch, pInfo); }
+    HRESULT PullStillImage(void* pImageData, int bits, unsigned* pnWidth, unsigned* pnHeight) override { return Nncam_PullStillImage(h, pImageData, bits, pnWidth, pnHeight); }
+    HRESULT Snap(unsigned nResolutionIndex) override { return Nncam_Snap(h, nResolutionIndex); }
+    HRESULT get_FrameRate(unsigned* nFrame, unsigned* nTime, unsigned* nTotalFrame) override { return Nncam_get_FrameRate(h, nFrame, nTime, nTotalFrame); }
+
+    HRESULT get_eSize(unsigned* pnResolutionIndex) override { return Nncam_get_eSize(h, pnResolutionIndex); }
+    HRESULT put_eSize(unsigned nResolutionIndex) override { return Nncam_put_eSize(h, nResolutionIndex); }
+    HRESULT get_StillResolution(unsigned nResolutionIndex, int* pWidth, int* pHeight) override { return Nncam_get_StillResolution(h, nResolutionIndex, pWidth, pHeight); }
+    HRESULT get_PixelSize(unsigned nResolutionIndex, float* x, float* y) override { return Nncam_get_PixelSize(h, nResolutionIndex, x, y); }
+    HRESULT put_Roi(unsigned xOffset, unsigned yOffset, unsigned xWidth, unsigned yHeight) override { return Nncam_put_Roi(h, xOffset, yOffset, xWidth, yHeight); }
+    HRESULT get_Roi(unsigned* pxOffset, unsigned* pyOffset, unsigned* pxWidth, unsigned* pyHeight) override { return Nncam_get_Roi(h, pxOffset, pyOffset, pxWidth, pyHeight); }
+
+    HRESULT get_AutoExpoEnable(int* bAutoExposure) override { return Nncam_get_AutoExpoEnable(h, bAutoExposure); }
+    HRESULT put_AutoExpoEnable(int bAutoExposure) override { return Nncam_put_AutoExpoEnable(h, bAutoExposure); }
+    HRESULT get_AutoExpoTarget(unsigned short* Target) override { return Nncam_get_AutoExpoTarget(h, Target); }
+    HRESULT put_AutoExpoTarget(unsigned short Target) override { return Nncam_put_AutoExpoTarget(h, Target); }
+    HRESULT get_ExpTimeRange(unsigned* nMin, unsigned* nMax, unsigned* nDef) override { return Nncam_get_ExpTimeRange(h, nMin, nMax, nDef); }
+    HRESULT get_ExpoTime(unsigned* Time) override { return Nncam_get_ExpoTime(h, Time); }
+    HRESULT put_ExpoTime(unsigned Time) override { return Nncam_put_ExpoTime(h, Time); }
+    HRESULT get_ExpoAGainRange(unsigned short* nMin, unsigned short* nMax, unsigned short* nDef) override { return Nncam_get_ExpoAGainRange(h, nMin, nMax, nDef); }
+    HRESULT get_ExpoAGain(unsigned short* Gain) override { return Nncam_get_ExpoAGain(h, Gain); }
+    HRESULT put_ExpoAGain(unsigned short Gain) override { return Nncam_put_ExpoAGain(h, Gain); }
+    HRESULT get_AEAuxRect(RECT* pAuxRect) override { return Nncam_get_AEAuxRect(h, pAuxRect); }
+    HRESULT put_AEAuxRect(const RECT* pAuxRect) override { return Nncam_put_AEAuxRect(h, pAuxRect); }
+
+    HRESULT get_TempTint(int* nTemp, int* nTint) override { return Nncam_get_TempTint(h, nTemp, nTint); }
+    HRESULT put_TempTint(int nTemp, int nTint) override { return Nncam_put_TempTint(h, nTemp, nTint); }
+    HRESULT AwbOnce(PINNCAM_TEMPTINT_CALLBACK funTT, void* ctxTT) override { return Nncam_AwbOnce(h, funTT, ctxTT); }
+    HRESULT get_AWBAuxRect(RECT* pAuxRect) override { return Nncam_get_AWBAuxRect(h, pAuxRect); }
+    HRESULT put_AWBAuxRect(const RECT* pAuxRect) override { return Nncam_put_AWBAuxRect(h, pAuxRect); }
+    HRESULT get_BlackBalance(unsigned short aSub[3]) override { return Nncam_get_BlackBalance(h, aSub); }
+    HRESULT put_BlackBalance(unsigned short aSub[3]) override { return Nncam_put_BlackBalance(h, aSub); }
+    HRESULT AbbOnce(PINNCAM_BLACKBALANCE_CALLBACK funBB, void* ctxBB) override { return Nncam_AbbOnce(h, funBB, ctxBB); }
+    HRESULT get_ABBAuxRect(RECT* pAuxRect) override { return Nncam_get_ABBAuxRect(h, pAuxRect); }
+    HRESULT put_ABBAuxRect(const RECT* pAuxRect) override { return Nncam_put_ABBAuxRect(h, pAuxRect); }
+    HRESULT put_Hue(int Hue) override { return Nncam_put_Hue(h, Hue); }
+    HRESULT put_Saturation(int Saturation) override { return Nncam_put_Saturation(h, Saturation); }
+    HRESULT put_Brightness(int Brightness) override { return Nncam_put_Brightness(h, Brightness); }
+    HRESULT put_Contrast(int Contrast) override { return Nncam_put_Contrast(h, Contrast); }
+    HRESULT put_Gamma(int Gamma) override { return Nncam_put_Gamma(h, Gamma); }
+
+    HRESULT put_Option(unsigned iOption, int iValue) override { return Nncam_put_Option(h, iOption, iValue); }
+
+private:
+    HNncam h;
+};
+
+#endif // CAMERADEVICE_H
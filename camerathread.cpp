@@ -1,7 +1,13 @@
-#include "cameraThread.h"
+#include <cmath>
+#include <cstring>
+#include <QMutexLocker>
+#include "camerathread.h"
+#include "profiler.h"
 
-cameraThread::cameraThread(HNncam hcam, uchar* pData, QObject *parent)
-    : QThread(parent), hcam(hcam), pData(pData)
+cameraThread::cameraThread(CameraDevice* camera, FrameRing* ring, AcquisitionMode mode, QObject *parent)
+    : QThread(parent), camera(camera), ring(ring), stage(nullptr), mode(mode), callbackFrames(0), callbackNs(0)
+    , expoTime(0), expoGain(0), temp(NNCAM_TEMP_DEF), tint(NNCAM_TINT_DEF)
+    , previewSize(0), previewPending(false), oversizedFrames(0), previewRegion(0, 0, 1, 1), roiSwitching(false), previewIndex(0)
 {
 }
 
@@ -11,7 +17,16 @@ cameraThread::~cameraThread()
 
 void cameraThread::run()
 {
-    if (SUCCEEDED(Nncam_StartPullModeWithCallback(hcam, eventCallBack, this)))
+    refreshExposure();
+    refreshTempTint();
+
+    HRESULT hr;
+    if (PushMode == mode)
+        hr = camera->StartPushModeV4(dataCallBack, this, eventCallBack, this);
+    else
+        hr = camera->StartPullModeWithCallback(eventCallBack, this);
+
+    if (SUCCEEDED(hr))
     {
         emit cameraStartMessage(true);
     }
@@ -21,15 +36,144 @@ void cameraThread::run()
     }
 }
 
+void cameraThread::setPreviewSize(unsigned width, unsigned height)
+{
+    previewSize.store((quint64(width) << 32) | height, std::memory_order_relaxed);
+}
+
+void cameraThread::setPreviewRegion(const QRectF &region)
+{
+    QMutexLocker locker(&previewMutex);
+    previewRegion = region;
+}
+
+void cameraThread::beginHardwareRoi(const QRect &roi, const QSize &sensor)
+{
+    QMutexLocker locker(&previewMutex);
+    previousRoi = hardwareRoi;
+    hardwareRoi = roi;
+    sensorSize = sensor;
+    roiSwitching = true;
+}
+
+void cameraThread::setHardwareRoi(const QRect &roi, const QSize &sensor)
+{
+    QMutexLocker locker(&previewMutex);
+    // 切换失败时恢复为原来的 ROI，不再有属于失败 ROI 的帧
+    if (roiSwitching && roi != hardwareRoi)
+        previousRoi = roi;
+    hardwareRoi = roi;
+    sensorSize = sensor;
+    roiSwitching = false;
+}
+
+void cameraThread::makePreview(const uchar* data, unsigned width, unsigned height, unsigned stride,
+                               const QRectF &frameRegion, const QRectF &region, unsigned maxWidth, unsigned maxHeight,
+                               QImage &preview, cv::Mat &scratch, QRectF &shown)
+{
+    // 可见区域换算到帧内像素，向外取整；平移到 ROI 之外时取整帧
+    QRectF visible = region & frameRegion;
+    if (visible.isEmpty())
+        visible = frameRegion;
+    double fx = width / frameRegion.width();
+    double fy = height / frameRegion.height();
+    int left = qBound(0, int(std::floor((visible.left() - frameRegion.left()) * fx)), int(width) - 1);
+    int top = qBound(0, int(std::floor((visible.top() - frameRegion.top()) * fy)), int(height) - 1);
+    int right = qBound(left + 1, int(std::ceil((visible.right() - frameRegion.left()) * fx)), int(width));
+    int bottom = qBound(top + 1, int(std::ceil((visible.bottom() - frameRegion.top()) * fy)), int(height));
+    cv::Rect crop(left, top, right - left, bottom - top);
+
+    double scale = qMin(1.0, qMin(double(maxWidth) / crop.width, double(maxHeight) / crop.height));
+    int previewWidth = qMax(1, int(crop.width * scale));
+    int previewHeight = qMax(1, int(crop.height * scale));
+
+    if (preview.width() != previewWidth || preview.height() != previewHeight || preview.format() != QImage::Format_RGB32)
+        preview = QImage(previewWidth, previewHeight, QImage::Format_RGB32);
+
+    // 区域插值后转为 Format_RGB32(内存中为 B G R FF)，GUI 线程不再接触全分辨率像素，绘制时也不再转换格式
+    cv::Mat src(int(height), int(width), CV_8UC3, const_cast<uchar*>(data), stride);
+    cv::Mat dst(previewHeight, previewWidth, CV_8UC4, preview.bits(), size_t(preview.bytesPerLine()));
+    if (crop.width == previewWidth && crop.height == previewHeight)
+    {
+        cv::cvtColor(src(crop), dst, cv::COLOR_RGB2BGRA);
+    }
+    else
+    {
+        cv::resize(src(crop), scratch, cv::Size(previewWidth, previewHeight), 0, 0, cv::INTER_AREA);
+        cv::cvtColor(scratch, dst, cv::COLOR_RGB2BGRA);
+    }
+
+    shown = QRectF(frameRegion.left() + crop.x / fx, frameRegion.top() + crop.y / fy, crop.width / fx, crop.height / fy);
+}
+
+void cameraThread::emitPreview(const FrameRing::Slot &slot)
+{
+    quint64 size = previewSize.load(std::memory_order_relaxed);
+    unsigned maxWidth = unsigned(size >> 32);
+    unsigned maxHeight = unsigned(size & 0xFFFFFFFF);
+    if (0 == maxWidth || 0 == maxHeight || 0 == slot.width || 0 == slot.height)
+        return;
+
+    // 按尺寸判断帧覆盖的传感器区域，都不匹配时视为整个视野
+    QRectF region;
+    QRectF frameRegion(0, 0, 1, 1);
+    {
+        QMutexLocker locker(&previewMutex);
+        region = previewRegion;
+        if (!sensorSize.isEmpty())
+        {
+            QSize size(int(slot.width), int(slot.height));
+            QRect current = hardwareRoi.isEmpty() ? QRect(QPoint(0, 0), sensorSize) : hardwareRoi;
+            QRect previous = previousRoi.isEmpty() ? QRect(QPoint(0, 0), sensorSize) : previousRoi;
+            QRect roi;
+            if (roiSwitching && current != previous && current.size() == previous.size() && size == current.size())
+                return;
+            if (size == current.size())
+                roi = current;
+            else if (size == previous.size())
+                roi = previous;
+            if (!roi.isEmpty())
+                frameRegion = QRectF(double(roi.x()) / sensorSize.width(), double(roi.y()) / sensorSize.height(),
+                                     double(roi.width()) / sensorSize.width(), double(roi.height()) / sensorSize.height());
+        }
+    }
+
+    // GUI 还没有显示上一帧预览，跳过本帧，避免预览在事件队列中堆积
+    bool expected = false;
+    if (!previewPending.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+        return;
+
+    // GUI 显示一个缓冲时写另一个。previewShown 之前 GUI 已换用上一帧的缓冲，
+    // 将要写入的缓冲不再被引用，写入时不会触发 QImage 的深拷贝，每帧没有像素内存的分配
+    QImage &preview = previewBuffers[previewIndex];
+    previewIndex ^= 1;
+
+    qint64 start = frameClockNs();
+    QRectF shown;
+    makePreview(slot.data, slot.width, slot.height, slot.stride, frameRegion, region, maxWidth, maxHeight, preview, previewScratch, shown);
+    Profiler::instance().record(Profiler::Scale, start, frameClockNs());
+    emit previewReady(preview, shown);
+}
+
+void cameraThread::takeCallbackStats(quint64 &frames, quint64 &nanoseconds)
+{
+    frames = callbackFrames.exchange(0, std::memory_order_relaxed);
+    nanoseconds = callbackNs.exchange(0, std::memory_order_relaxed);
+}
+
 void __stdcall cameraThread::eventCallBack(unsigned nEvent, void* pCallbackCtx)
 {
     cameraThread* pThis = reinterpret_cast<cameraThread*>(pCallbackCtx);
-    if (pThis->hcam)
+    if (pThis->camera)
         {
             if (NNCAM_EVENT_IMAGE == nEvent)
                 pThis->handleImageEvent();
             else if (NNCAM_EVENT_STILLIMAGE == nEvent)
                 pThis->handleStillImageEvent();
+            else if (NNCAM_EVENT_EXPOSURE == nEvent)
+                pThis->refreshExposure();
+            else if (NNCAM_EVENT_TEMPTINT == nEvent)
+                pThis->refreshTempTint();
             else if (NNCAM_EVENT_ERROR == nEvent)
             {
                 emit pThis->eventCallBackMessage("一般性错误, 数据采集不能继续。");
@@ -41,27 +185,159 @@ void __stdcall cameraThread::eventCallBack(unsigned nEvent, void* pCallbackCtx)
         }
 }
 
+void __stdcall cameraThread::dataCallBack(const void* pData, const NncamFrameInfoV3* pInfo, int bSnap, void* pCallbackCtx)
+{
+    cameraThread* pThis = reinterpret_cast<cameraThread*>(pCallbackCtx);
+    if (pThis->camera && pData && pInfo)
+    {
+        if (bSnap)
+            pThis->handlePushStillImage(pData, pInfo);
+        else
+            pThis->handlePushImage(pData, pInfo);
+    }
+}
+
+void cameraThread::refreshExposure()
+{
+    unsigned time = 0;
+    unsigned short gain = 0;
+    if (SUCCEEDED(camera->get_ExpoTime(&time)))
+        expoTime.store(time, std::memory_order_relaxed);
+    if (SUCCEEDED(camera->get_ExpoAGain(&gain)))
+        expoGain.store(gain, std::memory_order_relaxed);
+}
+
+void cameraThread::refreshTempTint()
+{
+    int nTemp = 0, nTint = 0;
+    if (SUCCEEDED(camera->get_TempTint(&nTemp, &nTint)))
+    {
+        temp.store(nTemp, std::memory_order_relaxed);
+        tint.store(nTint, std::memory_order_relaxed);
+    }
+}
+
+FrameParams cameraThread::currentParams(const NncamFrameInfoV3 &info) const
+{
+    // 优先使用帧信息中携带的曝光参数，否则使用最近一次事件通知的值
+    FrameParams params;
+    params.expoTime = (info.flag & NNCAM_FRAMEINFO_FLAG_EXPOTIME) ? info.expotime : expoTime.load(std::memory_order_relaxed);
+    params.expoGain = (info.flag & NNCAM_FRAMEINFO_FLAG_EXPOGAIN) ? info.expogain : static_cast<unsigned short>(expoGain.load(std::memory_order_relaxed));
+    params.temp = temp.load(std::memory_order_relaxed);
+    params.tint = tint.load(std::memory_order_relaxed);
+
+    // 位移台位置取帧到达时的快照
+    memset(params.stage, 0, sizeof(params.stage));
+    params.stageSource = StageModel::None;
+    if (stage)
+    {
+        StageModel::Position position = stage->position();
+        if (StageModel::None != position.source)
+        {
+            memcpy(params.stage, position.axis, sizeof(params.stage));
+            params.stageSource = position.source;
+        }
+    }
+    return params;
+}
+
 void cameraThread::handleImageEvent()
 {
-    unsigned width = 0, height = 0;
-    if (SUCCEEDED(Nncam_PullImage(hcam, pData, 24, &width, &height)))
+    qint64 arrival = frameClockNs();
+
+    // 缓冲已满且按策略丢弃新帧，不再拉取
+    int index = ring->acquireWrite();
+    if (index < 0)
+        return;
+
+    FrameRing::Slot& slot = ring->slot(index);
+    HRESULT hr = camera->PullImageV3(slot.data, 0, 24, 0, &slot.info);
+    Profiler::instance().record(Profiler::Pull, arrival, frameClockNs());
+    if (SUCCEEDED(hr))
+    {
+        slot.width = slot.info.width;
+        slot.height = slot.info.height;
+        slot.stride = TDIBWIDTHBYTES(slot.width * 24);
+        slot.params = currentParams(slot.info);
+        slot.arrival = arrival;
+        emitPreview(slot);
+        ring->commitWrite(index);
+        emit imageCaptured();
+    }
+    else
     {
-        QImage image(pData, width, height, QImage::Format_RGB888);
-        emit imageCaptured(image);
+        ring->abortWrite(index);
     }
+
+    qint64 end = frameClockNs();
+    Profiler::instance().record(Profiler::Callback, arrival, end);
+    callbackFrames.fetch_add(1, std::memory_order_relaxed);
+    callbackNs.fetch_add(quint64(end - arrival), std::memory_order_relaxed);
 }
 
 void cameraThread::handleStillImageEvent()
 {
+    qint64 arrival = frameClockNs();
     unsigned width = 0, height = 0;
-    if (SUCCEEDED(Nncam_PullStillImage(hcam, nullptr, 24, &width, &height))) // peek
+    if (SUCCEEDED(camera->PullStillImage(nullptr, 24, &width, &height))) // peek
     {
-        std::vector<uchar> vec(TDIBWIDTHBYTES(width * 24) * height);
-        if (SUCCEEDED(Nncam_PullStillImage(hcam, &vec[0], 24, &width, &height)))
+        Frame frame = Frame::allocate(width, height);
+        NncamFrameInfoV3 info = { 0 };
+        if (SUCCEEDED(camera->PullImageV3(frame.bits(), 1, 24, 0, &info)))
         {
-            QImage image(&vec[0], width, height, QImage::Format_RGB888);
-            QImage copiedImage = image.copy();
-            emit stillImageCaptured(copiedImage);
+            frame.setInfo(info);
+            frame.setParams(currentParams(info));
+            frame.setArrival(arrival);
+            emit stillImageCaptured(frame);
         }
     }
-}
\ No newline at end of file
+}
+
+void cameraThread::handlePushImage(const void* pData, const NncamFrameInfoV3* pInfo)
+{
+    qint64 arrival = frameClockNs();
+
+    // pData 只在回调期间有效，直接写入帧缓冲槽位，不再经过中间缓冲
+    // 帧大于槽位(环按当前分辨率分配)时无法保存，计入环的丢帧数并单独计数，在状态栏显示
+    unsigned stride = TDIBWIDTHBYTES(pInfo->width * 24);
+    size_t bytes = size_t(stride) * pInfo->height;
+    if (bytes > ring->slotBytes())
+    {
+        ring->countDropped();
+        oversizedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    int index = ring->acquireWrite();
+    if (index < 0)
+        return;
+
+    FrameRing::Slot& slot = ring->slot(index);
+    memcpy(slot.data, pData, bytes);
+    Profiler::instance().record(Profiler::Pull, arrival, frameClockNs());
+    slot.width = pInfo->width;
+    slot.height = pInfo->height;
+    slot.stride = stride;
+    slot.info = *pInfo;
+    slot.params = currentParams(*pInfo);
+    slot.arrival = arrival;
+    emitPreview(slot);
+    ring->commitWrite(index);
+    emit imageCaptured();
+
+    qint64 end = frameClockNs();
+    Profiler::instance().record(Profiler::Callback, arrival, end);
+    callbackFrames.fetch_add(1, std::memory_order_relaxed);
+    callbackNs.fetch_add(quint64(end - arrival), std::memory_order_relaxed);
+}
+
+void cameraThread::handlePushStillImage(const void* pData, const NncamFrameInfoV3* pInfo)
+{
+    qint64 arrival = frameClockNs();
+    Frame frame = Frame::allocate(pInfo->width, pInfo->height);
+    memcpy(frame.bits(), pData, frame.byteCount());
+    frame.setInfo(*pInfo);
+    frame.setParams(currentParams(*pInfo));
+    frame.setArrival(arrival);
+    emit stillImageCaptured(frame);
+}
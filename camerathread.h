@@ -1,34 +1,117 @@
 #ifndef CAMERATHREAD_H
 #define CAMERATHREAD_H
+#include <atomic>
+#include <opencv2/opencv.hpp>
 #include <QThread>
 #include <QImage>
+#include <QMutex>
+#include <QRectF>
 #include <QString>
-#include "Nncam.h"
+#include "nncam.h"
+#include "cameradevice.h"
+#include "frame.h"
+#include "stagemodel.h"
 
 class cameraThread : public QThread
 {
     Q_OBJECT
 
 public:
-    cameraThread(HNncam hcam, uchar* pData, QObject *parent = nullptr);
+    enum AcquisitionMode
+    {
+        PullMode,       // Nncam_StartPullModeWithCallback + Nncam_PullImageV3
+        PushMode        // Nncam_StartPushModeV4，SDK 直接回调帧数据
+    };
+
+    cameraThread(CameraDevice* camera, FrameRing* ring, AcquisitionMode mode = PullMode, QObject *parent = nullptr);
     ~cameraThread();
     void run() override;
 
+    AcquisitionMode acquisitionMode() const { return mode; }
+
+    // 预览图像的最大尺寸，采集线程按此尺寸直接生成缩小后的预览图
+    void setPreviewSize(unsigned width, unsigned height);
+
+    // 预览显示的传感器区域(相对整个视野归一化)，只裁剪并缩小这一部分，放大查看时每帧的工作量与屏幕上的像素数相当
+    void setPreviewRegion(const QRectF &region);
+
+    // 切换硬件 ROI(当前分辨率下的像素坐标，空矩形表示整个视野): put_Roi 之前调用 beginHardwareRoi，
+    // 返回后以实际生效的 ROI 调用 setHardwareRoi。帧不携带 ROI 信息，只能按尺寸判断属于新的还是旧的 ROI；
+    // 切换期间新旧 ROI 尺寸相同、无法区分的帧不生成预览，直到 put_Roi 返回后的第一帧
+    void beginHardwareRoi(const QRect &roi, const QSize &sensor);
+    void setHardwareRoi(const QRect &roi, const QSize &sensor);
+
+    // 从 RGB24 帧中取 region 与 frameRegion 相交的部分，缩小到不超过 maxWidth x maxHeight(不放大)，
+    // 写入 Format_RGB32 的 preview；preview 尺寸不符时重新分配，否则原地写入，scratch 为缩小时的中间缓冲
+    // frameRegion 为帧覆盖的传感器区域，shown 返回预览图实际覆盖的区域，均相对整个视野归一化
+    static void makePreview(const uchar* data, unsigned width, unsigned height, unsigned stride,
+                            const QRectF &frameRegion, const QRectF &region, unsigned maxWidth, unsigned maxHeight,
+                            QImage &preview, cv::Mat &scratch, QRectF &shown);
+
+    // GUI 显示完一帧预览后调用，之前到达的帧不再生成预览
+    void previewShown() { previewPending.store(false, std::memory_order_release); }
+
+    // 每帧附带到达时的位移台位置，须在 start() 之前设置
+    void setStageModel(StageModel* model) { stage = model; }
+
+    // 取出并清零自上次调用以来的回调帧数和回调耗时(ns)
+    void takeCallbackStats(quint64 &frames, quint64 &nanoseconds);
+
+    // 推送模式下因大于帧缓冲槽位而丢弃的帧数(已计入 FrameRing::droppedCount)
+    quint64 oversizedCount() const { return oversizedFrames.load(std::memory_order_relaxed); }
+
     signals:
-        void imageCaptured(const QImage &image);
-        void stillImageCaptured(const QImage &image);
+        void imageCaptured();
+        // region 为 image 覆盖的传感器区域(归一化)
+        void previewReady(const QImage &image, const QRectF &region);
+        void stillImageCaptured(const Frame &frame);
         void cameraStartMessage(bool Message);
         void eventCallBackMessage(QString Message);
     
     private:
-        HNncam hcam;
-        uchar* pData;
+        CameraDevice* camera;
+        FrameRing* ring;
+        StageModel* stage;
+        AcquisitionMode mode;
+        std::atomic<quint64> callbackFrames;
+        std::atomic<quint64> callbackNs;
+        std::atomic<unsigned> expoTime;
+        std::atomic<unsigned> expoGain;
+        std::atomic<int> temp;
+        std::atomic<int> tint;
+        std::atomic<quint64> previewSize;
+        std::atomic<bool> previewPending;
+        std::atomic<quint64> oversizedFrames;
+        QMutex previewMutex;        // 保护以下预览区域，GUI 线程写、采集线程每帧读一次
+        QRectF previewRegion;
+        QRect hardwareRoi;
+        QRect previousRoi;          // 切换之前的 ROI，之前曝光的帧可能稍后才到达
+        bool roiSwitching;          // beginHardwareRoi 之后、setHardwareRoi 之前
+        QSize sensorSize;
+        // 两个预览缓冲交替写入，只由回调线程访问
+        QImage previewBuffers[2];
+        int previewIndex;
+        cv::Mat previewScratch;
 
         static void __stdcall eventCallBack(unsigned nEvent, void* pCallbackCtx);
 
+        static void __stdcall dataCallBack(const void* pData, const NncamFrameInfoV3* pInfo, int bSnap, void* pCallbackCtx);
+
+        void refreshExposure();
+
+        void refreshTempTint();
+
+        FrameParams currentParams(const NncamFrameInfoV3 &info) const;
+
+        void emitPreview(const FrameRing::Slot &slot);
+
         void handleImageEvent();
 
         void handleStillImageEvent();
+
+        void handlePushImage(const void* pData, const NncamFrameInfoV3* pInfo);
+
+        void handlePushStillImage(const void* pData, const NncamFrameInfoV3* pInfo);
 };
 
 #endif // CAMERATHREAD_H
@@ -0,0 +1,117 @@
+#include <cstring>
+#include <QDir>
+#include <QFile>
+#include <opencv2/opencv.hpp>
+#include "capturestore.h"
+
+CaptureStore::CaptureStore()
+    : m_dir(QDir::tempPath() + "/ControlView-XXXXXX"), m_diskBytes(0), m_fileCounter(0)
+{
+}
+
+CaptureStore::~CaptureStore()
+{
+    clear();
+}
+
+QImage CaptureStore::makeThumbnail(const Frame &frame)
+{
+    int width = qMin(int(frame.width()), int(ThumbnailWidth));
+    int height = qMax(1, int(qint64(frame.height()) * width / qMax(1u, frame.width())));
+
+    // 缩略图使用自有内存，不引用原帧
+    QImage thumbnail(width, height, QImage::Format_RGB888);
+    cv::Mat src(int(frame.height()), int(frame.width()), CV_8UC3, const_cast<uchar*>(frame.data()), frame.stride());
+    cv::Mat dst(height, width, CV_8UC3, thumbnail.bits(), size_t(thumbnail.bytesPerLine()));
+    cv::resize(src, dst, dst.size(), 0, 0, cv::INTER_AREA);
+    return thumbnail;
+}
+
+int CaptureStore::add(const Frame &frame)
+{
+    if (!isValid() || frame.isNull())
+        return -1;
+
+    Entry entry;
+    entry.path = m_dir.filePath(QString::asprintf("capture_%06u.raw", ++m_fileCounter));
+    entry.record = rawFrameRecord(frame);
+    entry.record.offset = sizeof(RawFrameRecord);
+
+    // 一次顺序写入，之后不再需要原帧，FrameRing 槽位可以立即归还
+    QFile file(entry.path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return -1;
+    qint64 bytes = qint64(frame.byteCount());
+    if (file.write(reinterpret_cast<const char*>(&entry.record), sizeof(entry.record)) != qint64(sizeof(entry.record))
+        || file.write(reinterpret_cast<const char*>(frame.data()), bytes) != bytes)
+    {
+        file.remove();
+        return -1;
+    }
+    file.close();
+
+    entry.thumbnail = makeThumbnail(frame);
+    m_diskBytes += bytes;
+    m_entries.append(entry);
+    return m_entries.size() - 1;
+}
+
+void CaptureStore::remove(int index)
+{
+    if (index < 0 || index >= m_entries.size())
+        return;
+
+    const Entry& entry = m_entries.at(index);
+    m_diskBytes -= qint64(entry.record.stride) * entry.record.height;
+    QFile::remove(entry.path);
+    m_entries.removeAt(index);
+}
+
+int CaptureStore::indexOf(const QString &path) const
+{
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        if (m_entries.at(i).path == path)
+            return i;
+    }
+    return -1;
+}
+
+void CaptureStore::clear()
+{
+    for (int i = 0; i < m_entries.size(); ++i)
+        QFile::remove(m_entries.at(i).path);
+    m_entries.clear();
+    m_diskBytes = 0;
+}
+
+Frame CaptureStore::readFile(const QString &path, const RawFrameRecord &record)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return Frame();
+
+    qint64 bytes = qint64(record.stride) * record.height;
+    if (file.size() < qint64(record.offset) + bytes)
+        return Frame();
+
+    Frame frame = Frame::allocate(record.width, record.height);
+    if (frame.stride() != record.stride)
+        return Frame();
+
+    uchar* map = file.map(qint64(record.offset), bytes);
+    if (map)
+    {
+        memcpy(frame.bits(), map, size_t(bytes));
+        file.unmap(map);
+    }
+    else
+    {
+        file.seek(qint64(record.offset));
+        if (file.read(reinterpret_cast<char*>(frame.bits()), bytes) != bytes)
+            return Frame();
+    }
+
+    applyRawFrameRecord(frame, record);
+    return frame;
+}
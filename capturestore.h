@@ -0,0 +1,63 @@
+#ifndef CAPTURESTORE_H
+#define CAPTURESTORE_H
+
+#include <QImage>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVector>
+#include "frame.h"
+#include "rawsequence.h"
+
+// 抓拍图像仓库
+// 每张抓拍立即写入临时目录下的一个原始文件(RawFrameRecord + RGB24 像素)，
+// 内存中只常驻缩略图；完整图像在查看或保存时按需从文件读取(TileViewer 自带分块缓存)
+class CaptureStore
+{
+public:
+    static const int    ThumbnailWidth = 320;
+
+    CaptureStore();
+    ~CaptureStore();
+
+    bool isValid() const { return m_dir.isValid(); }
+    QString scratchPath() const { return m_dir.path(); }
+
+    // 写入一帧，返回序号，失败时返回 -1
+    int add(const Frame &frame);
+    void remove(int index);
+    void clear();
+
+    int size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+
+    const RawFrameRecord& record(int index) const { return m_entries.at(index).record; }
+    const QImage& thumbnail(int index) const { return m_entries.at(index).thumbnail; }
+    const QString& filePath(int index) const { return m_entries.at(index).path; }
+    // 按临时文件查找序号，没有时返回 -1
+    int indexOf(const QString &path) const;
+
+    // 读取一个抓拍文件，可在任意线程调用
+    static Frame readFile(const QString &path, const RawFrameRecord &record);
+
+    qint64 diskBytes() const { return m_diskBytes; }
+
+private:
+    struct Entry
+    {
+        QString        path;
+        RawFrameRecord record;
+        QImage         thumbnail;
+    };
+
+    static QImage makeThumbnail(const Frame &frame);
+
+    CaptureStore(const CaptureStore&);
+    CaptureStore& operator=(const CaptureStore&);
+
+    QTemporaryDir   m_dir;
+    QVector<Entry>  m_entries;
+    qint64          m_diskBytes;
+    unsigned        m_fileCounter;
+};
+
+#endif // CAPTURESTORE_H
@@ -1,15 +1,229 @@
 #include "crc16.h"
 
-uint16_t CRC16::calculate(const QByteArray &data) {
-    uint16_t crc = 0xFFFF;
-    for (int i = 0; i < data.size(); ++i) {
-        crc ^= static_cast<uint8_t>(data[i]);
+#if defined(CRC16_PCLMUL) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define CRC16_HAVE_PCLMUL 1
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CRC16_TARGET_PCLMUL
+#else
+#define CRC16_TARGET_PCLMUL __attribute__((target("sse2,pclmul")))
+#endif
+#endif
+
+namespace
+{
+
+const uint16_t Polynomial = 0xA001;     // 0x8005 的位反射
+
+// 数据量小于该值时折叠的准备开销不划算，直接查表(串口包只有十几个字节)
+const size_t PclmulThreshold = 128;
+
+struct Tables
+{
+    // slice[k][b]: 字节 b 之后再跟 k 个零字节时对寄存器的贡献
+    uint16_t slice[8][256];
+
+#ifdef CRC16_HAVE_PCLMUL
+    // 折叠常数 x^n mod P，按 64 位反射存放
+    uint64_t fold16[2];     // 折叠 16 字节
+    uint64_t fold64[2];     // 4 路并行，每路折叠 64 字节
+    uint64_t fold48[2];
+    uint64_t fold32[2];
+    bool     pclmul;
+#endif
+
+    Tables();
+};
+
+#ifdef CRC16_HAVE_PCLMUL
+// x^n mod P(x)，P = x^16 + x^15 + x^2 + 1，按常规(非反射)位序计算
+uint32_t xPowMod(unsigned n)
+{
+    uint32_t r = 1;
+    for (unsigned i = 0; i < n; ++i)
+    {
+        r <<= 1;
+        if (r & 0x10000)
+            r ^= 0x18005;
+    }
+    return r;
+}
+
+// 次数 d 的系数放到第 63-d 位，与小端载入的反射数据位序一致
+uint64_t reflect64(uint32_t poly)
+{
+    uint64_t r = 0;
+    for (int d = 0; d < 16; ++d)
+        if (poly & (1u << d))
+            r |= uint64_t(1) << (63 - d);
+    return r;
+}
+
+// 128 位块向后移动 bytes 字节: 高次半块乘 x^(8*bytes+64)，低次半块乘 x^(8*bytes)
+// 反射数据的 PCLMULQDQ 乘积相当于多乘了 x^-1，常数的次数相应减 1
+void foldConstants(uint64_t out[2], unsigned bytes)
+{
+    out[0] = reflect64(xPowMod(8 * bytes + 64 - 1));
+    out[1] = reflect64(xPowMod(8 * bytes - 1));
+}
+
+bool cpuHasPclmul()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 1)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul");
+#endif
+}
+#endif
+
+Tables::Tables()
+{
+    for (int b = 0; b < 256; ++b)
+    {
+        uint16_t crc = uint16_t(b);
+        for (int j = 0; j < 8; ++j)
+            crc = (crc & 1) ? uint16_t((crc >> 1) ^ Polynomial) : uint16_t(crc >> 1);
+        slice[0][b] = crc;
+    }
+    for (int k = 1; k < 8; ++k)
+        for (int b = 0; b < 256; ++b)
+            slice[k][b] = uint16_t((slice[k-1][b] >> 8) ^ slice[0][slice[k-1][b] & 0xFF]);
+
+#ifdef CRC16_HAVE_PCLMUL
+    foldConstants(fold16, 16);
+    foldConstants(fold64, 64);
+    foldConstants(fold48, 48);
+    foldConstants(fold32, 32);
+    pclmul = cpuHasPclmul();
+#endif
+}
+
+const Tables& tables()
+{
+    static const Tables t;
+    return t;
+}
+
+#ifdef CRC16_HAVE_PCLMUL
+CRC16_TARGET_PCLMUL
+inline __m128i fold(__m128i block, __m128i constants)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(block, constants, 0x00),
+                         _mm_clmulepi64_si128(block, constants, 0x11));
+}
+
+// 把数据折叠成一个 16 字节块，该块与原数据(异或初值后)对 P 同余，再用查表算出余数
+// 要求 size >= 64，不足 16 字节的尾部继续查表
+CRC16_TARGET_PCLMUL
+uint16_t foldPclmul(const Tables &t, uint16_t crc, const uint8_t *p, size_t size)
+{
+    const __m128i k16 = _mm_set_epi64x((long long)t.fold16[1], (long long)t.fold16[0]);
+    const __m128i k64 = _mm_set_epi64x((long long)t.fold64[1], (long long)t.fold64[0]);
+    const __m128i k48 = _mm_set_epi64x((long long)t.fold48[1], (long long)t.fold48[0]);
+    const __m128i k32 = _mm_set_epi64x((long long)t.fold32[1], (long long)t.fold32[0]);
+
+    // 反射 CRC 的寄存器对齐到后续数据的前两个字节
+    __m128i x0 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_cvtsi32_si128(crc));
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48));
+    p += 64;
+    size -= 64;
+
+    // 4 路独立折叠，隐藏乘法延迟
+    while (size >= 64)
+    {
+        x0 = _mm_xor_si128(fold(x0, k64), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        x1 = _mm_xor_si128(fold(x1, k64), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)));
+        x2 = _mm_xor_si128(fold(x2, k64), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)));
+        x3 = _mm_xor_si128(fold(x3, k64), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48)));
+        p += 64;
+        size -= 64;
+    }
+
+    __m128i x = _mm_xor_si128(_mm_xor_si128(fold(x0, k48), fold(x1, k32)), _mm_xor_si128(fold(x2, k16), x3));
+    while (size >= 16)
+    {
+        x = _mm_xor_si128(fold(x, k16), _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        p += 16;
+        size -= 16;
+    }
+
+    uint8_t block[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(block), x);
+    crc = CRC16::updateTable(0, block, sizeof(block));
+    return CRC16::updateTable(crc, p, size);
+}
+#endif
+
+}
+
+uint16_t CRC16::update(uint16_t crc, const void *data, size_t size)
+{
+#ifdef CRC16_HAVE_PCLMUL
+    if (size >= PclmulThreshold)
+        return updatePclmul(crc, data, size);
+#endif
+    return updateTable(crc, data, size);
+}
+
+uint16_t CRC16::updateBitwise(uint16_t crc, const void *data, size_t size)
+{
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= p[i];
         for (int j = 0; j < 8; ++j) {
             if (crc & 1)
-                crc = (crc >> 1) ^ 0xA001;
+                crc = (crc >> 1) ^ Polynomial;
             else
                 crc >>= 1;
         }
     }
     return crc;
 }
+
+uint16_t CRC16::updateTable(uint16_t crc, const void *data, size_t size)
+{
+    const Tables& t = tables();
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+
+    // 每次 8 字节: 前两个字节与寄存器合并，其余字节各查一张表
+    while (size >= 8)
+    {
+        crc ^= uint16_t(p[0] | (p[1] << 8));
+        crc = t.slice[7][crc & 0xFF] ^ t.slice[6][crc >> 8]
+            ^ t.slice[5][p[2]] ^ t.slice[4][p[3]]
+            ^ t.slice[3][p[4]] ^ t.slice[2][p[5]]
+            ^ t.slice[1][p[6]] ^ t.slice[0][p[7]];
+        p += 8;
+        size -= 8;
+    }
+    while (size--)
+        crc = uint16_t((crc >> 8) ^ t.slice[0][(crc ^ *p++) & 0xFF]);
+    return crc;
+}
+
+uint16_t CRC16::updatePclmul(uint16_t crc, const void *data, size_t size)
+{
+#ifdef CRC16_HAVE_PCLMUL
+    const Tables& t = tables();
+    if (t.pclmul && size >= 64)
+        return foldPclmul(t, crc, static_cast<const uint8_t*>(data), size);
+#endif
+    return updateTable(crc, data, size);
+}
+
+bool CRC16::hasPclmul()
+{
+#ifdef CRC16_HAVE_PCLMUL
+    return tables().pclmul;
+#else
+    return false;
+#endif
+}
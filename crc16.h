@@ -1,12 +1,27 @@
 #ifndef CRC16_H
 #define CRC16_H
 
+#include <cstddef>
+#include <cstdint>
 #include <QByteArray>
 
+// CRC-16/MODBUS (多项式 0x8005 反射为 0xA001，初值 0xFFFF，无结果异或)
+// 增量用法: crc = init(); crc = update(crc, p, n); ...; finalize(crc)
 class CRC16
 {
 public:
-    static uint16_t calculate(const QByteArray &data);
+    static uint16_t init() { return 0xFFFF; }
+    static uint16_t update(uint16_t crc, const void *data, size_t size);
+    static uint16_t finalize(uint16_t crc) { return crc; }
+
+    static uint16_t calculate(const void *data, size_t size) { return finalize(update(init(), data, size)); }
+    static uint16_t calculate(const QByteArray &data) { return calculate(data.constData(), size_t(data.size())); }
+
+    // 各实现单独暴露，供交叉校验与基准测试使用
+    static uint16_t updateBitwise(uint16_t crc, const void *data, size_t size);    // 逐位参考实现
+    static uint16_t updateTable(uint16_t crc, const void *data, size_t size);      // slicing-by-8 查表
+    static uint16_t updatePclmul(uint16_t crc, const void *data, size_t size);     // PCLMULQDQ 折叠，不可用时退回查表
+    static bool hasPclmul();
 };
 
 #endif // CRC16_H
@@ -0,0 +1,107 @@
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include "diagnosticsdialog.h"
+#include "profiler.h"
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_table(new QTableWidget(Profiler::StageCount, 5, this))
+    , m_timer(new QTimer(this))
+{
+    setWindowTitle(u8"诊断");
+    resize(560, 300);
+
+    m_table->setHorizontalHeaderLabels(QStringList() << "count" << "p50 (us)" << "p99 (us)" << "max (us)" << "mean (us)");
+    QStringList stages;
+    for (int s = 0; s < Profiler::StageCount; ++s)
+        stages << Profiler::stageName(Profiler::Stage(s));
+    m_table->setVerticalHeaderLabels(stages);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for (int row = 0; row < m_table->rowCount(); ++row)
+    {
+        for (int column = 0; column < m_table->columnCount(); ++column)
+        {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_table->setItem(row, column, item);
+        }
+    }
+
+    QCheckBox *enableCheckBox = new QCheckBox(u8"启用统计", this);
+    enableCheckBox->setChecked(Profiler::instance().isEnabled());
+    connect(enableCheckBox, &QCheckBox::toggled, this, [](bool checked) { Profiler::instance().setEnabled(checked); });
+
+    QPushButton *resetButton = new QPushButton(u8"清零", this);
+    QPushButton *csvButton = new QPushButton(u8"导出 CSV", this);
+    QPushButton *traceButton = new QPushButton(u8"导出 Trace", this);
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsDialog::reset);
+    connect(csvButton, &QPushButton::clicked, this, &DiagnosticsDialog::exportCsv);
+    connect(traceButton, &QPushButton::clicked, this, &DiagnosticsDialog::exportTrace);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(enableCheckBox);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(resetButton);
+    buttonLayout->addWidget(csvButton);
+    buttonLayout->addWidget(traceButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_table);
+    layout->addLayout(buttonLayout);
+
+    // 只在面板可见时刷新
+    m_timer->setInterval(500);
+    connect(m_timer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+}
+
+void DiagnosticsDialog::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    refresh();
+    m_timer->start();
+}
+
+void DiagnosticsDialog::hideEvent(QHideEvent *event)
+{
+    m_timer->stop();
+    QDialog::hideEvent(event);
+}
+
+void DiagnosticsDialog::refresh()
+{
+    for (int s = 0; s < Profiler::StageCount; ++s)
+    {
+        Profiler::Stats stats = Profiler::instance().stats(Profiler::Stage(s));
+        m_table->item(s, 0)->setText(QString::number(stats.count));
+        m_table->item(s, 1)->setText(QString::number(stats.p50 / 1000.0, 'f', 1));
+        m_table->item(s, 2)->setText(QString::number(stats.p99 / 1000.0, 'f', 1));
+        m_table->item(s, 3)->setText(QString::number(stats.max / 1000.0, 'f', 1));
+        m_table->item(s, 4)->setText(QString::number(stats.mean / 1000.0, 'f', 1));
+    }
+}
+
+void DiagnosticsDialog::reset()
+{
+    Profiler::instance().reset();
+    refresh();
+}
+
+void DiagnosticsDialog::exportCsv()
+{
+    QString path = QFileDialog::getSaveFileName(this, u8"导出 CSV", "latency.csv", "CSV Files (*.csv)");
+    if (!path.isEmpty() && !Profiler::instance().exportCsv(path))
+        QMessageBox::warning(this, "Warning", u8"导出失败。");
+}
+
+void DiagnosticsDialog::exportTrace()
+{
+    QString path = QFileDialog::getSaveFileName(this, u8"导出 Trace", "trace.json", "Chrome Trace (*.json)");
+    if (!path.isEmpty() && !Profiler::instance().exportTrace(path))
+        QMessageBox::warning(this, "Warning", u8"导出失败。");
+}
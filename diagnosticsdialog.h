@@ -0,0 +1,31 @@
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QTimer>
+
+// 诊断面板: 定时刷新 Profiler 各阶段的 count/p50/p99/max/mean，并可导出 CSV 或 Chrome trace
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsDialog(QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void refresh();
+    void exportCsv();
+    void exportTrace();
+    void reset();
+
+private:
+    QTableWidget* m_table;
+    QTimer*       m_timer;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
@@ -0,0 +1,204 @@
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <QElapsedTimer>
+#include <QRunnable>
+#include "focusfusion.h"
+
+namespace
+{
+
+class FusionTask : public QRunnable
+{
+public:
+    FusionTask(FocusFusion *fusion, const QString &fileName)
+        : m_fusion(fusion), m_fileName(fileName)
+    {
+    }
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+        Frame frame;
+        {
+            RawSequenceReader sequence;
+            if (sequence.open(m_fileName))
+                frame = FocusFusion::fuse(sequence);
+        }
+        removeRawSequence(m_fileName);
+        QMetaObject::invokeMethod(m_fusion, "taskFinished", Qt::QueuedConnection,
+                                  Q_ARG(Frame, frame), Q_ARG(qint64, timer.elapsed()));
+    }
+
+private:
+    FocusFusion* m_fusion;
+    QString      m_fileName;
+};
+
+cv::Mat frameMat(const Frame &frame)
+{
+    return cv::Mat(int(frame.height()), int(frame.width()), CV_8UC3, const_cast<uchar*>(frame.data()), frame.stride());
+}
+
+// 融合一块: outer 为参与计算的区域，inner 为写回结果的区域(均为整图坐标)
+void fuseTile(const QVector<cv::Mat> &planes, const cv::Rect &outer, const cv::Rect &inner, cv::Mat &result)
+{
+    const int levels = FocusFusion::Levels;
+    std::vector<cv::Mat> sum(levels + 1), weightSum(levels + 1);
+    std::vector<cv::Mat> gauss(levels + 1), weights(levels + 1);
+    cv::Mat gray, laplacian, measure, up, weight3;
+
+    for (const cv::Mat& plane : planes)
+    {
+        cv::Mat src = plane(outer);
+
+        // 清晰度: |Laplacian| 平滑后平方，拉开清晰层与模糊层的权重
+        cv::cvtColor(src, gray, cv::COLOR_RGB2GRAY);
+        cv::Laplacian(gray, laplacian, CV_32F, 3);
+        measure = cv::abs(laplacian);
+        cv::GaussianBlur(measure, measure, cv::Size(0, 0), 2.0);
+        weights[0] = measure.mul(measure) + 1e-6f;
+
+        src.convertTo(gauss[0], CV_32FC3, 1.0 / 255.0);
+        for (int l = 0; l < levels; ++l)
+        {
+            cv::pyrDown(gauss[l], gauss[l + 1]);
+            cv::pyrDown(weights[l], weights[l + 1]);
+        }
+
+        for (int l = 0; l <= levels; ++l)
+        {
+            // 拉普拉斯层 = 高斯层 - 上一层放大，最顶层直接用高斯层
+            cv::Mat band;
+            if (l < levels)
+            {
+                cv::pyrUp(gauss[l + 1], up, gauss[l].size());
+                cv::subtract(gauss[l], up, band);
+            }
+            else
+            {
+                band = gauss[l];
+            }
+            cv::merge(std::vector<cv::Mat>(3, weights[l]), weight3);
+            if (sum[l].empty())
+            {
+                sum[l] = band.mul(weight3);
+                weightSum[l] = weight3.clone();
+            }
+            else
+            {
+                sum[l] += band.mul(weight3);
+                weightSum[l] += weight3;
+            }
+        }
+    }
+
+    // 各层归一化后自顶向下重建
+    cv::Mat fused = sum[levels] / weightSum[levels];
+    for (int l = levels - 1; l >= 0; --l)
+    {
+        cv::pyrUp(fused, up, sum[l].size());
+        fused = up + sum[l] / weightSum[l];
+    }
+
+    cv::Rect local(inner.x - outer.x, inner.y - outer.y, inner.width, inner.height);
+    cv::Mat target = result(inner);
+    fused(local).convertTo(target, CV_8UC3, 255.0);
+}
+
+// 分块融合到 frame，frame 已按各层的尺寸分配
+void fusePlanes(const QVector<cv::Mat> &planes, Frame &frame)
+{
+    const int tileSize = FocusFusion::TileSize;
+    const int tileMargin = FocusFusion::TileMargin;
+    int width = int(frame.width());
+    int height = int(frame.height());
+    cv::Mat result = frameMat(frame);
+
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+    cv::Rect bounds(0, 0, width, height);
+    cv::parallel_for_(cv::Range(0, tilesX * tilesY), [&](const cv::Range &range) {
+        for (int t = range.start; t < range.end; ++t)
+        {
+            cv::Rect inner(t % tilesX * tileSize, t / tilesX * tileSize, tileSize, tileSize);
+            inner &= bounds;
+            cv::Rect outer(inner.x - tileMargin, inner.y - tileMargin, inner.width + 2 * tileMargin, inner.height + 2 * tileMargin);
+            outer &= bounds;
+            fuseTile(planes, outer, inner, result);
+        }
+    });
+}
+
+}
+
+FocusFusion::FocusFusion(QObject *parent)
+    : QObject(parent), m_pending(0)
+{
+    // 单个融合任务内部已经按块并行
+    m_pool.setMaxThreadCount(1);
+}
+
+FocusFusion::~FocusFusion()
+{
+    m_pool.waitForDone();
+}
+
+void FocusFusion::submit(const QString &fileName)
+{
+    ++m_pending;
+    m_pool.start(new FusionTask(this, fileName));
+}
+
+void FocusFusion::taskFinished(const Frame &frame, qint64 elapsedMs)
+{
+    --m_pending;
+    emit fused(frame, elapsedMs);
+}
+
+Frame FocusFusion::fuse(const QVector<Frame> &planes)
+{
+    if (planes.isEmpty() || planes.first().isNull())
+        return Frame();
+    unsigned width = planes.first().width();
+    unsigned height = planes.first().height();
+    QVector<cv::Mat> mats;
+    mats.reserve(planes.size());
+    for (const Frame& plane : planes)
+    {
+        if (plane.isNull() || plane.width() != width || plane.height() != height)
+            return Frame();
+        mats.append(frameMat(plane));
+    }
+
+    const Frame& middle = planes.at(planes.size() / 2);
+    Frame frame = Frame::allocate(width, height);
+    frame.setInfo(middle.info());
+    frame.setParams(middle.params());
+    frame.setArrival(middle.arrival());
+    fusePlanes(mats, frame);
+    return frame;
+}
+
+Frame FocusFusion::fuse(RawSequenceReader &sequence)
+{
+    if (0 == sequence.frameCount())
+        return Frame();
+    unsigned width = sequence.record(0).width;
+    unsigned height = sequence.record(0).height;
+    QVector<cv::Mat> mats;
+    mats.reserve(sequence.frameCount());
+    for (int i = 0; i < sequence.frameCount(); ++i)
+    {
+        const RawFrameRecord& record = sequence.record(i);
+        const uchar* data = sequence.frameData(i);
+        if (!data || record.width != width || record.height != height)
+            return Frame();
+        mats.append(cv::Mat(int(height), int(width), CV_8UC3, const_cast<uchar*>(data), record.stride));
+    }
+
+    Frame frame = Frame::allocate(width, height);
+    applyRawFrameRecord(frame, sequence.record(sequence.frameCount() / 2));
+    fusePlanes(mats, frame);
+    return frame;
+}
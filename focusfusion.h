@@ -0,0 +1,52 @@
+#ifndef FOCUSFUSION_H
+#define FOCUSFUSION_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+#include "frame.h"
+#include "rawsequence.h"
+
+// 景深融合(EDF): 把 Z 堆栈合成为一张全清晰图像
+// 每层以 |Laplacian| 平滑后的平方为权重，在拉普拉斯金字塔各层按权重的高斯金字塔加权平均后重建，
+// 过渡处不会出现硬拼接的边缘
+// 图像按 TileSize 分块(四周各留 TileMargin 像素参与金字塔计算)，各块由 cv::parallel_for_ 并行处理，
+// 每块逐层累加，计算用的缓冲只与块大小有关，与层数无关；
+// 各层由 ZStack 写入原始帧序列，融合时直接读取分段文件的内存映射，层数多时也不占用进程的私有内存
+class FocusFusion : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum
+    {
+        TileSize = 512,
+        TileMargin = 64,
+        Levels = 4          // 金字塔层数(不含原图)
+    };
+
+    explicit FocusFusion(QObject *parent = nullptr);
+    ~FocusFusion();
+
+    // 在后台线程融合原始帧序列 fileName 中的各层，完成后删除序列并发出 fused
+    void submit(const QString &fileName);
+    bool isBusy() const { return m_pending > 0; }
+
+    // 同步融合，可在任意线程调用；各层尺寸不一致或为空时返回空帧
+    // 结果的元数据取自中间一层
+    static Frame fuse(const QVector<Frame> &planes);
+    // 融合序列中的全部帧，像素直接取自分段映射；有帧无法读取时返回空帧
+    static Frame fuse(RawSequenceReader &sequence);
+
+signals:
+    void fused(const Frame &frame, qint64 elapsedMs);
+
+private slots:
+    void taskFinished(const Frame &frame, qint64 elapsedMs);
+
+private:
+    QThreadPool m_pool;
+    int         m_pending;
+};
+
+#endif // FOCUSFUSION_H
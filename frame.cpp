@@ -0,0 +1,55 @@
+#include <cstring>
+#include "frame.h"
+
+Frame::Frame(FrameRing* ring, int index)
+    : d(new Data)
+{
+    d->ring = ring;
+    d->index = index;
+}
+
+Frame Frame::take(FrameRing* ring)
+{
+    int index = ring->acquireRead();
+    if (index < 0)
+        return Frame();
+    return Frame(ring, index);
+}
+
+Frame Frame::allocate(unsigned width, unsigned height)
+{
+    Frame frame;
+    frame.d.reset(new Data);
+    unsigned stride = TDIBWIDTHBYTES(width * 24);
+    frame.d->storage.resize(size_t(stride) * height);
+
+    FrameRing::Slot& slot = frame.d->owned;
+    slot.data = frame.d->storage.data();
+    slot.width = width;
+    slot.height = height;
+    slot.stride = stride;
+    memset(&slot.info, 0, sizeof(slot.info));
+    memset(&slot.params, 0, sizeof(slot.params));
+    slot.arrival = 0;
+    return frame;
+}
+
+Frame Frame::copy() const
+{
+    if (isNull())
+        return Frame();
+
+    Frame frame = allocate(width(), height());
+    memcpy(frame.bits(), data(), byteCount());
+    frame.setInfo(info());
+    frame.setParams(params());
+    frame.setArrival(arrival());
+    return frame;
+}
+
+QImage Frame::image() const
+{
+    if (isNull())
+        return QImage();
+    return QImage(data(), int(width()), int(height()), int(stride()), QImage::Format_RGB888);
+}
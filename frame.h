@@ -0,0 +1,80 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <chrono>
+#include <vector>
+#include <QImage>
+#include <QMetaType>
+#include <QSharedPointer>
+#include "framering.h"
+
+// 单调时钟(纳秒)，用于记录帧在各处理阶段的时间
+inline qint64 frameClockNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 带元数据的图像帧: 像素 + NncamFrameInfoV3 + 采集时的曝光/增益/色温/Tint
+// 像素可以是 FrameRing 的槽位(引用计数，最后一个引用销毁时槽位归还)，
+// 也可以是自有内存(静态图像、拷贝)。句柄复制不会复制像素
+class Frame
+{
+public:
+    Frame() {}
+    Frame(FrameRing* ring, int index);
+
+    // 从帧缓冲中取出最早的就绪帧，没有可读帧时返回空句柄
+    static Frame take(FrameRing* ring);
+
+    // 分配一帧自有内存的 RGB24 图像
+    static Frame allocate(unsigned width, unsigned height);
+
+    // 深拷贝为自有内存的帧，常用于长期保存，避免占住 FrameRing 槽位
+    Frame copy() const;
+
+    bool isNull() const { return d.isNull(); }
+
+    const uchar* data() const { return slot().data; }
+    uchar* bits() { return slot().data; }
+    unsigned width() const { return slot().width; }
+    unsigned height() const { return slot().height; }
+    unsigned stride() const { return slot().stride; }
+    size_t byteCount() const { return size_t(slot().stride) * slot().height; }
+
+    const NncamFrameInfoV3& info() const { return slot().info; }
+    void setInfo(const NncamFrameInfoV3 &info) { slot().info = info; }
+    const FrameParams& params() const { return slot().params; }
+    void setParams(const FrameParams &params) { slot().params = params; }
+    qint64 arrival() const { return slot().arrival; }
+    void setArrival(qint64 arrival) { slot().arrival = arrival; }
+
+    // 帧序号与传感器时间戳(us)，相机未提供时为0
+    unsigned seq() const { return (info().flag & NNCAM_FRAMEINFO_FLAG_SEQ) ? info().seq : 0; }
+    unsigned long long timestamp() const { return (info().flag & NNCAM_FRAMEINFO_FLAG_TIMESTAMP) ? info().timestamp : 0; }
+    bool isStill() const { return (info().flag & NNCAM_FRAMEINFO_FLAG_STILL) != 0; }
+
+    // 浅引用像素的 QImage，仅在 Frame 存活期间有效
+    QImage image() const;
+
+private:
+    struct Data
+    {
+        FrameRing*         ring;
+        int                index;
+        FrameRing::Slot    owned;
+        std::vector<uchar> storage;
+
+        Data() : ring(nullptr), index(-1) {}
+        ~Data() { if (ring) ring->releaseRead(index); }
+    };
+
+    const FrameRing::Slot& slot() const { return d->ring ? d->ring->slot(d->index) : d->owned; }
+    FrameRing::Slot& slot() { return d->ring ? d->ring->slot(d->index) : d->owned; }
+
+    QSharedPointer<Data> d;
+};
+
+Q_DECLARE_METATYPE(Frame)
+
+#endif // FRAME_H
@@ -0,0 +1,117 @@
+#include <cstring>
+#include "framering.h"
+
+FrameRing::FrameRing(int slotCount, size_t slotBytes, DropPolicy policy)
+    : m_slotCount(slotCount), m_slotBytes(slotBytes)
+    , m_buffer(new uchar[slotBytes * slotCount])
+    , m_slots(new Slot[slotCount])
+    , m_control(new Control[slotCount])
+    , m_policy(policy), m_produced(0), m_consumed(0), m_dropped(0)
+{
+    for (int i = 0; i < m_slotCount; ++i)
+    {
+        m_slots[i].data = m_buffer + slotBytes * i;
+        m_slots[i].width = 0;
+        m_slots[i].height = 0;
+        m_slots[i].stride = 0;
+        memset(&m_slots[i].info, 0, sizeof(m_slots[i].info));
+        memset(&m_slots[i].params, 0, sizeof(m_slots[i].params));
+        m_slots[i].arrival = 0;
+        m_control[i].state.store(Free, std::memory_order_relaxed);
+        m_control[i].seq.store(0, std::memory_order_relaxed);
+    }
+}
+
+FrameRing::~FrameRing()
+{
+    delete[] m_control;
+    delete[] m_slots;
+    delete[] m_buffer;
+}
+
+int FrameRing::findOldestReady() const
+{
+    int oldest = -1;
+    quint64 oldestSeq = 0;
+    for (int i = 0; i < m_slotCount; ++i)
+    {
+        if (m_control[i].state.load(std::memory_order_acquire) == Ready)
+        {
+            quint64 seq = m_control[i].seq.load(std::memory_order_relaxed);
+            if (oldest < 0 || seq < oldestSeq)
+            {
+                oldest = i;
+                oldestSeq = seq;
+            }
+        }
+    }
+    return oldest;
+}
+
+int FrameRing::acquireWrite()
+{
+    for (;;)
+    {
+        // 优先使用空闲槽位
+        for (int i = 0; i < m_slotCount; ++i)
+        {
+            int expected = Free;
+            if (m_control[i].state.compare_exchange_strong(expected, Writing, std::memory_order_acquire))
+                return i;
+        }
+
+        if (dropPolicy() == DropNewest)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+
+        // 覆盖最旧的未读帧；若该帧恰好被消费者取走则重新查找
+        int oldest = findOldestReady();
+        if (oldest < 0)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        int expected = Ready;
+        if (m_control[oldest].state.compare_exchange_strong(expected, Writing, std::memory_order_acquire))
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return oldest;
+        }
+    }
+}
+
+void FrameRing::commitWrite(int index)
+{
+    quint64 seq = m_produced.fetch_add(1, std::memory_order_relaxed) + 1;
+    m_control[index].seq.store(seq, std::memory_order_relaxed);
+    m_control[index].state.store(Ready, std::memory_order_release);
+}
+
+void FrameRing::abortWrite(int index)
+{
+    m_control[index].state.store(Free, std::memory_order_release);
+}
+
+int FrameRing::acquireRead()
+{
+    for (;;)
+    {
+        int oldest = findOldestReady();
+        if (oldest < 0)
+            return -1;
+
+        int expected = Ready;
+        if (m_control[oldest].state.compare_exchange_strong(expected, Reading, std::memory_order_acquire))
+        {
+            m_consumed.fetch_add(1, std::memory_order_relaxed);
+            return oldest;
+        }
+    }
+}
+
+void FrameRing::releaseRead(int index)
+{
+    m_control[index].state.store(Free, std::memory_order_release);
+}
@@ -0,0 +1,102 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <atomic>
+#include <cstddef>
+#include <QtGlobal>
+#include "nncam.h"
+
+// 采集该帧时生效的曝光与白平衡参数
+struct FrameParams
+{
+    unsigned       expoTime;    // 曝光时间(us)
+    unsigned short expoGain;    // 模拟增益(%)
+    int            temp;        // 色温
+    int            tint;        // Tint
+    qint32         stage[5];    // 位移台 T/R/X/Y/Z 位置(步)，见 StageModel
+    int            stageSource; // StageModel::Source，0 表示没有位置信息
+};
+
+// 预分配的单生产者/单消费者帧缓冲环
+// 生产者(相机回调线程)与消费者(GUI线程)通过 acquire/release 显式交接槽位所有权，
+// 采集端永远不会因为渲染而阻塞
+class FrameRing
+{
+public:
+    enum DropPolicy
+    {
+        DropOldest,     // 缓冲满时覆盖最旧的未读帧
+        DropNewest      // 缓冲满时丢弃新到达的帧
+    };
+
+    struct Slot
+    {
+        uchar*           data;
+        unsigned         width;
+        unsigned         height;
+        unsigned         stride;
+        NncamFrameInfoV3 info;
+        FrameParams      params;
+        qint64           arrival;   // 帧到达回调的时间(ns)，见 frameClockNs()
+    };
+
+    FrameRing(int slotCount, size_t slotBytes, DropPolicy policy = DropOldest);
+    ~FrameRing();
+
+    // 生产者: 获取一个可写槽位，缓冲满且无法丢帧时返回 -1
+    int acquireWrite();
+    void commitWrite(int index);
+    void abortWrite(int index);
+
+    // 消费者: 按到达顺序获取一个已就绪的槽位，无可读帧时返回 -1
+    int acquireRead();
+    void releaseRead(int index);
+
+    Slot& slot(int index) { return m_slots[index]; }
+    const Slot& slot(int index) const { return m_slots[index]; }
+
+    int slotCount() const { return m_slotCount; }
+    size_t slotBytes() const { return m_slotBytes; }
+
+    void setDropPolicy(DropPolicy policy) { m_policy.store(policy, std::memory_order_relaxed); }
+    DropPolicy dropPolicy() const { return static_cast<DropPolicy>(m_policy.load(std::memory_order_relaxed)); }
+
+    quint64 producedCount() const { return m_produced.load(std::memory_order_relaxed); }
+    quint64 consumedCount() const { return m_consumed.load(std::memory_order_relaxed); }
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // 生产者没有写入环就放弃的帧(如帧大于槽位)，计入丢帧数
+    void countDropped() { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    enum State
+    {
+        Free,
+        Writing,
+        Ready,
+        Reading
+    };
+
+    struct Control
+    {
+        std::atomic<int>     state;
+        std::atomic<quint64> seq;
+    };
+
+    int findOldestReady() const;
+
+    FrameRing(const FrameRing&);
+    FrameRing& operator=(const FrameRing&);
+
+    int                  m_slotCount;
+    size_t               m_slotBytes;
+    uchar*               m_buffer;
+    Slot*                m_slots;
+    Control*             m_control;
+    std::atomic<int>     m_policy;
+    std::atomic<quint64> m_produced;
+    std::atomic<quint64> m_consumed;
+    std::atomic<quint64> m_dropped;
+};
+
+#endif // FRAMERING_H
@@ -0,0 +1,181 @@
+#include <QDateTime>
+#include <QFile>
+#include <QImageWriter>
+#include <QRunnable>
+#include "capturestore.h"
+#include "imageexporter.h"
+
+namespace
+{
+
+class ExportTask : public QRunnable
+{
+public:
+    ExportTask(ImageExporter *exporter, const ImageExporter::Job &job)
+        : m_exporter(exporter), m_job(job)
+    {
+    }
+
+    void run() override
+    {
+        Frame frame = m_job.frame;
+        if (frame.isNull() && !m_job.sourcePath.isEmpty())
+            frame = CaptureStore::readFile(m_job.sourcePath, m_job.record);
+
+        bool ok = !frame.isNull() && ImageExporter::write(frame, m_job.fileName, m_job.format, m_job.quality);
+        QMetaObject::invokeMethod(m_exporter, "jobFinished", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_job.fileName), Q_ARG(QString, m_job.sourcePath), Q_ARG(bool, ok));
+    }
+
+private:
+    ImageExporter*     m_exporter;
+    ImageExporter::Job m_job;
+};
+
+// 采集参数写入图像文本信息: PNG 为 tEXt 块，JPEG 为注释，TIFF 为 ImageDescription
+// 文本设置在写入器上，避免共享像素的 QImage 被深拷贝
+void setMetadata(QImageWriter &writer, const Frame &frame)
+{
+    const NncamFrameInfoV3& info = frame.info();
+    const FrameParams& params = frame.params();
+
+    writer.setText("Software", "ControlView");
+    writer.setText("ExposureTime", QString::number(params.expoTime));
+    writer.setText("ExposureGain", QString::number(params.expoGain));
+    writer.setText("Temperature", QString::number(params.temp));
+    writer.setText("Tint", QString::number(params.tint));
+    if (info.flag & NNCAM_FRAMEINFO_FLAG_SEQ)
+        writer.setText("Sequence", QString::number(info.seq));
+    if (info.flag & NNCAM_FRAMEINFO_FLAG_TIMESTAMP)
+        writer.setText("Timestamp", QString::number(info.timestamp));
+    if (params.stageSource)
+        writer.setText("StagePosition", QString::asprintf("T=%d R=%d X=%d Y=%d Z=%d", params.stage[0], params.stage[1],
+                                                          params.stage[2], params.stage[3], params.stage[4]));
+
+    writer.setText("Description", QString::asprintf("expotime=%uus gain=%u%% temp=%d tint=%d seq=%u timestamp=%lluus",
+                                                   params.expoTime, unsigned(params.expoGain), params.temp, params.tint,
+                                                   frame.seq(), frame.timestamp()));
+}
+
+}
+
+ImageExporter::ImageExporter(QObject *parent)
+    : QObject(parent), m_submitted(0), m_finished(0), m_failed(0)
+{
+}
+
+ImageExporter::~ImageExporter()
+{
+    waitForDone();
+}
+
+void ImageExporter::submit(const Job &job)
+{
+    ++m_submitted;
+    m_pool.start(new ExportTask(this, job));
+    emit progress(m_finished, m_submitted);
+}
+
+void ImageExporter::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+void ImageExporter::jobFinished(const QString &fileName, const QString &sourcePath, bool ok)
+{
+    ++m_finished;
+    if (!ok)
+        ++m_failed;
+
+    emit exported(fileName, sourcePath, ok);
+    emit progress(m_finished, m_submitted);
+
+    // 一批任务全部完成后计数清零
+    if (m_finished == m_submitted)
+    {
+        int failed = m_failed;
+        m_submitted = 0;
+        m_finished = 0;
+        m_failed = 0;
+        emit finished(failed);
+    }
+}
+
+QString ImageExporter::suffix(Format format)
+{
+    switch (format)
+    {
+    case Png:       return "png";
+    case Tiff:
+    case Tiff16:    return "tif";
+    case Raw:       return "raw";
+    default:        return "jpg";
+    }
+}
+
+QString ImageExporter::filter(Format format)
+{
+    switch (format)
+    {
+    case Png:       return "PNG Files (*.png)";
+    case Tiff:      return "TIFF Files (*.tif)";
+    case Tiff16:    return "TIFF 16-bit Files (*.tif)";
+    case Raw:       return "Raw Files (*.raw)";
+    default:        return "JPEG Files (*.jpg)";
+    }
+}
+
+ImageExporter::Format ImageExporter::formatFromFilter(const QString &filter)
+{
+    const Format formats[] = { Jpeg, Png, Tiff, Tiff16, Raw };
+    for (Format format : formats)
+    {
+        if (filter == ImageExporter::filter(format))
+            return format;
+    }
+    return Jpeg;
+}
+
+QString ImageExporter::expandTemplate(const QString &pattern, int number, const RawFrameRecord &record)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    QString name = pattern;
+    name.replace("{n}", QString::asprintf("%04d", number));
+    name.replace("{seq}", QString::number(record.seq));
+    name.replace("{date}", now.toString("yyyyMMdd"));
+    name.replace("{time}", now.toString("HHmmss"));
+    name.replace("{expo}", QString::number(record.expoTime));
+    name.replace("{gain}", QString::number(record.expoGain));
+    name.replace("{x}", QString::number(record.stage[2]));
+    name.replace("{y}", QString::number(record.stage[3]));
+    name.replace("{z}", QString::number(record.stage[4]));
+    return name;
+}
+
+bool ImageExporter::write(const Frame &frame, const QString &fileName, Format format, int quality)
+{
+    if (format == Raw)
+    {
+        // 与 CaptureStore 临时文件相同的布局: 定长记录 + 像素
+        RawFrameRecord record = rawFrameRecord(frame);
+        record.offset = sizeof(RawFrameRecord);
+        qint64 bytes = qint64(frame.byteCount());
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+        return file.write(reinterpret_cast<const char*>(&record), sizeof(record)) == qint64(sizeof(record))
+            && file.write(reinterpret_cast<const char*>(frame.data()), bytes) == bytes;
+    }
+
+    // 相机输出为 RGB24，16 位 TIFF 按 x257 扩展到 16 位满量程
+    QImage image = (format == Tiff16) ? frame.image().convertToFormat(QImage::Format_RGBX64) : frame.image();
+
+    QImageWriter writer(fileName, format == Jpeg ? "jpg" : format == Png ? "png" : "tiff");
+    setMetadata(writer, frame);
+    if (format == Jpeg)
+        writer.setQuality(quality);
+    else if (format == Tiff || format == Tiff16)
+        writer.setCompression(1);   // LZW
+    return writer.write(image);
+}
@@ -0,0 +1,73 @@
+#ifndef IMAGEEXPORTER_H
+#define IMAGEEXPORTER_H
+
+#include <cstring>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include "frame.h"
+#include "rawsequence.h"
+
+// 抓拍图像导出
+// 编码与写文件在线程池中完成，GUI 线程只提交任务并接收完成通知
+class ImageExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Format
+    {
+        Jpeg,
+        Png,
+        Tiff,       // 无损 8 位 TIFF
+        Tiff16,     // 无损 16 位 TIFF
+        Raw         // RawFrameRecord + 原始 RGB24 像素
+    };
+
+    struct Job
+    {
+        Frame          frame;       // 已在内存中的图像，为空时从 sourcePath 读取
+        QString        sourcePath;  // CaptureStore 临时文件，导出后保留，由调用者在成功后移除
+        RawFrameRecord record;
+        QString        fileName;
+        Format         format;
+        int            quality;     // JPEG 质量 0-100
+
+        Job() : format(Jpeg), quality(95) { memset(&record, 0, sizeof(record)); }
+    };
+
+    explicit ImageExporter(QObject *parent = nullptr);
+    ~ImageExporter();
+
+    void submit(const Job &job);
+    void waitForDone();
+
+    int pending() const { return m_submitted - m_finished; }
+
+    static QString suffix(Format format);
+    static QString filter(Format format);
+    static Format formatFromFilter(const QString &filter);
+
+    // 命名模板: {n} 序号, {seq} 帧序号, {date} 日期, {time} 时间, {expo} 曝光(us), {gain} 增益(%),
+    //          {x} {y} {z} 位移台位置(步)
+    static QString expandTemplate(const QString &pattern, int number, const RawFrameRecord &record);
+
+    // 编码并写入一帧，可在任意线程调用
+    static bool write(const Frame &frame, const QString &fileName, Format format, int quality);
+
+signals:
+    void exported(const QString &fileName, const QString &sourcePath, bool ok);
+    void progress(int done, int total);
+    void finished(int failed);
+
+private slots:
+    void jobFinished(const QString &fileName, const QString &sourcePath, bool ok);
+
+private:
+    QThreadPool m_pool;
+    int         m_submitted;
+    int         m_finished;
+    int         m_failed;
+};
+
+#endif // IMAGEEXPORTER_H
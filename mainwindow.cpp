@@ -1,28 +1,40 @@
+#include <cmath>
 #include <QMessageBox>
 #include <QTimer>
 #include <QFileDialog>
+#include <QInputDialog>
+#include <QProgressDialog>
+#include <QScrollBar>
 #include <QDebug>
+#include <QDir>
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include "crc16.h"
+#include "diagnosticsdialog.h"
+#include "profiler.h"
 
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
-    , m_isRecording(false)
-    , m_hcam(nullptr)
+    , m_recorder(nullptr)
+    , m_isRecording(false), m_lastWritten(0), m_measuredFps(0.0)
+    , m_camera(nullptr)
     , m_timer(new QTimer(this))
-    , m_serialTimer(new QTimer(this))
-    , m_imgWidth(5440), m_imgHeight(3648), m_pData(nullptr)
+    , m_imgWidth(5440), m_imgHeight(3648), m_frameRing(nullptr), m_captureRequested(false)
     , m_res(0), m_temp(NNCAM_TEMP_DEF), m_tint(NNCAM_TINT_DEF)
     , m_red(0), m_green(0), m_blue(0), m_count(0)
-    , m_pixmapItem(nullptr), m_aeItem(nullptr), m_awbItem(nullptr), m_abbItem(nullptr)
-    , m_serial(new QSerialPort(this))
+    , m_aeItem(nullptr), m_awbItem(nullptr), m_abbItem(nullptr)
+    , m_cameraThread(nullptr), m_acquisitionMode(cameraThread::PullMode)
+    , m_latencyFrames(0), m_latencyNs(0), m_lastSeq(0), m_lostFrames(0)
 {
     ui->setupUi(this);
     // setWindowFlags(Qt::FramelessWindowHint);
 
+    // Frame 需要跨线程通过信号传递
+    qRegisterMetaType<Frame>("Frame");
+    qRegisterMetaType<StageStatus>("StageStatus");
+    qRegisterMetaType<MotionPacket>("MotionPacket");
+
     QFile qss(":qdarkstyle/dark/darkstyle.qss");
 
     if(qss.open(QFile::ReadOnly))
@@ -38,11 +50,26 @@ MainWindow::MainWindow(QWidget *parent)
 
     // 初始化相机预览窗口
     m_scene = new MyGraphicsScene(this);
-    m_imageView = new QGraphicsView(m_scene, this);
+    m_imageView = new PreviewView(m_scene, this);
     ui->imageViewLayout->addWidget(m_imageView);
 
-    m_pixmapItem = new QGraphicsPixmapItem();
-    m_scene->addItem(m_pixmapItem);
+    // 缩放平移时场景坐标不变，叠加的矩形与测量线随视图一起缩放
+    connect(m_imageView, &PreviewView::viewChanged, this, &MainWindow::updatePreviewRegion);
+
+    // 硬件 ROI 切换需要重新配置传感器，停止缩放平移后再设置
+    m_roiTimer = new QTimer(this);
+    m_roiTimer->setSingleShot(true);
+    m_roiTimer->setInterval(300);
+    connect(m_roiTimer, &QTimer::timeout, this, &MainWindow::updateHardwareRoi);
+
+    // 位移台坐标叠加在预览左上角，字号不随视图缩放
+    m_stageItem = new QGraphicsSimpleTextItem();
+    m_stageItem->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+    m_stageItem->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    m_stageItem->setBrush(Qt::yellow);
+    m_stageItem->setZValue(10);
+    m_stageItem->setVisible(false);
+    m_scene->addItem(m_stageItem);
 
     connect(ui->lineMeasureButton, &QPushButton::clicked, m_scene, &MyGraphicsScene::startDrawingLine);
     connect(ui->lineDeleteButton, &QPushButton::clicked, m_scene, &MyGraphicsScene::removeSelectedLine);
@@ -126,13 +153,88 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_timer, &QTimer::timeout, this, [this]()
     {
         unsigned nFrame = 0, nTime = 0, nTotalFrame = 0;
-        if (m_hcam && SUCCEEDED(Nncam_get_FrameRate(m_hcam, &nFrame, &nTime, &nTotalFrame)) && (nTime > 0))
-            ui->lblLabel->setText(QString::asprintf("%u, fps = %.1f", nTotalFrame, nFrame * 1000.0 / nTime));
+        if (m_camera && SUCCEEDED(m_camera->get_FrameRate(&nFrame, &nTime, &nTotalFrame)) && (nTime > 0))
+        {
+            m_measuredFps = nFrame * 1000.0 / nTime;
+            QString text = QString::asprintf("%u, fps = %.1f", nTotalFrame, m_measuredFps);
+            if (m_frameRing)
+                text += QString::asprintf(", produced = %llu, consumed = %llu, dropped = %llu, lost = %llu",
+                                          m_frameRing->producedCount(), m_frameRing->consumedCount(), m_frameRing->droppedCount(), m_lostFrames);
+            if (m_cameraThread)
+            {
+                // 采集回调每帧CPU耗时与回调到GUI取帧的延迟
+                quint64 cbFrames = 0, cbNs = 0;
+                m_cameraThread->takeCallbackStats(cbFrames, cbNs);
+                text += QString::asprintf(", %s, callback = %.1f us, latency = %.2f ms",
+                                          m_acquisitionMode == cameraThread::PushMode ? "push" : "pull",
+                                          cbFrames ? cbNs / 1000.0 / cbFrames : 0.0,
+                                          m_latencyFrames ? m_latencyNs / 1000000.0 / m_latencyFrames : 0.0);
+                m_latencyFrames = 0;
+                m_latencyNs = 0;
+                if (m_cameraThread->oversizedCount())
+                    text += QString::asprintf(", oversized = %llu", m_cameraThread->oversizedCount());
+            }
+            if (m_recorder)
+            {
+                // 录像队列深度、编码帧率与因队列满丢弃的帧数
+                quint64 written = m_recorder->writtenCount();
+                text += QString::asprintf(", rec queue = %d, encode fps = %llu, rec dropped = %llu, dup = %llu, skip = %llu",
+                                          m_recorder->queueDepth(), written - m_lastWritten, m_recorder->droppedCount(),
+                                          m_recorder->duplicatedCount(), m_recorder->skippedCount());
+                m_lastWritten = written;
+            }
+            ui->lblLabel->setText(text);
+        }
     });
 
     // 连接tab关闭信号和槽
     ui->tabWidget->setTabsClosable(true);
     connect(ui->tabWidget, &QTabWidget::tabCloseRequested, this, &MainWindow::closeTab);
+
+    // 图像导出在线程池中进行，批量导出时显示进度
+    m_exporter = new ImageExporter(this);
+    connect(m_exporter, &ImageExporter::progress, this, [this](int done, int total)
+    {
+        if (m_exportProgress)
+        {
+            m_exportProgress->setMaximum(total);
+            m_exportProgress->setValue(done);
+        }
+    });
+    connect(m_exporter, &ImageExporter::exported, this, [this](const QString &fileName, const QString &sourcePath, bool ok)
+    {
+        Q_UNUSED(fileName);
+        // 导出成功后才移除抓拍；失败时标签页与临时文件保留，可以再次保存
+        if (!m_removeOnExport.remove(sourcePath) || !ok)
+            return;
+        int capture = m_captures.indexOf(sourcePath);
+        if (capture >= 0)
+        {
+            removeCaptureTab(capture);
+            m_captures.remove(capture);
+        }
+    });
+    connect(m_exporter, &ImageExporter::finished, this, [this](int failed)
+    {
+        if (m_exportProgress)
+        {
+            m_exportProgress->deleteLater();
+            m_exportProgress = nullptr;
+        }
+
+        // 关闭相机时推迟的清理，有图像保存失败时保留全部抓拍
+        if (m_clearCapturesPending)
+        {
+            m_clearCapturesPending = false;
+            if (0 == failed)
+                clearCaptures();
+            ui->searchCameraButton->setEnabled(true);
+            ui->cameraButton->setEnabled(true);
+        }
+
+        if (failed > 0)
+            QMessageBox::warning(this, "Warning", QString(u8"%1 张图像保存失败，未保存的图像仍保留在标签页中，可以重新保存。").arg(failed));
+    });
     connect(ui->lowSpeedRadioButton, &QRadioButton::clicked, this, &MainWindow::onSpeedChanged);
     connect(ui->mediumSpeedRadioButton, &QRadioButton::clicked, this, &MainWindow::onSpeedChanged);
     connect(ui->highSpeedRadioButton, &QRadioButton::clicked, this, &MainWindow::onSpeedChanged);
@@ -152,98 +254,215 @@ MainWindow::MainWindow(QWidget *parent)
         ui->unitComboBox->setCurrentIndex(0);
     }
 
-    // 串口连接断开监测
-    connect(m_serial, &QSerialPort::errorOccurred, this, &MainWindow::handleSerialError);
-
-    // 默认串口发送数据
-    sendDataPacket = createPacket(defaultData);
-    defaultDataPacket = createPacket(defaultData);
-
-    // 串口x, y, z轴定时器
-    // m_serialTimer->setInterval(33);
-    connect(m_serialTimer, &QTimer::timeout, this, &MainWindow::sendData);
-
-    // x轴按钮
-    connect(ui->xAxisForwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(xForwardData);
-    });
-    connect(ui->xAxisForwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    // 串口消息日志: 定长缓冲 + 合并刷新，视图只绘制可见行
+    m_serialLog = new SerialLogModel(SerialLogModel::DefaultCapacity, this);
+    m_serialLogFilter = new QSortFilterProxyModel(this);
+    m_serialLogFilter->setSourceModel(m_serialLog);
+    m_serialLogFilter->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    ui->serialLogView->setModel(m_serialLogFilter);
+    connect(ui->serialFilterEdit, &QLineEdit::textChanged, m_serialLogFilter, &QSortFilterProxyModel::setFilterFixedString);
+    connect(ui->serialClearButton, &QPushButton::clicked, m_serialLog, &SerialLogModel::clear);
+    // 停在末尾时跟随新消息，向上翻看时不跳动
+    connect(m_serialLogFilter, &QAbstractItemModel::rowsInserted, this, [this]() {
+        if (m_serialLogFollow)
+            ui->serialLogView->scrollToBottom();
     });
-    connect(ui->xAxisBackwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(xBackwardData);
-    });
-    connect(ui->xAxisBackwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(ui->serialLogView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        m_serialLogFollow = (value == ui->serialLogView->verticalScrollBar()->maximum());
     });
 
-    // y轴按钮
-    connect(ui->yAxisForwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(yForwardData);
+    // 串口收发线程，运动指令的发送不受 GUI 线程负载影响
+    m_serialThread = new QThread(this);
+    m_serialWorker = new SerialWorker();
+    m_serialWorker->setStageModel(&m_stage);
+    m_serialWorker->moveToThread(m_serialThread);
+    connect(m_serialThread, &QThread::finished, m_serialWorker, &QObject::deleteLater);
+    connect(m_serialWorker, &SerialWorker::opened, this, &MainWindow::handleSerialOpened);
+    // 串口连接断开监测
+    connect(m_serialWorker, &SerialWorker::errorOccurred, this, &MainWindow::handleSerialError);
+    connect(m_serialWorker, &SerialWorker::statusReceived, this, &MainWindow::handleStageStatus);
+    connect(m_serialWorker, &SerialWorker::receiveError, this, &MainWindow::handleReceiveError);
+    connect(m_serialWorker, &SerialWorker::sent, this, [this](const MotionPacket &packet) {
+        m_serialLog->append(SerialLogModel::Sent, QString::fromLatin1(QByteArray::fromRawData(packet.data(), MotionPacket::size()).toHex(' ')));
     });
-    connect(ui->yAxisForwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(m_serialWorker, &SerialWorker::dumpError, this, [this](const QString &message) {
+        QSignalBlocker blocker(ui->serialDumpCheckBox);
+        ui->serialDumpCheckBox->setChecked(false);
+        m_serialLog->append(SerialLogModel::Error, u8"转储失败：" + message);
     });
-    connect(ui->yAxisBackwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(yBackwardData);
+    m_serialThread->start();
+
+    // 位置由串口线程更新，界面按 10Hz 刷新
+    m_stageTimer = new QTimer(this);
+    connect(m_stageTimer, &QTimer::timeout, this, &MainWindow::updateStageOverlay);
+    m_stageTimer->start(100);
+
+    // 自动对焦
+    m_autofocus = new Autofocus(this);
+    connect(m_autofocus, &Autofocus::move, this, [this](qint32 steps) {
+        moveZ(steps);
+        m_autofocusDrain = drainSerial();
     });
-    connect(ui->yAxisBackwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(m_autofocus, &Autofocus::finished, this, [this](bool ok, qint32 position, double score, const QString &message) {
+        ui->autofocusButton->setText(u8"自动对焦");
+        if (ok)
+            m_serialLog->append(SerialLogModel::Info, QString(u8"自动对焦完成：Z %1 步，清晰度 %2").arg(position).arg(score, 0, 'f', 1));
+        else
+            m_serialLog->append(SerialLogModel::Error, u8"自动对焦失败：" + message);
     });
 
-    // z轴按钮
-    connect(ui->zAxisForwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(zForwardData);
+    // Z 堆栈采集与景深融合
+    m_zStack = new ZStack(this);
+    m_fusion = new FocusFusion(this);
+    // 稳定时间从最后一包指令实际写出串口时开始计算
+    connect(m_zStack, &ZStack::move, this, [this](qint32 steps) {
+        moveZ(steps);
+        m_zStackDrain = drainSerial();
     });
-    connect(ui->zAxisForwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(m_zStack, &ZStack::snap, this, [this]() {
+        if (!m_camera || FAILED(m_camera->Snap(ui->captureComboBox->currentData().toUInt())))
+        {
+            m_serialLog->append(SerialLogModel::Error, u8"抓拍失败。");
+            m_zStack->stop();
+        }
     });
-    connect(ui->zAxisBackwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(zBackwardData);
+    connect(m_zStack, &ZStack::progress, this, [this](int done, int total) {
+        ui->zStackButton->setText(QString(u8"停止 %1/%2").arg(done).arg(total));
     });
-    connect(ui->zAxisBackwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(m_zStack, &ZStack::finished, this, [this](bool ok, const QString &message) {
+        ui->zStackButton->setText(u8"景深融合");
+        if (!ok)
+            m_serialLog->append(SerialLogModel::Error, u8"Z 堆栈采集失败：" + message);
     });
-
-    // r轴按钮
-    connect(ui->rAxisForwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(rForwardData);
+    // 各层在抓拍仓库的临时目录中写成原始帧序列，融合后由 FocusFusion 删除
+    connect(m_zStack, &ZStack::acquired, this, [this](const QString &fileName, int planes) {
+        m_serialLog->append(SerialLogModel::Info, QString(u8"Z 堆栈采集完成，共 %1 层，开始融合").arg(planes));
+        ui->zStackButton->setEnabled(false);
+        m_fusion->submit(fileName);
     });
-    connect(ui->rAxisForwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(m_fusion, &FocusFusion::fused, this, [this](const Frame &frame, qint64 elapsedMs) {
+        ui->zStackButton->setEnabled(m_serialOpen);
+        if (frame.isNull())
+        {
+            QMessageBox::warning(this, "Warning", u8"景深融合失败，各层图像尺寸不一致或无法读取。");
+            return;
+        }
+        m_serialLog->append(SerialLogModel::Info, QString(u8"景深融合完成，耗时 %1 ms").arg(elapsedMs));
+        addCaptureTab(frame);
     });
-    connect(ui->rAxisBackwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(rBackwardData);
+
+    // XY 扫描拼接: 抓拍到的图像立即交给后台拼接
+    m_mosaicScan = new MosaicScan(this);
+    m_mosaicBuilder = new MosaicBuilder(this);
+    connect(m_mosaicScan, &MosaicScan::move, this, [this](qint32 dx, qint32 dy) {
+        moveStage(StageModel::X, dx);
+        moveStage(StageModel::Y, dy);
+        m_mosaicDrain = drainSerial();
+    });
+    connect(m_mosaicScan, &MosaicScan::snap, this, [this]() {
+        if (!m_camera || FAILED(m_camera->Snap(ui->captureComboBox->currentData().toUInt())))
+        {
+            m_serialLog->append(SerialLogModel::Error, u8"抓拍失败。");
+            m_mosaicScan->stop();
+        }
     });
-    connect(ui->rAxisBackwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(m_mosaicScan, &MosaicScan::tileAcquired, m_mosaicBuilder, &MosaicBuilder::addTile);
+    connect(m_mosaicScan, &MosaicScan::progress, this, [this](int done, int total) {
+        ui->mosaicButton->setText(QString(u8"停止 %1/%2").arg(done).arg(total));
     });
-
-    // t轴按钮
-    connect(ui->tAxisForwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(tForwardData);
+    connect(m_mosaicScan, &MosaicScan::finished, this, [this](bool ok, const QString &message) {
+        ui->mosaicButton->setText(u8"扫描拼接");
+        if (!ok)
+            m_serialLog->append(SerialLogModel::Error, u8"扫描中断：" + message + u8"，保存已采集的部分");
+        // 已提交的图像拼完后才会保存
+        ui->mosaicButton->setEnabled(false);
+        m_mosaicBuilder->finish(m_mosaicDir);
     });
-    connect(ui->tAxisForwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+    connect(m_mosaicBuilder, &MosaicBuilder::tilePlaced, this, [this](int column, int row, double x, double y, double response, bool registered) {
+        if (registered)
+            m_serialLog->append(SerialLogModel::Info, QString(u8"拼接 (%1, %2)：位置 %3, %4，相关 %5")
+                                .arg(column).arg(row).arg(x, 0, 'f', 1).arg(y, 0, 'f', 1).arg(response, 0, 'f', 2));
+        else
+            m_serialLog->append(SerialLogModel::Error, QString(u8"拼接 (%1, %2)：配准失败，按标称位置放置").arg(column).arg(row));
     });
-    connect(ui->tAxisBackwardButton, &QPushButton::pressed, this, [this]() {
-        sendDataPacket = createPacket(tBackwardData);
+    connect(m_mosaicBuilder, &MosaicBuilder::finished, this, [this](bool ok, const QString &directory) {
+        ui->mosaicButton->setEnabled(m_serialOpen);
+        if (!ok)
+        {
+            QMessageBox::warning(this, "Warning", u8"拼接结果保存失败：" + directory);
+            return;
+        }
+        m_serialLog->append(SerialLogModel::Info, u8"拼接结果已保存到 " + directory);
+        addMosaicTab(directory);
     });
-    connect(ui->tAxisBackwardButton, &QPushButton::released, this, [this]() {
-        sendDataPacket = defaultDataPacket;
+
+    // 移动指令全部写出串口后开始计算稳定时间，过期的标记忽略
+    connect(m_serialWorker, &SerialWorker::drained, this, [this](int tag) {
+        if (tag == m_autofocusDrain)
+        {
+            m_autofocusDrain = 0;
+            m_autofocus->moveSent();
+        }
+        if (tag == m_zStackDrain)
+        {
+            m_zStackDrain = 0;
+            m_zStack->moveSent();
+        }
+        if (tag == m_mosaicDrain)
+        {
+            m_mosaicDrain = 0;
+            m_mosaicScan->moveSent();
+        }
     });
 
+    // 默认串口发送数据
+    updateIdlePacket();
+    on_keepAliveSpinBox_valueChanged(ui->keepAliveSpinBox->value());
+
+    // 各轴按钮: 按住时按当前档位运动，松开恢复空闲指令
+    struct AxisButton
+    {
+        QPushButton*     button;
+        StageModel::Axis axis;
+        int              direction;
+    };
+    const AxisButton axisButtons[] = {
+        { ui->xAxisForwardButton, StageModel::X, 1 }, { ui->xAxisBackwardButton, StageModel::X, -1 },
+        { ui->yAxisForwardButton, StageModel::Y, 1 }, { ui->yAxisBackwardButton, StageModel::Y, -1 },
+        { ui->zAxisForwardButton, StageModel::Z, 1 }, { ui->zAxisBackwardButton, StageModel::Z, -1 },
+        { ui->rAxisForwardButton, StageModel::R, 1 }, { ui->rAxisBackwardButton, StageModel::R, -1 },
+        { ui->tAxisForwardButton, StageModel::T, 1 }, { ui->tAxisBackwardButton, StageModel::T, -1 },
+    };
+    for (const AxisButton& b : axisButtons)
+    {
+        StageModel::Axis axis = b.axis;
+        int direction = b.direction;
+        connect(b.button, &QPushButton::pressed, this, [this, axis, direction]() {
+            sendPacket(movePacket(axis, direction));
+        });
+        connect(b.button, &QPushButton::released, this, [this]() {
+            sendPacket(m_idlePacket);
+        });
+    }
+
     this->showMaximized();
 }
 
 MainWindow::~MainWindow()
 {
+    // 等待导出任务完成后临时目录才会被删除
+    m_exporter->waitForDone();
+
+    // 串口在其所属线程中关闭，线程结束时释放 m_serialWorker
+    QMetaObject::invokeMethod(m_serialWorker, "close", Qt::BlockingQueuedConnection);
+    m_serialThread->quit();
+    m_serialThread->wait();
     delete ui;
 }
 
 void MainWindow::closeEvent(QCloseEvent* event)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         int closeRes = closeCamera();
         if (closeRes == 1)
@@ -258,13 +477,10 @@ void MainWindow::closeEvent(QCloseEvent* event)
         }
     }
 
-    if (m_serial)
+    if (m_serialOpen)
     {
         closeSerial();
     }
-
-    delete m_serialTimer;
-    m_serialTimer = nullptr;
 }
 
 void MainWindow::resizeEvent(QResizeEvent *event)
@@ -276,12 +492,13 @@ void MainWindow::resizeEvent(QResizeEvent *event)
     float ratio = float(m_previewWidth) / m_imgWidth;
     m_previewHeight = int(m_imgHeight * ratio);
     m_scene->setSceneRect(0, 0, m_previewWidth, m_previewHeight);
+    updatePreviewRegion();
 }
 
 void MainWindow::on_searchCameraButton_clicked()
 {
     // 如果相机已打开，则关闭相机
-    if (m_hcam)
+    if (m_camera)
     {
         closeCamera();
     }
@@ -291,7 +508,7 @@ void MainWindow::on_searchCameraButton_clicked()
         ui->cameraComboBox->clear();
         // 枚举可用相机设备
         NncamDeviceV2 arr[NNCAM_MAX] = { 0 };
-        unsigned count = Nncam_EnumV2(arr);
+        unsigned count = CameraDevice::EnumV2(arr);
         // 如果没有找到相机，则显示警告信息
         if (0 == count)
             QMessageBox::warning(this, "Warning", u8"没有找到相机。");
@@ -328,62 +545,20 @@ void MainWindow::on_cameraButton_clicked()
 
 void MainWindow::on_captureButton_clicked()
 {
-    if (m_hcam)
+    if (m_camera)
     {
-        // if (0 == m_cur.model->still)    // not support still image capture
-        // {
-        //     if (m_pData)
-        //     {
-        //         QImage image(m_pData, m_imgWidth, m_imgHeight, QImage::Format_RGB888);
-
-        //         // 创建一个新的标签页
-        //         QWidget *newTab = new QWidget();
-        //         QLabel *imageLabel = new QLabel(newTab);
-
-        //         // 设置标签页的布局，确保QLabel自适应标签页大小
-        //         QVBoxLayout *layout = new QVBoxLayout(newTab);
-        //         layout->addWidget(imageLabel);
-        //         layout->setContentsMargins(0, 0, 0, 0);
-        //         newTab->setLayout(layout);
-
-        //         QPixmap pixmap = QPixmap::fromImage(image.scaled(newTab->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        //         imageLabel->setScaledContents(true);
-        //         imageLabel->setPixmap(pixmap);
-
-        //         // 将新创建的QImage存储到vetor中，并添加标签页到tabWidget
-        //         ui->tabWidget->addTab(newTab, QString("image_") + QString::number(++m_count));
-        //         imageVector.append(image);
-        //     }
-        // }
-        // else
-        // {
-        //     int currentCaptureIndex = ui->captureComboBox->currentIndex();
-
-        //     // 使用当前选中的序号作为参数调用 Nncam_Snap 函数
-        //     Nncam_Snap(m_hcam, currentCaptureIndex);
-        // }
-
-        if (m_pData)
+        if (0 == m_cur.model->still)    // not support still image capture
         {
-            QImage image(m_pData, m_imgWidth, m_imgHeight, QImage::Format_RGB888);
-
-            // 创建一个新的标签页
-            QWidget *newTab = new QWidget();
-            QLabel *imageLabel = new QLabel(newTab);
-
-            // 设置标签页的布局，确保QLabel自适应标签页大小
-            QVBoxLayout *layout = new QVBoxLayout(newTab);
-            layout->addWidget(imageLabel);
-            layout->setContentsMargins(0, 0, 0, 0);
-            newTab->setLayout(layout);
-            ui->tabWidget->addTab(newTab, QString("image_") + QString::number(++m_count));
-
-            QPixmap pixmap = QPixmap::fromImage(image.scaled(newTab->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
-            imageLabel->setScaledContents(true);
-            imageLabel->setPixmap(pixmap);
-
-            // 将新创建的QImage存储到vetor中
-            imageVector.append(image);
+            // 下一帧到达时由 handleImageCaptured 复制保存
+            // 硬件 ROI 的帧只覆盖部分视野且不带位置信息，抓拍前恢复整个视野，抓到后再按缩放重新设置
+            m_captureRequested = true;
+            setHardwareRoi(QRect());
+        }
+        else
+        {
+            // 使用当前选中的分辨率序号调用 Nncam_Snap 函数，预览流不中断，静态图像由 handleStillImageCaptured 接收
+            if (FAILED(m_camera->Snap(ui->captureComboBox->currentData().toUInt())))
+                QMessageBox::warning(this, "Warning", u8"抓拍失败。");
         }
     }
 }
@@ -393,36 +568,69 @@ void MainWindow::on_videoButton_clicked()
     if (ui->videoButton->text() == "录像")
     {
         // 确保相机已经打开，并且有有效的图像数据
-        if (!m_hcam)
+        if (!m_camera)
         {
             QMessageBox::warning(this, "Warning", u8"请先打开相机。");
             return;
         }
 
-        QString videoFileName = QFileDialog::getSaveFileName(this, tr("Save Video"), "", tr("Video Files (*.avi)"));
+        const QString cfrFilter = tr("Video Files (*.avi)");
+        const QString vfrFilter = tr(u8"Video Files, 可变帧率 + 时间戳 (*.avi)");
+        const QString rawFilter = tr(u8"Raw Sequence, 无损 (*.rawseq)");
+        QString selectedFilter;
+        QString videoFileName = QFileDialog::getSaveFileName(this, tr("Save Video"), "", cfrFilter + ";;" + vfrFilter + ";;" + rawFilter, &selectedFilter);
         if (!videoFileName.isEmpty())
         {
-            double fps = 10.0;
-            // m_videoWriter.open(videoFileName.toStdString(), cv::VideoWriter::fourcc('X','2','6','4'), fps, cv::Size(m_imgWidth, m_imgHeight), true);  // .mp4 .mkv
-            m_videoWriter.open(videoFileName.toStdString(), cv::VideoWriter::fourcc('M','J','P','G'), fps, cv::Size(m_imgWidth, m_imgHeight), true);  // .avi .mov
-            // m_videoWriter.open(videoFileName.toStdString(), cv::VideoWriter::fourcc('X','V','I','D'), fps, cv::Size(m_imgWidth, m_imgHeight), true);  // .avi .mp4 .mkv
-
-            if (m_videoWriter.isOpened())
+            // 使用实测采集帧率，尚无统计时直接向相机查询
+            double fps = m_measuredFps;
+            unsigned nFrame = 0, nTime = 0, nTotalFrame = 0;
+            if (fps <= 0 && SUCCEEDED(m_camera->get_FrameRate(&nFrame, &nTime, &nTotalFrame)) && (nTime > 0))
+                fps = nFrame * 1000.0 / nTime;
+            if (fps <= 0)
+                fps = 10.0;
+
+            // 录像按整个视野写入，停止录像后放大时再恢复硬件 ROI
+            setHardwareRoi(QRect());
+
+            recordThread::TimingMode mode = (selectedFilter == vfrFilter) ? recordThread::VariableFrameRate : recordThread::ConstantFrameRate;
+            m_recorder = new recordThread(2, this);
+            bool opened = (selectedFilter == rawFilter) ? m_recorder->openRaw(videoFileName)
+                                                        : m_recorder->open(videoFileName, fps, m_imgWidth, m_imgHeight, mode);
+            if (opened)
             {
+                m_recorder->start();
+                m_lastWritten = 0;
                 ui->videoButton->setText("停止录像");
                 m_isRecording = true;
             }
+            else
+            {
+                delete m_recorder;
+                m_recorder = nullptr;
+                QMessageBox::warning(this, "Warning", u8"无法创建视频文件。");
+            }
         }
     }
     else
     {
         // 停止录制
-        if (m_isRecording)
-        {
-            m_isRecording = false;
-            m_videoWriter.release();
-            ui->videoButton->setText("录像");
-        }
+        stopRecording();
+    }
+}
+
+void MainWindow::stopRecording()
+{
+    if (m_isRecording)
+    {
+        m_isRecording = false;
+
+        // 编码线程写完队列中剩余的帧后退出，释放其持有的帧缓冲槽位
+        m_recorder->stop();
+        m_recorder->wait();
+        delete m_recorder;
+        m_recorder = nullptr;
+        ui->videoButton->setText("录像");
+        updateHardwareRoi();
     }
 }
 
@@ -434,17 +642,24 @@ void MainWindow::on_previewComboBox_currentIndexChanged(int index)
         return;
     }
 
-    if (m_hcam)
-        Nncam_Stop(m_hcam);
+    if (m_camera)
+        m_camera->Stop();
 
     m_res = index;
     m_imgWidth = m_cur.model->res[index].width;
     m_imgHeight = m_cur.model->res[index].height;
 
-    if (m_hcam)
+    if (m_camera)
     {
-        Nncam_put_eSize(m_hcam, static_cast<unsigned>(m_res));
-        Nncam_get_PixelSize(m_hcam, static_cast<unsigned>(m_res), &m_xpixsz, &m_ypixsz);
+        m_camera->put_eSize(static_cast<unsigned>(m_res));
+        m_camera->get_PixelSize(static_cast<unsigned>(m_res), &m_xpixsz, &m_ypixsz);
+
+        // 不支持静态抓拍时抓拍分辨率跟随预览分辨率
+        if (0 == m_cur.model->still)
+        {
+            const QSignalBlocker blocker(ui->captureComboBox);
+            ui->captureComboBox->setItemText(0, QString::asprintf("%u*%u", m_imgWidth, m_imgHeight));
+        }
 
         startCamera();
     }
@@ -460,9 +675,9 @@ void MainWindow::on_autoExposureCheckBox_stateChanged(int state)
     {
         if (m_aeItem == nullptr)
         {
-            if (m_hcam)
+            if (m_camera)
             {
-                if (SUCCEEDED(Nncam_get_AEAuxRect(m_hcam, &m_aeRect)))
+                if (SUCCEEDED(m_camera->get_AEAuxRect(&m_aeRect)))
                 {
                     QString orectString = QString("oRect(left: %1, top: %2, right: %3, bottom: %4)")
                             .arg(m_aeRect.left)
@@ -491,9 +706,9 @@ void MainWindow::on_autoExposureCheckBox_stateChanged(int state)
         }
         else
         {
-            if (m_hcam)
+            if (m_camera)
             {
-                if (SUCCEEDED(Nncam_put_AutoExpoEnable(m_hcam, 1)))
+                if (SUCCEEDED(m_camera->put_AutoExpoEnable(1)))
                 {}
                 else
                 {
@@ -503,9 +718,9 @@ void MainWindow::on_autoExposureCheckBox_stateChanged(int state)
         }
 
         unsigned short target = 0;
-        if (m_hcam)
+        if (m_camera)
         {
-            if (SUCCEEDED(Nncam_get_AutoExpoTarget(m_hcam, &target)))
+            if (SUCCEEDED(m_camera->get_AutoExpoTarget(&target)))
             {
                 {
                     const QSignalBlocker blocker(ui->exposureTargetSlider);
@@ -519,10 +734,10 @@ void MainWindow::on_autoExposureCheckBox_stateChanged(int state)
     }
     else
     {
-        if (m_hcam)
+        if (m_camera)
         {
             unsigned time = 0;
-            if (SUCCEEDED(Nncam_get_ExpoTime(m_hcam, &time)))
+            if (SUCCEEDED(m_camera->get_ExpoTime(&time)))
             {
                 {
                     const QSignalBlocker blocker(ui->exposureTimeSlider);
@@ -532,10 +747,10 @@ void MainWindow::on_autoExposureCheckBox_stateChanged(int state)
             }
         }
 
-        if (m_hcam)
+        if (m_camera)
         {
             unsigned short gain = 0;
-            if (SUCCEEDED(Nncam_get_ExpoAGain(m_hcam, &gain)))
+            if (SUCCEEDED(m_camera->get_ExpoAGain(&gain)))
             {
                 {
                     const QSignalBlocker blocker(ui->gainSlider);
@@ -551,11 +766,11 @@ void MainWindow::on_autoExposureCheckBox_stateChanged(int state)
 
 void MainWindow::on_exposureTargetSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (ui->autoExposureCheckBox->isChecked())
         {
-            if (SUCCEEDED(Nncam_put_AutoExpoTarget(m_hcam, static_cast<unsigned short>(value))))
+            if (SUCCEEDED(m_camera->put_AutoExpoTarget(static_cast<unsigned short>(value))))
             {
                 m_target = value;
                 ui->exposureTargetNumLabel->setText(QString::number(value));
@@ -574,11 +789,11 @@ void MainWindow::on_exposureTargetSlider_valueChanged(int value)
 
 void MainWindow::on_exposureTimeSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (!ui->autoExposureCheckBox->isChecked())
         {
-            if (SUCCEEDED(Nncam_put_ExpoTime(m_hcam, static_cast<unsigned>(value*100))))
+            if (SUCCEEDED(m_camera->put_ExpoTime(static_cast<unsigned>(value*100))))
             {
                 m_time = value;
                 ui->exposureTargetNumLabel->setText(QString::number(value));
@@ -597,11 +812,11 @@ void MainWindow::on_exposureTimeSlider_valueChanged(int value)
 
 void MainWindow::on_gainSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (!ui->autoExposureCheckBox->isChecked())
         {
-            if (SUCCEEDED(Nncam_put_ExpoAGain(m_hcam, static_cast<unsigned short>(value))))
+            if (SUCCEEDED(m_camera->put_ExpoAGain(static_cast<unsigned short>(value))))
             {
                 m_gain = value;
                 ui->gainNumLabel->setText(QString::number(value));
@@ -627,9 +842,9 @@ void MainWindow::on_autoAwbCheckBox_stateChanged(int state)
     {
         if (m_awbItem == nullptr)
         {
-            if (m_hcam)
+            if (m_camera)
             {
-                if (SUCCEEDED(Nncam_get_AWBAuxRect(m_hcam, &m_awbRect)))
+                if (SUCCEEDED(m_camera->get_AWBAuxRect(&m_awbRect)))
                 {
                     QString orectString = QString("oRect(left: %1, top: %2, right: %3, bottom: %4)")
                             .arg(m_awbRect.left)
@@ -656,9 +871,9 @@ void MainWindow::on_autoAwbCheckBox_stateChanged(int state)
         }
         else
         {
-            if (m_hcam)
+            if (m_camera)
             {
-                if (SUCCEEDED(Nncam_AwbOnce(m_hcam, nullptr, nullptr)))
+                if (SUCCEEDED(m_camera->AwbOnce(nullptr, nullptr)))
                 {
                 }
                 else
@@ -671,10 +886,10 @@ void MainWindow::on_autoAwbCheckBox_stateChanged(int state)
     }
     else
     {
-        if (m_hcam)
+        if (m_camera)
         {
             int nTemp = 0, nTint = 0;
-            if (SUCCEEDED(Nncam_get_TempTint(m_hcam, &nTemp, &nTint)))
+            if (SUCCEEDED(m_camera->get_TempTint(&nTemp, &nTint)))
             {
                 {
                     const QSignalBlocker blocker(ui->temperatureSlider);
@@ -695,11 +910,11 @@ void MainWindow::on_autoAwbCheckBox_stateChanged(int state)
 
 void MainWindow::on_temperatureSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (!ui->autoAwbCheckBox->isChecked())
         {
-            if (SUCCEEDED(Nncam_put_TempTint(m_hcam, value, m_tint)))
+            if (SUCCEEDED(m_camera->put_TempTint(value, m_tint)))
             {
                 m_temp = value;
                 ui->temperatureNumLabel->setText(QString::number(value));
@@ -718,11 +933,11 @@ void MainWindow::on_temperatureSlider_valueChanged(int value)
 
 void MainWindow::on_tintSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (!ui->autoAwbCheckBox->isChecked())
         {
-            if (SUCCEEDED(Nncam_put_TempTint(m_hcam, m_temp, value)))
+            if (SUCCEEDED(m_camera->put_TempTint(m_temp, value)))
             {
                 m_tint = value;
                 ui->tintNumLabel->setText(QString::number(value));
@@ -755,9 +970,9 @@ void MainWindow::on_autoAbbCheckBox_stateChanged(int state)
     {
         if (m_abbItem == nullptr)
         {
-            if (m_hcam)
+            if (m_camera)
             {
-                if (SUCCEEDED(Nncam_get_ABBAuxRect(m_hcam, &m_abbRect)))
+                if (SUCCEEDED(m_camera->get_ABBAuxRect(&m_abbRect)))
                 {
                     QString orectString = QString("oRect(left: %1, top: %2, right: %3, bottom: %4)")
                             .arg(m_abbRect.left)
@@ -784,9 +999,9 @@ void MainWindow::on_autoAbbCheckBox_stateChanged(int state)
         }
         else
         {
-            if (m_hcam)
+            if (m_camera)
             {
-                if (SUCCEEDED(Nncam_AbbOnce(m_hcam, nullptr, nullptr)))
+                if (SUCCEEDED(m_camera->AbbOnce(nullptr, nullptr)))
                 {
                 }
                 else
@@ -799,9 +1014,9 @@ void MainWindow::on_autoAbbCheckBox_stateChanged(int state)
     }
     else
     {
-        if (m_hcam)
+        if (m_camera)
         {
-            if (SUCCEEDED(Nncam_get_BlackBalance(m_hcam, m_aSub)))
+            if (SUCCEEDED(m_camera->get_BlackBalance(m_aSub)))
             {
                 m_red = m_aSub[0];
                 m_green = m_aSub[1];
@@ -829,12 +1044,12 @@ void MainWindow::on_autoAbbCheckBox_stateChanged(int state)
 
 void MainWindow::on_redSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (!ui->autoAbbCheckBox->isChecked())
         {
             m_aSub[0] = value;
-            if (SUCCEEDED(Nncam_put_BlackBalance(m_hcam, m_aSub)))
+            if (SUCCEEDED(m_camera->put_BlackBalance(m_aSub)))
             {
                 m_red = value;
                 ui->redNumLabel->setText(QString::number(value));
@@ -853,12 +1068,12 @@ void MainWindow::on_redSlider_valueChanged(int value)
 
 void MainWindow::on_greenSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (!ui->autoAbbCheckBox->isChecked())
         {
             m_aSub[1] = value;
-            if (SUCCEEDED(Nncam_put_BlackBalance(m_hcam, m_aSub)))
+            if (SUCCEEDED(m_camera->put_BlackBalance(m_aSub)))
             {
                 m_green = value;
                 ui->greenNumLabel->setText(QString::number(value));
@@ -877,12 +1092,12 @@ void MainWindow::on_greenSlider_valueChanged(int value)
 
 void MainWindow::on_blueSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
         if (!ui->autoAbbCheckBox->isChecked())
         {
             m_aSub[2] = value;
-            if (SUCCEEDED(Nncam_put_BlackBalance(m_hcam, m_aSub)))
+            if (SUCCEEDED(m_camera->put_BlackBalance(m_aSub)))
             {
                 m_blue = value;
                 ui->blueNumLabel->setText(QString::number(value));
@@ -908,9 +1123,9 @@ void MainWindow::on_defaultAbbButton_clicked()
 
 void MainWindow::on_hueSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_Hue(m_hcam, value)))
+        if (SUCCEEDED(m_camera->put_Hue(value)))
         {
             m_hue = value;
             ui->hueNumLabel->setText(QString::number(value));
@@ -928,9 +1143,9 @@ void MainWindow::on_hueSlider_valueChanged(int value)
 
 void MainWindow::on_saturationSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_Saturation(m_hcam, value)))
+        if (SUCCEEDED(m_camera->put_Saturation(value)))
         {
             m_saturation = value;
             ui->saturationNumLabel->setText(QString::number(value));
@@ -948,9 +1163,9 @@ void MainWindow::on_saturationSlider_valueChanged(int value)
 
 void MainWindow::on_brightnessSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_Brightness(m_hcam, value)))
+        if (SUCCEEDED(m_camera->put_Brightness(value)))
         {
             m_brightness = value;
             ui->brightnessNumLabel->setText(QString::number(value));
@@ -968,9 +1183,9 @@ void MainWindow::on_brightnessSlider_valueChanged(int value)
 
 void MainWindow::on_contrastSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_Contrast(m_hcam, value)))
+        if (SUCCEEDED(m_camera->put_Contrast(value)))
         {
             m_contrast = value;
             ui->contrastNumLabel->setText(QString::number(value));
@@ -988,9 +1203,9 @@ void MainWindow::on_contrastSlider_valueChanged(int value)
 
 void MainWindow::on_gammaSlider_valueChanged(int value)
 {
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_Gamma(m_hcam, value)))
+        if (SUCCEEDED(m_camera->put_Gamma(value)))
         {
             m_gamma = value;
             ui->gammaNumLabel->setText(QString::number(value));
@@ -1034,11 +1249,11 @@ void MainWindow::onAERectChanged(float leftRatio, float topRatio, float rightRat
                              .arg(m_aeRect.bottom);
 
     qDebug() << rectString; // 输出格式化后的字符串
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_AEAuxRect(m_hcam, &m_aeRect)))
+        if (SUCCEEDED(m_camera->put_AEAuxRect(&m_aeRect)))
         {
-            if (SUCCEEDED(Nncam_put_AutoExpoEnable(m_hcam, 1)))
+            if (SUCCEEDED(m_camera->put_AutoExpoEnable(1)))
             {
                 qDebug() << "auto ae设置成功\n";
             }
@@ -1070,11 +1285,11 @@ void MainWindow::onAWBRectChanged(float leftRatio, float topRatio, float rightRa
                              .arg(m_awbRect.bottom);
 
     qDebug() << rectString; // 输出格式化后的字符串
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_AWBAuxRect(m_hcam, &m_awbRect)))
+        if (SUCCEEDED(m_camera->put_AWBAuxRect(&m_awbRect)))
         {
-            if (SUCCEEDED(Nncam_AwbOnce(m_hcam, nullptr, nullptr)))
+            if (SUCCEEDED(m_camera->AwbOnce(nullptr, nullptr)))
             {}
             else
             {
@@ -1103,11 +1318,11 @@ void MainWindow::onABBRectChanged(float leftRatio, float topRatio, float rightRa
                              .arg(m_abbRect.bottom);
 
     qDebug() << rectString; // 输出格式化后的字符串
-    if (m_hcam)
+    if (m_camera)
     {
-        if (SUCCEEDED(Nncam_put_ABBAuxRect(m_hcam, &m_abbRect)))
+        if (SUCCEEDED(m_camera->put_ABBAuxRect(&m_abbRect)))
         {
-            if (SUCCEEDED(Nncam_AbbOnce(m_hcam, nullptr, nullptr)))
+            if (SUCCEEDED(m_camera->AbbOnce(nullptr, nullptr)))
             {}
             else
             {
@@ -1194,25 +1409,42 @@ void MainWindow::removeLineWidgets(QGraphicsLineItem* lineItem) {
 
 void MainWindow::openCamera()
 {
+    // 采集方式只能在打开相机时选择
+    m_acquisitionMode = ui->pushModeCheckBox->isChecked() ? cameraThread::PushMode : cameraThread::PullMode;
+
     // 打开摄像头
-    m_hcam = Nncam_Open(m_cur.id);
-    if (m_hcam)
+    m_camera = CameraDevice::Open(m_cur);
+    if (m_camera)
     {
         // 设置帧速率级别
         // unsigned short maxSpeed = Nncam_get_MaxSpeed(m_hcam);
         // Nncam_put_Speed(m_hcam, maxSpeed);
 
         // 设置为RGB字节序（0：RGB，1：BGR），因为QImage使用RGB字节序
-        Nncam_put_Option(m_hcam, NNCAM_OPTION_BYTEORDER, 0);
+        m_camera->put_Option(NNCAM_OPTION_BYTEORDER, 0);
 
         // 设置为视频画面不倒置
-        Nncam_put_Option(m_hcam, NNCAM_OPTION_UPSIDE_DOWN, 0);
+        m_camera->put_Option(NNCAM_OPTION_UPSIDE_DOWN, 0);
 
         // 设置是否启用自动曝光
-        Nncam_put_AutoExpoEnable(m_hcam, ui->autoExposureCheckBox->isChecked()? 1 : 0);
+        m_camera->put_AutoExpoEnable(ui->autoExposureCheckBox->isChecked()? 1 : 0);
 
         // 获取摄像头的分辨率信息
-        Nncam_get_eSize(m_hcam, (unsigned*)&m_res);
+        m_camera->get_eSize((unsigned*)&m_res);
+
+        // 支持静态抓拍时采用双码流: 预览使用不小于预览窗口宽度的最低分辨率(binning)以提高帧率，
+        // 抓拍通过 Nncam_Snap 以 captureComboBox 选择的分辨率进行
+        if (m_cur.model->still > 0)
+        {
+            unsigned viewWidth = unsigned(qMax(0, ui->imageViewLayout->geometry().width() - 30));
+            for (unsigned i = 0; i < m_cur.model->preview; ++i)
+            {
+                if (m_cur.model->res[i].width >= viewWidth)
+                    m_res = int(i);
+            }
+            m_camera->put_eSize(static_cast<unsigned>(m_res));
+        }
+        m_camera->get_PixelSize(static_cast<unsigned>(m_res), &m_xpixsz, &m_ypixsz);
 
         // 获取当前分辨率下的图像宽度和高度
         m_imgWidth = m_cur.model->res[m_res].width;
@@ -1233,23 +1465,35 @@ void MainWindow::openCamera()
         {
             const QSignalBlocker blocker(ui->captureComboBox);
             ui->captureComboBox->clear();
-            for (unsigned i = 0; i < m_cur.model->preview; ++i)
+            if (m_cur.model->still > 0)
+            {
+                // 静态抓拍分辨率，默认最高分辨率；读取失败的分辨率跳过，条目数据保存 Snap 使用的序号
+                for (unsigned i = 0; i < m_cur.model->still; ++i)
+                {
+                    int width = 0, height = 0;
+                    if (SUCCEEDED(m_camera->get_StillResolution(i, &width, &height)))
+                        ui->captureComboBox->addItem(QString::asprintf("%d*%d", width, height), i);
+                }
+                ui->captureComboBox->setCurrentIndex(0);
+            }
+            else
             {
-                ui->captureComboBox->addItem(QString::asprintf("%u*%u", m_cur.model->res[i].width, m_cur.model->res[i].height));
+                // 不支持静态抓拍，只能保存当前预览分辨率的帧
+                ui->captureComboBox->addItem(QString::asprintf("%u*%u", m_cur.model->res[m_res].width, m_cur.model->res[m_res].height));
+                ui->captureComboBox->setCurrentIndex(0);
             }
-            ui->captureComboBox->setCurrentIndex(m_res);
             ui->captureComboBox->setEnabled(true);
         }
 
         // 初始化曝光时间范围及默认值
         unsigned uimax = 0, uimin = 0, uidef = 0;
-        if (SUCCEEDED(Nncam_get_ExpTimeRange(m_hcam, &uimin, &uimax, &uidef)))
+        if (SUCCEEDED(m_camera->get_ExpTimeRange(&uimin, &uimax, &uidef)))
         {
             qDebug() << "time:" << uimax << uimin << uidef;  // 3600000000 100 2000  // 5s 0.1ms
             ui->exposureTimeSlider->setRange(int(uimin/100), int(uimax/100));
         }
         unsigned time = 0;
-        if (SUCCEEDED(Nncam_get_ExpoTime(m_hcam, &time)))
+        if (SUCCEEDED(m_camera->get_ExpoTime(&time)))
         {
             {
                 const QSignalBlocker blocker(ui->exposureTimeSlider);
@@ -1260,12 +1504,12 @@ void MainWindow::openCamera()
 
         // 初始化曝光增益范围及默认值
         unsigned short usmax = 0, usmin = 0, usdef = 0;
-        if (SUCCEEDED(Nncam_get_ExpoAGainRange(m_hcam, &usmin, &usmax, &usdef)))
+        if (SUCCEEDED(m_camera->get_ExpoAGainRange(&usmin, &usmax, &usdef)))
         {
             ui->gainSlider->setRange(usmin, usmax);
         }
         unsigned short gain = 0;
-        if (SUCCEEDED(Nncam_get_ExpoAGain(m_hcam, &gain)))
+        if (SUCCEEDED(m_camera->get_ExpoAGain(&gain)))
         {
             {
                 const QSignalBlocker blocker(ui->gainSlider);
@@ -1278,7 +1522,7 @@ void MainWindow::openCamera()
         if (0 == (m_cur.model->flag & NNCAM_FLAG_MONO))
         {
             int nTemp = 0, nTint = 0;
-            if (SUCCEEDED(Nncam_get_TempTint(m_hcam, &nTemp, &nTint)))
+            if (SUCCEEDED(m_camera->get_TempTint(&nTemp, &nTint)))
             {
                 {
                     const QSignalBlocker blocker(ui->temperatureSlider);
@@ -1308,7 +1552,7 @@ void MainWindow::openCamera()
 int MainWindow::closeCamera()
 {
     // 检查是否有未保存的预览图像
-    bool hasUnsavedImages = imageVector.size() > 0;
+    bool hasUnsavedImages = !m_captures.isEmpty();
 
     if (hasUnsavedImages)
     {
@@ -1320,11 +1564,9 @@ int MainWindow::closeCamera()
 
         if (reply == QMessageBox::Yes)
         {
-            // 用户选择保存图像
-            for (int i = 0; i < imageVector.size(); ++i)
-            {
-                closeTab(i+1);
-            }
+            // 用户选择保存图像，放弃选择目录时不关闭相机
+            if (!saveAllCaptures(true))
+                return 0;
         }
         else if (reply == QMessageBox::Cancel)
         {
@@ -1340,24 +1582,24 @@ int MainWindow::closeCamera()
         m_timer->stop();
     }
     ui->lblLabel->clear();
+    m_measuredFps = 0.0;
 
-    // 移除所有标签页
-    while (ui->tabWidget->count() > 1)
-    {
-        QWidget *widget = ui->tabWidget->widget(1);
-        ui->tabWidget->removeTab(1);
-        delete widget;
-    }
-
-    // 清空图像向量
-    imageVector.clear();
+    // 仍在后台导出的图像需要读取临时文件，导出结束(ImageExporter::finished)后再清空抓拍，界面不等待
+    m_clearCapturesPending = m_exporter->pending() > 0;
+    if (!m_clearCapturesPending)
+        clearCaptures();
 
     // 停止录像
-    if (m_isRecording)
+    stopRecording();
+    m_autofocus->stop();
+    m_zStack->stop();
+    m_mosaicScan->stop();
+
+    // 关闭相机，之后不会再有回调写入帧缓冲
+    if (m_camera)
     {
-        m_isRecording = false;
-        m_videoWriter.release();
-        ui->videoButton->setText("录像");
+        delete m_camera;
+        m_camera = nullptr;
     }
 
     // 删除预览线程
@@ -1367,24 +1609,23 @@ int MainWindow::closeCamera()
         m_cameraThread = nullptr;
     }
 
-    // 关闭相机
-    if (m_hcam)
-    {
-        Nncam_Close(m_hcam);
-        m_hcam = nullptr;
-    }
-
-    delete[] m_pData;
-    m_pData = nullptr;
+    delete m_frameRing;
+    m_frameRing = nullptr;
+    m_captureRequested = false;
+    m_roiTimer->stop();
+    m_hardwareRoi = QRect();
     delete m_imageView;
     m_imageView = nullptr;
     delete m_scene;
     m_scene = nullptr;
-    delete m_pixmapItem;
-    m_pixmapItem = nullptr;
+    m_stageItem = nullptr;  // 随场景一起删除
 
     ui->cameraButton->setText("打开相机");
-    ui->searchCameraButton->setEnabled(true);
+    ui->searchCameraButton->setEnabled(!m_clearCapturesPending);
+    ui->pushModeCheckBox->setEnabled(true);
+    // 抓拍清空之前不能重新打开相机
+    if (m_clearCapturesPending)
+        ui->cameraButton->setEnabled(false);
 
     ui->captureButton->setEnabled(false);
     ui->videoButton->setEnabled(false);
@@ -1425,55 +1666,236 @@ int MainWindow::closeCamera()
 
 void MainWindow::startCamera()
 {
-    // 检查mPData指针是否有效，如果是，则释放内存
-    if (m_pData)
+    // 相机已停止，释放上一次的预览线程和帧缓冲
+    if (m_cameraThread)
     {
-        delete[] m_pData;
-        m_pData = nullptr;
+        delete m_cameraThread;
+        m_cameraThread = nullptr;
     }
-    // 重新分配内存用于存储图像数据，TDIBWIDTHBYTES是一个宏，用于计算图像宽度所需的字节数
-    m_pData = new uchar[TDIBWIDTHBYTES(m_imgWidth * 24) * m_imgHeight];
+    if (m_frameRing)
+    {
+        delete m_frameRing;
+        m_frameRing = nullptr;
+    }
+    // 重新分配帧缓冲环，TDIBWIDTHBYTES是一个宏，用于计算图像宽度所需的字节数
+    // 槽位数: 采集写入1 + 预览1 + 录像编码1 + 录像队列2 + 就绪1
+    m_frameRing = new FrameRing(6, TDIBWIDTHBYTES(m_imgWidth * 24) * m_imgHeight, FrameRing::DropOldest);
 
-    m_cameraThread = new cameraThread(m_hcam, m_pData, this);
+    m_cameraThread = new cameraThread(m_camera, m_frameRing, m_acquisitionMode, this);
+    m_cameraThread->setStageModel(&m_stage);
+    // 打开相机或切换分辨率后相机的 ROI 为整个视野，放大时由 updateHardwareRoi 重新设置
+    m_hardwareRoi = QRect();
+    updatePreviewRegion();
+    m_lastSeq = 0;
+    m_lostFrames = 0;
     connect(m_cameraThread, &cameraThread::imageCaptured, this, &MainWindow::handleImageCaptured);
+    connect(m_cameraThread, &cameraThread::previewReady, this, &MainWindow::handlePreviewImage);
     connect(m_cameraThread, &cameraThread::stillImageCaptured, this, &MainWindow::handleStillImageCaptured);
     connect(m_cameraThread, &cameraThread::cameraStartMessage, this, &MainWindow::handleCameraStartMessage);
     connect(m_cameraThread, &cameraThread::eventCallBackMessage, this, &MainWindow::handleEventCallBackMessage);
     m_cameraThread->start();
 }
 
-void MainWindow::handleImageCaptured(const QImage &image)
+void MainWindow::handleImageCaptured()
 {
-    QImage newImage = image.scaled(m_previewWidth, m_previewHeight, Qt::KeepAspectRatio, Qt::FastTransformation);
-    m_pixmapItem->setPixmap(QPixmap::fromImage(newImage));
+    if (!m_frameRing)
+        return;
 
-    if (m_isRecording)
+    // 取出最早的就绪帧，Frame 存活期间该槽位不会被采集线程覆盖
+    Frame frame = Frame::take(m_frameRing);
+    if (frame.isNull())
+        return;
+
+    qint64 delivered = frameClockNs();
+    m_latencyNs += delivered - frame.arrival();
+    ++m_latencyFrames;
+    Profiler::instance().record(Profiler::Deliver, frame.arrival(), delivered);
+
+    // 根据相机帧序号统计整条链路上丢失的帧
+    if (frame.seq())
+    {
+        if (m_lastSeq && frame.seq() > m_lastSeq + 1)
+            m_lostFrames += frame.seq() - m_lastSeq - 1;
+        m_lastSeq = frame.seq();
+    }
+
+    if (m_autofocus->isRunning())
+        m_autofocus->addFrame(frame);
+
+    // 只传递帧句柄，颜色转换与编码在录像线程完成；关闭硬件 ROI 之前到达的裁剪帧不录入
+    if (m_isRecording && frame.width() == m_imgWidth && frame.height() == m_imgHeight)
+        m_recorder->enqueue(frame);
+
+    // 关闭硬件 ROI 之前到达的裁剪帧不保存
+    if (m_captureRequested && frame.width() == m_imgWidth && frame.height() == m_imgHeight)
+    {
+        m_captureRequested = false;
+
+        // 写入磁盘后槽位即可归还，不再需要深拷贝
+        addCaptureTab(frame);
+        updateHardwareRoi();
+    }
+}
+
+void MainWindow::handlePreviewImage(const QImage &image, const QRectF &region)
+{
+    // 预览图已由采集线程裁剪到可见区域并缩小到屏幕尺寸，视图直接绘制，场景不因新帧失效
+    if (m_imageView)
+        m_imageView->setFrame(image, region);
+    if (m_cameraThread)
+        m_cameraThread->previewShown();
+}
+
+void MainWindow::updatePreviewRegion()
+{
+    if (!m_imageView || 0 == m_previewWidth || 0 == m_previewHeight)
+        return;
+
+    // 最大放大到传感器像素的 MaxPreviewZoom 倍，窗口大小或分辨率改变后随之更新
+    m_imageView->setMaxZoom(double(m_imgWidth) / m_previewWidth * MaxPreviewZoom);
+    QRectF visible = m_imageView->visibleSceneRect();
+    if (m_stageItem)
+        m_stageItem->setPos(visible.topLeft());
+    if (visible.isEmpty())
+        return;
+
+    // 采集线程只处理可见区域，输出尺寸为它在屏幕上的像素数
+    if (m_cameraThread)
     {
-        cv::Mat mat = cv::Mat(image.height(), image.width(), CV_8UC3, const_cast<uchar*>(image.bits()), image.bytesPerLine()).clone();
-        cv::cvtColor(mat, mat, cv::COLOR_RGB2BGR);
-        m_videoWriter.write(mat);
+        m_cameraThread->setPreviewSize(unsigned(std::ceil(visible.width() * m_imageView->zoom())),
+                                       unsigned(std::ceil(visible.height() * m_imageView->zoom())));
+        m_cameraThread->setPreviewRegion(QRectF(visible.x() / m_previewWidth, visible.y() / m_previewHeight,
+                                                visible.width() / m_previewWidth, visible.height() / m_previewHeight));
     }
+    m_roiTimer->start();
 }
 
-void MainWindow::handleStillImageCaptured(const QImage &image)
+void MainWindow::updateHardwareRoi()
 {
-        // 创建一个新的标签页
-        QWidget *newTab = new QWidget();
-        QLabel *imageLabel = new QLabel(newTab);
+    if (!m_camera || !m_cameraThread || !m_imageView)
+        return;
 
-        // 设置标签页的布局，确保QLabel自适应标签页大小
-        QVBoxLayout *layout = new QVBoxLayout(newTab);
-        layout->addWidget(imageLabel);
-        layout->setContentsMargins(0, 0, 0, 0);
-        newTab->setLayout(layout);
-        ui->tabWidget->addTab(newTab, QString("image_") + QString::number(++m_count));
+    // 录像与抓拍的帧尺寸固定为整个视野；放大不到 MinRoiZoom 倍时读出时间省得不多，不值得重新配置传感器
+    QRect roi;
+    QRectF visible = m_imageView->visibleSceneRect();
+    if (ui->hardwareRoiCheckBox->isChecked() && !m_isRecording && !m_captureRequested && m_imageView->zoom() >= MinRoiZoom && !visible.isEmpty())
+    {
+        double sx = double(m_imgWidth) / m_previewWidth;
+        double sy = double(m_imgHeight) / m_previewHeight;
+        QRectF sensor(visible.x() * sx, visible.y() * sy, visible.width() * sx, visible.height() * sy);
+        QRect needed(QPoint(int(std::floor(sensor.left())), int(std::floor(sensor.top()))),
+                     QPoint(int(std::ceil(sensor.right())) - 1, int(std::ceil(sensor.bottom())) - 1));
 
-        QPixmap pixmap = QPixmap::fromImage(image);
-        imageLabel->setScaledContents(true);
-        imageLabel->setPixmap(pixmap);
+        // 当前 ROI 仍包含可见区域且不超过新 ROI 的两倍时保持不变，小范围平移不必重新设置
+        if (!m_hardwareRoi.isEmpty() && m_hardwareRoi.contains(needed)
+            && qint64(m_hardwareRoi.width()) * m_hardwareRoi.height() <= 8 * qint64(needed.width()) * needed.height())
+            return;
 
-        // 将新创建的QImage存储到映射中
-        imageVector.append(image);
+        // 四周各留出可见区域一半的余量，SDK 要求偏移与尺寸均为偶数
+        sensor.adjust(-sensor.width() / 2, -sensor.height() / 2, sensor.width() / 2, sensor.height() / 2);
+        int left = qMax(0, int(std::floor(sensor.left()))) & ~1;
+        int top = qMax(0, int(std::floor(sensor.top()))) & ~1;
+        int right = qMin(int(m_imgWidth), int(std::ceil(sensor.right())) + 1) & ~1;
+        int bottom = qMin(int(m_imgHeight), int(std::ceil(sensor.bottom())) + 1) & ~1;
+        roi = QRect(left, top, right - left, bottom - top);
+    }
+    setHardwareRoi(roi);
+}
+
+void MainWindow::setHardwareRoi(const QRect &roi)
+{
+    if (roi == m_hardwareRoi || !m_camera || !m_cameraThread)
+        return;
+
+    // 先通知采集线程，切换前后到达的帧按尺寸区分，put_Roi 返回后确认
+    QSize sensor(int(m_imgWidth), int(m_imgHeight));
+    m_cameraThread->beginHardwareRoi(roi, sensor);
+    HRESULT hr = roi.isEmpty() ? m_camera->put_Roi(0, 0, 0, 0)
+                               : m_camera->put_Roi(unsigned(roi.x()), unsigned(roi.y()), unsigned(roi.width()), unsigned(roi.height()));
+    if (FAILED(hr))
+    {
+        m_cameraThread->setHardwareRoi(m_hardwareRoi, sensor);
+        if (!roi.isEmpty())
+        {
+            ui->hardwareRoiCheckBox->setChecked(false);
+            QMessageBox::warning(this, "Warning", u8"相机不支持硬件 ROI。");
+        }
+        return;
+    }
+    m_cameraThread->setHardwareRoi(roi, sensor);
+    m_hardwareRoi = roi;
+}
+
+void MainWindow::on_hardwareRoiCheckBox_toggled(bool checked)
+{
+    Q_UNUSED(checked);
+    updateHardwareRoi();
+}
+
+void MainWindow::handleStillImageCaptured(const Frame &frame)
+{
+    if (m_zStack->isRunning())
+    {
+        m_zStack->addFrame(frame);
+        return;
+    }
+    if (m_mosaicScan->isRunning())
+    {
+        m_mosaicScan->addFrame(frame);
+        return;
+    }
+    addCaptureTab(frame);
+}
+
+void MainWindow::addCaptureTab(const Frame &frame)
+{
+    // 完整图像写入磁盘临时目录，内存中只保留缩略图
+    int index = m_captures.add(frame);
+    if (index < 0)
+    {
+        QMessageBox::warning(this, "Warning", u8"抓拍图像写入临时目录失败。");
+        return;
+    }
+
+    // 查看器按需从临时文件生成可见的块，加载完成前显示缩略图
+    TileViewer *viewer = new TileViewer(QSharedPointer<TileSource>(new RawTileSource(m_captures.filePath(index), m_captures.record(index))));
+    viewer->setPreview(m_captures.thumbnail(index));
+    viewer->setCacheBytes(qint64(ui->cacheSpinBox->value()) * 1024 * 1024);
+    m_captureTabs.append(viewer);
+    ui->tabWidget->addTab(viewer, QString("image_") + QString::number(++m_count));
+}
+
+void MainWindow::addMosaicTab(const QString &directory)
+{
+    QSharedPointer<MosaicTileSource> source(new MosaicTileSource(directory));
+    if (!source->isValid())
+    {
+        QMessageBox::warning(this, "Warning", u8"无法读取拼接结果：" + directory);
+        return;
+    }
+    // 拼接结果已在磁盘上，不属于抓拍仓库，关闭标签页时不需要保存
+    TileViewer *viewer = new TileViewer(source);
+    viewer->setCacheBytes(qint64(ui->cacheSpinBox->value()) * 1024 * 1024);
+    ui->tabWidget->addTab(viewer, "mosaic_" + QDir(directory).dirName());
+}
+
+void MainWindow::on_actionDiagnostics_triggered()
+{
+    if (!m_diagnostics)
+        m_diagnostics = new DiagnosticsDialog(this);
+    m_diagnostics->show();
+    m_diagnostics->raise();
+    m_diagnostics->activateWindow();
+}
+
+void MainWindow::on_cacheSpinBox_valueChanged(int value)
+{
+    for (int i = 1; i < ui->tabWidget->count(); ++i)
+    {
+        TileViewer *viewer = qobject_cast<TileViewer*>(ui->tabWidget->widget(i));
+        if (viewer)
+            viewer->setCacheBytes(qint64(value) * 1024 * 1024);
+    }
 }
 
 void MainWindow::handleCameraStartMessage(bool message)
@@ -1483,6 +1905,7 @@ void MainWindow::handleCameraStartMessage(bool message)
         // 修改相机开关按钮
         ui->cameraButton->setText("关闭相机");
         ui->searchCameraButton->setEnabled(false);
+        ui->pushModeCheckBox->setEnabled(false);
 
         // 使能捕获与分辨率功能
         ui->captureButton->setEnabled(true);
@@ -1493,7 +1916,7 @@ void MainWindow::handleCameraStartMessage(bool message)
         // 使能曝光功能
         ui->autoExposureCheckBox->setEnabled(true);
         int bAuto = 0;
-        Nncam_get_AutoExpoEnable(m_hcam, &bAuto);
+        m_camera->get_AutoExpoEnable(&bAuto);
         ui->exposureTargetSlider->setEnabled(1 == bAuto);
         ui->exposureTimeSlider->setEnabled(!(1 == bAuto));
         ui->gainSlider->setEnabled(!(1 == bAuto));
@@ -1554,75 +1977,163 @@ void MainWindow::handleEventCallBackMessage(QString message)
 
 void MainWindow::closeTab(int index)
 {
-    if (index == 0)
+    if (index <= 0 || index >= ui->tabWidget->count())
         return;
 
-    else if (index > 0 && index < ui->tabWidget->count() && index <= imageVector.size())
+    int capture = m_captureTabs.indexOf(ui->tabWidget->widget(index));
+    if (capture < 0)
+    {
+        QWidget *widget = ui->tabWidget->widget(index);
+        ui->tabWidget->removeTab(index);
+        delete widget;
+    }
+    else
     {
-        QImage image = imageVector.at(index-1);
+        // 正在保存的抓拍导出成功后会自动关闭
+        QString sourcePath = m_captures.filePath(capture);
+        if (m_removeOnExport.contains(sourcePath))
+            return;
+
+        QStringList filters;
+        filters << ImageExporter::filter(ImageExporter::Jpeg) << ImageExporter::filter(ImageExporter::Png)
+                << ImageExporter::filter(ImageExporter::Tiff) << ImageExporter::filter(ImageExporter::Tiff16)
+                << ImageExporter::filter(ImageExporter::Raw);
+
+        QString selectedFilter = filters.first();
+        QString filename = QString::asprintf("image_%d.jpg", capture);
+        QString path = QFileDialog::getSaveFileName(this, "Save Image", filename, filters.join(";;"), &selectedFilter);
 
-        QString filename = QString::asprintf("image_%u.jpg", index-1);
-        QString path = QFileDialog::getSaveFileName(this, "Save Image", filename, "JPEG Files (*.jpg)");
+        // 对话框期间其它导出可能已移除条目，按临时文件重新查找序号
+        capture = m_captures.indexOf(sourcePath);
 
         // 检查用户是否取消了对话框
-        if (!path.isEmpty())
+        if (!path.isEmpty() && capture >= 0)
         {
-            // 用户选择了保存路径，保存图像
-            image.save(path);
-
-            // 从vector中移除对应的QImage
-            imageVector.removeAt(index-1);
-            QWidget *widget = ui->tabWidget->widget(index);
-            ui->tabWidget->removeTab(index);
-            delete widget;
+            // 用户选择了保存路径，在后台编码保存，成功后才关闭标签页并删除临时文件
+            ImageExporter::Job job;
+            job.record = m_captures.record(capture);
+            job.sourcePath = sourcePath;
+            job.fileName = path;
+            job.format = ImageExporter::formatFromFilter(selectedFilter);
+            m_removeOnExport.insert(job.sourcePath);
+            m_exporter->submit(job);
         }
     }
 }
 
-void MainWindow::on_searchSerialButton_clicked()
+void MainWindow::removeCaptureTab(int capture)
+{
+    QWidget *widget = m_captureTabs.takeAt(capture);
+    ui->tabWidget->removeTab(ui->tabWidget->indexOf(widget));
+    delete widget;
+}
+
+void MainWindow::clearCaptures()
+{
+    // 移除所有标签页，查看器析构时等待其工作线程结束，之后不再读取临时文件
+    m_captureTabs.clear();
+    while (ui->tabWidget->count() > 1)
+    {
+        QWidget *widget = ui->tabWidget->widget(1);
+        ui->tabWidget->removeTab(1);
+        delete widget;
+    }
+
+    // 清空抓拍仓库并删除临时文件
+    m_captures.clear();
+    m_removeOnExport.clear();
+}
+
+bool MainWindow::saveAllCaptures(bool removeAfterSave)
+{
+    QString dir = QFileDialog::getExistingDirectory(this, u8"保存全部图像");
+    if (dir.isEmpty())
+        return false;
+
+    bool ok = false;
+    QString pattern = QInputDialog::getText(this, u8"命名模板",
+        u8"文件名模板 ({n} 序号, {seq} 帧序号, {date} 日期, {time} 时间, {expo} 曝光, {gain} 增益, {x} {y} {z} 位移台位置)：",
+        QLineEdit::Normal, "image_{n}", &ok);
+    if (!ok || pattern.isEmpty())
+        return false;
+
+    QStringList filters;
+    filters << ImageExporter::filter(ImageExporter::Jpeg) << ImageExporter::filter(ImageExporter::Png)
+            << ImageExporter::filter(ImageExporter::Tiff) << ImageExporter::filter(ImageExporter::Tiff16)
+            << ImageExporter::filter(ImageExporter::Raw);
+    QString selectedFilter = QInputDialog::getItem(this, u8"保存格式", u8"格式：", filters, 0, false, &ok);
+    if (!ok)
+        return false;
+    ImageExporter::Format format = ImageExporter::formatFromFilter(selectedFilter);
+
+    if (!m_exportProgress)
+    {
+        m_exportProgress = new QProgressDialog(u8"正在保存图像...", QString(), 0, m_captures.size(), this);
+        m_exportProgress->setWindowModality(Qt::NonModal);
+        m_exportProgress->setMinimumDuration(0);
+    }
+
+    // 条目在导出成功后才移除(见 ImageExporter::exported)，提交时序号不变
+    for (int i = 0; i < m_captures.size(); ++i)
+    {
+        ImageExporter::Job job;
+        job.record = m_captures.record(i);
+        job.sourcePath = m_captures.filePath(i);
+        job.fileName = dir + "/" + ImageExporter::expandTemplate(pattern, i + 1, job.record) + "." + ImageExporter::suffix(format);
+        job.format = format;
+        if (removeAfterSave)
+            m_removeOnExport.insert(job.sourcePath);
+        m_exporter->submit(job);
+    }
+    return true;
+}
+
+void MainWindow::on_saveAllButton_clicked()
 {
-    if (m_serial)
+    if (m_captures.isEmpty())
     {
-        if (m_serial->isOpen())  //原先串口打开，则关闭串口
-            m_serial->close();
-        delete[] m_serial;
-        m_serial = nullptr;
+        QMessageBox::warning(this, "Warning", u8"没有需要保存的图像。");
+        return;
     }
+    saveAllCaptures(false);
+}
+
+void MainWindow::on_searchSerialButton_clicked()
+{
+    //原先串口打开，则关闭串口
+    if (m_serialOpen)
+        closeSerial();
 
     //先清除所有串口列表
     ui->portBox->clear();
 
-    //光标移动到结尾
-    ui->serialMessageEdit->moveCursor(QTextCursor::End);
-    ui->serialMessageEdit->insertPlainText(u8"\r\n正在搜索串口...\r\n");
+    m_serialLog->append(SerialLogModel::Info, u8"正在搜索串口...");
 
 
     foreach(const QSerialPortInfo &info, QSerialPortInfo::availablePorts())
     {
-        m_serial = new QSerialPort;
-        m_serial->setPort(info);
+        QSerialPort port;
+        port.setPort(info);
 
-        if(m_serial->open(QIODevice::ReadWrite))
+        if(port.open(QIODevice::ReadWrite))
         {
-            ui->serialMessageEdit->insertPlainText(u8"可用："+m_serial->portName()+"\r\n");
-            ui->portBox->addItem(m_serial->portName());
-            m_serial->close();
+            m_serialLog->append(SerialLogModel::Info, u8"可用："+port.portName());
+            ui->portBox->addItem(port.portName());
+            port.close();
         }
         else
         {
-            ui->serialMessageEdit->insertPlainText(u8"不可用："+m_serial->portName()+"\r\n");
+            m_serialLog->append(SerialLogModel::Info, u8"不可用："+port.portName());
         }
     }
 
-    ui->serialMessageEdit->moveCursor(QTextCursor::End);        //光标移动到结尾
-
     if (ui->portBox->count() > 0)
     {
         ui->openSerialButton->setEnabled(true);
     }
     else
     {
-        ui->serialMessageEdit->insertPlainText(u8"\r\n无可用串口。\r\n");
+        m_serialLog->append(SerialLogModel::Info, u8"无可用串口。");
     }
 }
 
@@ -1637,53 +2148,10 @@ void MainWindow::on_openSerialButton_clicked()
             return;
         }
 
-        m_serial = new QSerialPort;
-        //设置串口名
-        m_serial->setPortName(ui->portBox->currentText());
-        //设置波特率
-        m_serial->setBaudRate(QSerialPort::Baud115200);
-        //设置数据位
-        m_serial->setDataBits(QSerialPort::Data8);
-        //设置校验位
-        m_serial->setParity(QSerialPort::NoParity);
-        //设置停止位
-        m_serial->setStopBits(QSerialPort::OneStop);
-        //设置流控制
-        m_serial->setFlowControl(QSerialPort::NoFlowControl);  //设置为无流控制
-
-        //连接信号和槽函数，串口有数据可读时，调用ReadData()函数读取数据并处理。
-        // connect(m_serial, &QSerialPort::readyRead, this, &MainWindow::readSerialData);
-
-        //打开串口
-        if (!m_serial->open(QIODevice::ReadWrite)) {
-            QMessageBox::warning(NULL, u8"警告", u8"串口打开失败！\r\n");
-            return;
-        }
-
-        //使能
-        ui->portBox->setEnabled(false);
-        ui->openSerialButton->setText(u8"关闭串口");
-        ui->openSerialButton->setStyleSheet("background-color:red");
-        ui->lockButton->setEnabled(true);
-        ui->highSpeedRadioButton->setEnabled(true);
-        ui->mediumSpeedRadioButton->setEnabled(true);
-        ui->lowSpeedRadioButton->setEnabled(true);
-        ui->rAxisForwardButton->setEnabled(true);
-        ui->rAxisBackwardButton->setEnabled(true);
-        ui->tAxisForwardButton->setEnabled(true);
-        ui->tAxisBackwardButton->setEnabled(true);
-        ui->xAxisForwardButton->setEnabled(true);
-        ui->xAxisBackwardButton->setEnabled(true);
-        ui->yAxisForwardButton->setEnabled(true);
-        ui->yAxisBackwardButton->setEnabled(true);
-        ui->zAxisForwardButton->setEnabled(true);
-        ui->zAxisBackwardButton->setEnabled(true);
-        ui->bigShiftButton->setEnabled(true);
-        ui->smallShiftSlider->setEnabled(true);
-
-        ui->serialMessageEdit->insertPlainText(u8"串口连接成功！\r\n");
-
-        m_serialTimer->start(23);
+        //在串口线程中打开串口: 115200, 8 数据位, 无校验, 1 停止位, 无流控制，结果由 handleSerialOpened 处理
+        ui->openSerialButton->setEnabled(false);
+        QMetaObject::invokeMethod(m_serialWorker, "open", Qt::QueuedConnection,
+                                  Q_ARG(QString, ui->portBox->currentText()), Q_ARG(qint32, QSerialPort::Baud115200));
     }
     else
     {
@@ -1691,18 +2159,50 @@ void MainWindow::on_openSerialButton_clicked()
     }
 }
 
-void MainWindow::closeSerial()
+void MainWindow::handleSerialOpened(bool ok, const QString &message)
 {
-        if (m_serialTimer->isActive()) {
-            m_serialTimer->stop();
-        }
-
-        if (m_serial->isOpen())  //原先串口打开，则关闭串口
-            m_serial->close();
+    ui->openSerialButton->setEnabled(true);
+    if (!ok)
+    {
+        QMessageBox::warning(NULL, u8"警告", u8"串口打开失败！\r\n" + message);
+        return;
+    }
+    m_serialOpen = true;
+
+    //使能
+    ui->portBox->setEnabled(false);
+    ui->openSerialButton->setText(u8"关闭串口");
+    ui->openSerialButton->setStyleSheet("background-color:red");
+    ui->lockButton->setEnabled(true);
+    ui->highSpeedRadioButton->setEnabled(true);
+    ui->mediumSpeedRadioButton->setEnabled(true);
+    ui->lowSpeedRadioButton->setEnabled(true);
+    ui->rAxisForwardButton->setEnabled(true);
+    ui->rAxisBackwardButton->setEnabled(true);
+    ui->tAxisForwardButton->setEnabled(true);
+    ui->tAxisBackwardButton->setEnabled(true);
+    ui->xAxisForwardButton->setEnabled(true);
+    ui->xAxisBackwardButton->setEnabled(true);
+    ui->yAxisForwardButton->setEnabled(true);
+    ui->yAxisBackwardButton->setEnabled(true);
+    ui->zAxisForwardButton->setEnabled(true);
+    ui->zAxisBackwardButton->setEnabled(true);
+    ui->bigShiftButton->setEnabled(true);
+    ui->smallShiftSlider->setEnabled(true);
+    ui->autofocusButton->setEnabled(true);
+    ui->zStackPlanesSpinBox->setEnabled(true);
+    ui->zStackStepSpinBox->setEnabled(true);
+    ui->zStackButton->setEnabled(!m_fusion->isBusy());
+    setMosaicEnabled(true);
+
+    m_serialLog->append(SerialLogModel::Info, u8"串口连接成功！");
+}
 
-        //释放串口
-        delete[] m_serial;
-        m_serial = nullptr;
+void MainWindow::closeSerial()
+{
+        //在串口线程中关闭串口
+        QMetaObject::invokeMethod(m_serialWorker, "close", Qt::QueuedConnection);
+        m_serialOpen = false;
 
         //恢复使能
         ui->portBox->setEnabled(true);
@@ -1724,144 +2224,247 @@ void MainWindow::closeSerial()
         ui->zAxisBackwardButton->setEnabled(false);
         ui->bigShiftButton->setEnabled(false);
         ui->smallShiftSlider->setEnabled(false);
+        ui->autofocusButton->setEnabled(false);
+        ui->zStackPlanesSpinBox->setEnabled(false);
+        ui->zStackStepSpinBox->setEnabled(false);
+        ui->zStackButton->setEnabled(false);
+        setMosaicEnabled(false);
+        m_autofocus->stop();
+        m_zStack->stop();
+        m_mosaicScan->stop();
 }
 
-QByteArray MainWindow::createPacket(const QByteArray &data) {
-    QByteArray packet;
-    QByteArray dataPacket;
-    packet.append(0x55);  // Start byte
-    dataPacket.append(data);
-
-    if (m_lockFlag == 1)
-        dataPacket.append(static_cast<char>(0x01));
-    else
-        dataPacket.append(static_cast<char>(0x00));
-
-    packet.append(dataPacket);
-    uint16_t crc = CRC16::calculate(dataPacket);
-    packet.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+void MainWindow::sendPacket(const MotionPacket &packet)
+{
+    // 附带产生时刻，串口线程据此统计排队延迟
+    if (m_serialOpen)
+        QMetaObject::invokeMethod(m_serialWorker, "setPacket", Qt::QueuedConnection,
+                                  Q_ARG(MotionPacket, packet), Q_ARG(qint64, frameClockNs()));
+}
 
-    packet.append(static_cast<char>(0xAA));  // End byte
-    return packet;
+void MainWindow::on_keepAliveSpinBox_valueChanged(int value)
+{
+    QMetaObject::invokeMethod(m_serialWorker, "setKeepAlive", Qt::QueuedConnection, Q_ARG(int, value));
 }
 
-void MainWindow::readSerialData()
+void MainWindow::on_serialDumpCheckBox_toggled(bool checked)
 {
-    QByteArray data = m_serial->readAll();
-    processReceivedData(data);
+    QString fileName;
+    if (checked)
+    {
+        fileName = QFileDialog::getSaveFileName(this, u8"串口转储", "serial.bin", "Serial Dump (*.bin)");
+        if (fileName.isEmpty())
+        {
+            QSignalBlocker blocker(ui->serialDumpCheckBox);
+            ui->serialDumpCheckBox->setChecked(false);
+            return;
+        }
+        m_serialLog->append(SerialLogModel::Info, u8"转储到 " + fileName);
+    }
+    QMetaObject::invokeMethod(m_serialWorker, "setDumpFile", Qt::QueuedConnection, Q_ARG(QString, fileName));
 }
 
-void MainWindow::processReceivedData(const QByteArray &data) {
-    QString dataString = QString::fromUtf8(data.toHex(' '));
-    ui->serialMessageEdit->insertPlainText(u8"接收：" + dataString + "\r\n");
-    // Verify packet structure
-    // if (data.size() < 19 || data.at(0) != 0x55) {
-    //     ui->serialMessageEdit->insertPlainText(u8"数据接收错误！\r\n");
-    //     return;
-    // }
+MotionPacket MainWindow::movePacket(StageModel::Axis axis, int direction) const
+{
+    qint32 steps = (StageModel::T == axis || StageModel::R == axis) ? m_rotateSteps : m_linearSteps;
+    return MotionCommand::move(axis, steps * direction, m_stageLocked).packet();
 }
 
-void MainWindow::on_bigShiftButton_clicked()
+void MainWindow::moveStage(StageModel::Axis axis, qint32 steps)
 {
-    if (m_serial->isOpen())
+    // 每包之后插入空闲指令，连续相同的包也会再次发出
+    while (steps)
     {
-        m_bigShiftFlag = 1;
-        sendDataPacket = createPacket(bigShiftData);
+        qint32 chunk = qBound(-0x01ff, steps, 0x01ff);
+        sendPacket(MotionCommand::move(axis, chunk, m_stageLocked).packet());
+        sendPacket(m_idlePacket);
+        steps -= chunk;
     }
 }
 
-void MainWindow::on_smallShiftSlider_valueChanged(int value)
+int MainWindow::drainSerial()
 {
-    if (m_serial->isOpen())
-    {
-        unsigned short fInitialValue = 0x01ff;
-        unsigned short fNewValue = fInitialValue - value;
-        fNewValue = fNewValue & 0xFFFF;
-        xForwardData[8] = static_cast<char>(fNewValue >> 8); // 高字节
-        xForwardData[9] = static_cast<char>(fNewValue & 0xFF); // 低字节
-        yForwardData[10] = static_cast<char>(fNewValue >> 8); // 高字节
-        yForwardData[11] = static_cast<char>(fNewValue & 0xFF); // 低字节
-        zForwardData[12] = static_cast<char>(fNewValue >> 8); // 高字节
-        zForwardData[13] = static_cast<char>(fNewValue & 0xFF); // 低字节
+    QMetaObject::invokeMethod(m_serialWorker, "drain", Qt::QueuedConnection, Q_ARG(int, ++m_drainTag));
+    return m_drainTag;
+}
 
-        unsigned short bInitialValue = 0x0201;
-        unsigned short bNewValue = bInitialValue + value;
-        bNewValue = bNewValue & 0xFFFF;
-        xBackwardData[8] = static_cast<char>(bNewValue >> 8); // 高字节
-        xBackwardData[9] = static_cast<char>(bNewValue & 0xFF); // 低字节
-        yBackwardData[10] = static_cast<char>(bNewValue >> 8); // 高字节
-        yBackwardData[11] = static_cast<char>(bNewValue & 0xFF); // 低字节
-        zBackwardData[12] = static_cast<char>(bNewValue >> 8); // 高字节
-        zBackwardData[13] = static_cast<char>(bNewValue & 0xFF); // 低字节
-    }
+void MainWindow::updateIdlePacket()
+{
+    MotionCommand idle;
+    idle.setLocked(m_stageLocked);
+    idle.encode(m_idlePacket);
+    QMetaObject::invokeMethod(m_serialWorker, "setIdlePacket", Qt::QueuedConnection, Q_ARG(MotionPacket, m_idlePacket));
 }
 
-void MainWindow::onSpeedChanged()
+void MainWindow::handleStageStatus(const StageStatus &status)
 {
-    if (ui->lowSpeedRadioButton->isChecked())
-    {
-        rForwardData = QByteArray::fromHex("000000000000000102000200020000");
-        rBackwardData = QByteArray::fromHex("00000000ffffffff02000200020000");
+    m_serialLog->append(SerialLogModel::Received, QString(u8"T=%1 R=%2 X=%3 Y=%4 Z=%5 %6%7")
+                        .arg(status.t).arg(status.r)
+                        .arg(status.x, 4, 16, QChar('0')).arg(status.y, 4, 16, QChar('0')).arg(status.z, 4, 16, QChar('0'))
+                        .arg(status.locked ? u8"锁定" : u8"未锁定")
+                        .arg((status.flags & 0x20) ? u8" 大步进" : ""));
+}
+
+void MainWindow::handleReceiveError(quint64 crcErrors, quint64 framingErrors)
+{
+    m_serialLog->append(SerialLogModel::Error, QString(u8"数据接收错误！(CRC %1，帧 %2)").arg(crcErrors).arg(framingErrors));
+}
 
-        tForwardData = QByteArray::fromHex("000000010000000002000200020000");
-        tBackwardData = QByteArray::fromHex("ffffffff0000000002000200020000");
+void MainWindow::updateStageOverlay()
+{
+    if (!m_stageItem)
+        return;
+
+    StageModel::Position position = m_stage.position();
+    if (StageModel::None == position.source || position.time == m_stageShown)
+        return;
+    m_stageShown = position.time;
+
+    // 没有控制器应答时只是按发出的指令估计
+    m_stageItem->setText(QString(u8"X %1  Y %2  Z %3\nT %4  R %5%6")
+                         .arg(position.axis[StageModel::X]).arg(position.axis[StageModel::Y]).arg(position.axis[StageModel::Z])
+                         .arg(position.axis[StageModel::T]).arg(position.axis[StageModel::R])
+                         .arg(StageModel::Commanded == position.source ? u8"  (估计)" : ""));
+    m_stageItem->setVisible(true);
+}
+
+void MainWindow::on_autofocusButton_clicked()
+{
+    if (m_autofocus->isRunning())
+    {
+        m_autofocus->stop();
+        return;
     }
-    else if (ui->mediumSpeedRadioButton->isChecked())
+    if (!m_cameraThread)
     {
-        rForwardData = QByteArray::fromHex("000000000000006402000200020000");
-        rBackwardData = QByteArray::fromHex("00000000ffffff9c02000200020000");
+        QMessageBox::warning(this, "Warning", u8"请先打开相机。");
+        return;
+    }
+    if (m_zStack->isRunning())
+        m_zStack->stop();
+    if (m_mosaicScan->isRunning())
+        m_mosaicScan->stop();
+    m_autofocus->start();
+    ui->autofocusButton->setText(u8"停止对焦");
+}
 
-        tForwardData = QByteArray::fromHex("000000640000000002000200020000");
-        tBackwardData = QByteArray::fromHex("ffffff9c0000000002000200020000");
+void MainWindow::on_zStackButton_clicked()
+{
+    if (m_zStack->isRunning())
+    {
+        m_zStack->stop();
+        return;
     }
-    else if (ui->highSpeedRadioButton->isChecked())
+    if (!m_cameraThread)
     {
-        rForwardData = QByteArray::fromHex("00000000000003e802000200020000");
-        rBackwardData = QByteArray::fromHex("00000000fffffc1802000200020000");
+        QMessageBox::warning(this, "Warning", u8"请先打开相机。");
+        return;
+    }
+    if (m_autofocus->isRunning())
+        m_autofocus->stop();
+    if (m_mosaicScan->isRunning())
+        m_mosaicScan->stop();
+    QString fileName = QDir(m_captures.scratchPath()).filePath(QString::asprintf("zstack_%04u.rawseq", ++m_zStackCount));
+    m_zStack->start(ui->zStackPlanesSpinBox->value(), ui->zStackStepSpinBox->value(), fileName);
+}
 
-        tForwardData = QByteArray::fromHex("000003e80000000002000200020000");
-        tBackwardData = QByteArray::fromHex("fffffc180000000002000200020000");
+void MainWindow::on_mosaicButton_clicked()
+{
+    if (m_mosaicScan->isRunning())
+    {
+        m_mosaicScan->stop();
+        return;
+    }
+    if (!m_cameraThread)
+    {
+        QMessageBox::warning(this, "Warning", u8"请先打开相机。");
+        return;
     }
+
+    QString directory = QFileDialog::getExistingDirectory(this, u8"拼接结果保存目录", m_mosaicDir);
+    if (directory.isEmpty())
+        return;
+    m_mosaicDir = directory;
+
+    if (m_autofocus->isRunning())
+        m_autofocus->stop();
+    if (m_zStack->isRunning())
+        m_zStack->stop();
+
+    // 步数按视野宽度换算，X/Y 每步的距离视为相同，Y 方向按图像宽高比缩放
+    double overlap = ui->mosaicOverlapSpinBox->value() / 100.0;
+    double fieldSteps = ui->mosaicFieldStepsSpinBox->value();
+    qint32 stepX = qint32(qRound(fieldSteps * (1.0 - overlap)));
+    qint32 stepY = qint32(qRound(fieldSteps * (1.0 - overlap) * m_imgHeight / m_imgWidth));
+    m_mosaicBuilder->start(ui->mosaicColumnsSpinBox->value(), ui->mosaicRowsSpinBox->value(), overlap);
+    m_mosaicScan->start(ui->mosaicColumnsSpinBox->value(), ui->mosaicRowsSpinBox->value(), stepX, stepY);
+}
+
+void MainWindow::setMosaicEnabled(bool enabled)
+{
+    ui->mosaicColumnsSpinBox->setEnabled(enabled);
+    ui->mosaicRowsSpinBox->setEnabled(enabled);
+    ui->mosaicOverlapSpinBox->setEnabled(enabled);
+    ui->mosaicFieldStepsSpinBox->setEnabled(enabled);
+    ui->mosaicButton->setEnabled(enabled && !m_mosaicBuilder->isBusy());
 }
 
-void MainWindow::sendData()
+void MainWindow::on_stageZeroButton_clicked()
+{
+    m_stage.zero();
+    m_stageShown = -1;
+    updateStageOverlay();
+}
+
+void MainWindow::on_bigShiftButton_clicked()
 {
-    if (m_serial->isOpen())
+    if (m_serialOpen)
     {
-        if (m_bigShiftFlag > 0)
-        {
-            m_bigShiftFlag += 1;
-        }
-        if (m_bigShiftFlag > 10)
-        {
-            m_bigShiftFlag = 0;
-            sendDataPacket = defaultDataPacket;
-        }
-        qDebug() << sendDataPacket;
-        m_serial->write(sendDataPacket);
+        // 大步进指令保持约 10 个保活周期后恢复空闲指令
+        MotionCommand bigShift;
+        bigShift.setLocked(m_stageLocked);
+        bigShift.setBigShift(true);
+        QMetaObject::invokeMethod(m_serialWorker, "pulse", Qt::QueuedConnection,
+                                  Q_ARG(MotionPacket, bigShift.packet()), Q_ARG(int, 230), Q_ARG(qint64, frameClockNs()));
     }
 }
 
-void MainWindow::handleSerialError(QSerialPort::SerialPortError error) {
+void MainWindow::on_smallShiftSlider_valueChanged(int value)
+{
+    // 档位 0 对应每包 1 步
+    m_linearSteps = value + 1;
+}
+
+void MainWindow::onSpeedChanged()
+{
+    if (ui->lowSpeedRadioButton->isChecked())
+        m_rotateSteps = MotionCommand::LowSpeed;
+    else if (ui->mediumSpeedRadioButton->isChecked())
+        m_rotateSteps = MotionCommand::MediumSpeed;
+    else if (ui->highSpeedRadioButton->isChecked())
+        m_rotateSteps = MotionCommand::HighSpeed;
+}
+
+void MainWindow::handleSerialError(const QString &message) {
     closeSerial();
-    QMessageBox::warning(this, "Warning", u8"微位移串口连接出错！");
+    QMessageBox::warning(this, "Warning", u8"微位移串口连接出错！\r\n" + message);
 }
 
 void MainWindow::on_lockButton_clicked()
 {
     if(ui->lockButton->text() == tr(u8"锁住"))
     {
-        m_lockFlag = 1;
-        defaultDataPacket = createPacket(defaultData);
-        sendDataPacket = defaultDataPacket;
+        m_stageLocked = true;
+        updateIdlePacket();
+        sendPacket(m_idlePacket);
         ui->lockButton->setText(u8"解锁");
         ui->lockButton->setStyleSheet("background-color:red");
     }
     else
     {
-        m_lockFlag = 0;
-        defaultDataPacket = createPacket(defaultData);
-        sendDataPacket = defaultDataPacket;
+        m_stageLocked = false;
+        updateIdlePacket();
+        sendPacket(m_idlePacket);
         ui->lockButton->setText(u8"锁住");
         ui->lockButton->setStyleSheet("");
     }
@@ -9,15 +9,34 @@
 #include <QPushButton>
 #include <QGraphicsView>
 #include <QGraphicsScene>
-#include <QGraphicsPixmapItem>
-#include <QPixmap>
+#include <QGraphicsSimpleTextItem>
 #include <QString>
 #include <nncam.h>
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 #include <QByteArray>
 #include <QSerialPort>
-#include "cameraThread.h"
+#include <QProgressDialog>
+#include <QDialog>
+#include <QThread>
+#include <QSortFilterProxyModel>
+#include <QSet>
+#include "autofocus.h"
+#include "camerathread.h"
+#include "capturestore.h"
+#include "focusfusion.h"
+#include "frame.h"
+#include "imageexporter.h"
+#include "mosaic.h"
+#include "mosaicscan.h"
+#include "motioncommand.h"
+#include "previewview.h"
+#include "recordthread.h"
+#include "seriallogmodel.h"
+#include "serialworker.h"
+#include "stagemodel.h"
+#include "tileviewer.h"
+#include "zstack.h"
 #include "rectItem.h"
 #include "myGraphicsScene.h"
 
@@ -98,9 +117,11 @@ private slots:
 
     void removeLineWidgets(QGraphicsLineItem* lineItem);
 
-    void handleImageCaptured(const QImage &image);
+    void handleImageCaptured();
 
-    void handleStillImageCaptured(const QImage &image);
+    void handlePreviewImage(const QImage &image, const QRectF &region);
+
+    void handleStillImageCaptured(const Frame &frame);
 
     void handleCameraStartMessage(bool message);
 
@@ -108,6 +129,12 @@ private slots:
 
     void closeTab(int index);
 
+    void on_cacheSpinBox_valueChanged(int value);
+
+    void on_saveAllButton_clicked();
+
+    void on_actionDiagnostics_triggered();
+
     // 串口
     void on_actionSerial_triggered(bool checked);
 
@@ -121,13 +148,31 @@ private slots:
 
     void on_smallShiftSlider_valueChanged(int value);
 
-    void readSerialData();
+    void on_keepAliveSpinBox_valueChanged(int value);
+
+    void on_stageZeroButton_clicked();
+
+    void on_autofocusButton_clicked();
+
+    void on_zStackButton_clicked();
+
+    void on_mosaicButton_clicked();
+
+    void on_serialDumpCheckBox_toggled(bool checked);
+
+    void on_hardwareRoiCheckBox_toggled(bool checked);
 
     void onSpeedChanged();
 
-    void sendData();
+    void handleSerialOpened(bool ok, const QString &message);
+
+    void handleSerialError(const QString &message);
+
+    void handleStageStatus(const StageStatus &status);
+
+    void handleReceiveError(quint64 crcErrors, quint64 framingErrors);
 
-    void handleSerialError(QSerialPort::SerialPortError error);
+    void updateStageOverlay();
 
 private:
     void resizeEvent(QResizeEvent *event);
@@ -141,21 +186,37 @@ private:
     // 串口
     void closeSerial();
 
+    void sendPacket(const MotionPacket &packet);
+
+    void stopRecording();
+
+    void addCaptureTab(const Frame &frame);
+
+    void addMosaicTab(const QString &directory);
+
+    // capture 为抓拍仓库中的序号
+    void removeCaptureTab(int capture);
+    void clearCaptures();
+
+    bool saveAllCaptures(bool removeAfterSave);
+
 
     Ui::MainWindow*      ui;
-    cv::VideoWriter      m_videoWriter;
+    recordThread*        m_recorder;
     bool                 m_isRecording;
+    quint64              m_lastWritten;
+    double               m_measuredFps;
     NncamDeviceV2        m_cur;
-    HNncam               m_hcam;
+    CameraDevice*        m_camera;
     QTimer*              m_timer;
-    QTimer*              m_serialTimer;
     unsigned             m_imgWidth;
     unsigned             m_imgHeight;
     unsigned             m_previewWidth;
     unsigned             m_previewHeight;
     float                m_xpixsz;
     float                m_ypixsz;
-    uchar*               m_pData;
+    FrameRing*           m_frameRing;
+    bool                 m_captureRequested;
     int                  m_res;
     int                  m_target;
     int                  m_time;
@@ -173,54 +234,86 @@ private:
     int                  m_gamma;
     unsigned             m_count;
     MyGraphicsScene*     m_scene;
-    QGraphicsView*       m_imageView;
-    QGraphicsPixmapItem* m_pixmapItem;
+    PreviewView*         m_imageView;
     RectItem*            m_aeItem;
     RectItem*            m_awbItem;
     RectItem*            m_abbItem;
     cameraThread*        m_cameraThread;
+    cameraThread::AcquisitionMode m_acquisitionMode;
+    quint64              m_latencyFrames;
+    qint64               m_latencyNs;
+    unsigned             m_lastSeq;
+    quint64              m_lostFrames;
     RECT                 m_aeRect;
     RECT                 m_awbRect;
     RECT                 m_abbRect;
-    QVector<QImage>      imageVector;
+    CaptureStore         m_captures;
+    QVector<QWidget*>    m_captureTabs;         // 与 m_captures 一一对应的标签页
+    QSet<QString>        m_removeOnExport;      // 导出成功后移除的抓拍(临时文件路径)
+    bool                 m_clearCapturesPending = false;    // 关闭相机后等待导出结束再清空抓拍
+    ImageExporter*       m_exporter = nullptr;
+    QProgressDialog*     m_exportProgress = nullptr;
+    QDialog*             m_diagnostics = nullptr;
+    QThread*             m_serialThread = nullptr;
+    SerialWorker*        m_serialWorker = nullptr;
+    bool                 m_serialOpen = false;
+    SerialLogModel*      m_serialLog = nullptr;
+    QSortFilterProxyModel* m_serialLogFilter = nullptr;
+    bool                 m_serialLogFollow = true;
+    StageModel           m_stage;
+    QGraphicsSimpleTextItem* m_stageItem = nullptr;
+    QTimer*              m_stageTimer = nullptr;
+    qint64               m_stageShown = -1;     // 叠加层显示的位置更新时间
+    Autofocus*           m_autofocus = nullptr;
+    ZStack*              m_zStack = nullptr;
+    unsigned             m_zStackCount = 0;     // Z 堆栈临时序列的编号
+    FocusFusion*         m_fusion = nullptr;
+    MosaicScan*          m_mosaicScan = nullptr;
+    MosaicBuilder*       m_mosaicBuilder = nullptr;
+    int                  m_drainTag = 0;        // 最近一次 SerialWorker::drain 的标记
+    int                  m_autofocusDrain = 0;  // 自动对焦/Z 堆栈/扫描拼接等待的 drain 标记，0 表示没有
+    int                  m_zStackDrain = 0;
+    int                  m_mosaicDrain = 0;
+    QString              m_mosaicDir;           // 拼接结果的保存目录
+    QRect                m_hardwareRoi;         // 已设置到相机的 ROI，空矩形表示整个视野
+    QTimer*              m_roiTimer = nullptr;
     QMap<QGraphicsLineItem*, QLabel*>       labels;
     QMap<QGraphicsLineItem*, QPushButton*>  deleteButtons;
     QMap<QGraphicsLineItem*, QWidget*>      layoutWidgets;
 
-    QByteArray rForwardData = QByteArray::fromHex("000000000000000102000200020000");  
-    QByteArray rBackwardData = QByteArray::fromHex("00000000ffffffff02000200020000");
-
-    QByteArray tForwardData = QByteArray::fromHex("000000010000000002000200020000");
-    QByteArray tBackwardData = QByteArray::fromHex("ffffffff0000000002000200020000");
-
-    QByteArray yForwardData = QByteArray::fromHex("0000000000000000020001ff020000");
-    QByteArray yBackwardData = QByteArray::fromHex("000000000000000002000201020000");
-
-    QByteArray xForwardData = QByteArray::fromHex("000000000000000001ff0200020000");
-    QByteArray xBackwardData = QByteArray::fromHex("000000000000000002010200020000");
-
-    QByteArray zForwardData = QByteArray::fromHex("00000000000000000200020001ff00");
-    QByteArray zBackwardData = QByteArray::fromHex("000000000000000002000200020100");
-
-    QByteArray bigShiftData = QByteArray::fromHex("000000000000000002000200020020");
-
-    QByteArray defaultData = QByteArray::fromHex("000000000000000002000200020000");
-    QByteArray sendDataPacket;
-    QByteArray defaultDataPacket;
+    // 位移台运动指令
+    qint32               m_linearSteps = 1;                          // X/Y/Z 每包步数，由档位滑动条决定
+    qint32               m_rotateSteps = MotionCommand::LowSpeed;    // T/R 每包步数，由速度档决定
+    bool                 m_stageLocked = false;
+    MotionPacket         m_idlePacket;
 
     float rOriginAngle = 0.0;
     float tOriginAngle = 0.0;
     int m_measureFlag = 0;
     float m_distance = 0.0;
-    int m_bigShiftFlag = 0;
-    int m_lockFlag = 0;
 
     // 串口通信
-    QByteArray createPacket(const QByteArray &data);
-
-    void processReceivedData(const QByteArray &data);
+    // 单轴按当前档位运动，direction 为 1 或 -1
+    MotionPacket movePacket(StageModel::Axis axis, int direction) const;
+    void updateIdlePacket();
+    // 单轴移动 steps 步，按指令包逐包发送
+    void moveStage(StageModel::Axis axis, qint32 steps);
+    void moveZ(qint32 steps) { moveStage(StageModel::Z, steps); }
+    // 请求串口线程在此前的指令全部写出后发出 drained，返回标记
+    int drainSerial();
+    void setMosaicEnabled(bool enabled);
+
+    // 预览缩放
+    enum
+    {
+        MaxPreviewZoom = 4,     // 最大放大到传感器像素的倍数
+        MinRoiZoom = 2          // 放大到此倍数以上才设置硬件 ROI
+    };
+    // 缩放平移后更新采集线程的裁剪区域，稍后更新硬件 ROI
+    void updatePreviewRegion();
+    void updateHardwareRoi();
+    void setHardwareRoi(const QRect &roi);
 
-    QSerialPort* m_serial;
     
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,429 @@
+#include <atomic>
+#include <cmath>
+#include <set>
+#include <opencv2/opencv.hpp>
+#include <QDir>
+#include <QImage>
+#include <QRunnable>
+#include <QSettings>
+#include "mosaic.h"
+
+namespace
+{
+
+// 相位相关的峰值低于此值视为配准失败(空白区域、重叠太少)
+const double MinResponse = 0.1;
+
+// 向下取整的整数除法，块序号可以为负
+int floorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+cv::Mat frameMat(const Frame &frame)
+{
+    return cv::Mat(int(frame.height()), int(frame.width()), CV_8UC3, const_cast<uchar*>(frame.data()), frame.stride());
+}
+
+class AddTileTask : public QRunnable
+{
+public:
+    AddTileTask(MosaicBuilder *builder, const QSharedPointer<Mosaic> &mosaic, const Frame &frame, int column, int row)
+        : m_builder(builder), m_mosaic(mosaic), m_frame(frame), m_column(column), m_row(row)
+    {
+    }
+
+    void run() override
+    {
+        Mosaic::Placement placement = m_mosaic->add(m_frame, m_column, m_row);
+        m_frame = Frame();
+        QMetaObject::invokeMethod(m_builder, "tileFinished", Qt::QueuedConnection,
+                                  Q_ARG(int, m_column), Q_ARG(int, m_row), Q_ARG(double, placement.x), Q_ARG(double, placement.y),
+                                  Q_ARG(double, placement.response), Q_ARG(bool, placement.registered));
+    }
+
+private:
+    MosaicBuilder*         m_builder;
+    QSharedPointer<Mosaic> m_mosaic;
+    Frame                  m_frame;
+    int                    m_column;
+    int                    m_row;
+};
+
+class SaveTask : public QRunnable
+{
+public:
+    SaveTask(MosaicBuilder *builder, const QSharedPointer<Mosaic> &mosaic, const QString &directory)
+        : m_builder(builder), m_mosaic(mosaic), m_directory(directory)
+    {
+    }
+
+    void run() override
+    {
+        bool ok = !m_mosaic->isEmpty() && m_mosaic->save(m_directory);
+        QMetaObject::invokeMethod(m_builder, "saveFinished", Qt::QueuedConnection, Q_ARG(bool, ok), Q_ARG(QString, m_directory));
+    }
+
+private:
+    MosaicBuilder*         m_builder;
+    QSharedPointer<Mosaic> m_mosaic;
+    QString                m_directory;
+};
+
+}
+
+Mosaic::Mosaic(int columns, int rows, double overlap)
+    : m_columns(qMax(1, columns)), m_rows(qMax(1, rows)), m_overlap(qBound(0.0, overlap, 0.9))
+    , m_placed(m_columns * m_rows)
+{
+    for (Placed& p : m_placed)
+        p.valid = false;
+}
+
+Mosaic::Tile& Mosaic::tile(const Key &key)
+{
+    Tile& t = m_tiles[key];
+    if (t.image.empty())
+    {
+        t.image = cv::Mat::zeros(TileSize, TileSize, CV_8UC3);
+        if (0 == key.level)
+            t.coverage = cv::Mat::zeros(TileSize, TileSize, CV_8U);
+    }
+    return t;
+}
+
+Mosaic::Placement Mosaic::add(const Frame &frame, int column, int row)
+{
+    Placement placement;
+    placement.x = placement.y = 0.0;
+    placement.response = 0.0;
+    placement.registered = false;
+    if (frame.isNull() || column < 0 || column >= m_columns || row < 0 || row >= m_rows)
+        return placement;
+
+    cv::Mat image = frameMat(frame);
+    cv::Point2d step(image.cols * (1.0 - m_overlap), image.rows * (1.0 - m_overlap));
+
+    cv::Mat gray, small;
+    cv::cvtColor(image, gray, cv::COLOR_RGB2GRAY);
+    cv::resize(gray, small, cv::Size(image.cols / RegistrationScale, image.rows / RegistrationScale), 0, 0, cv::INTER_AREA);
+    small.convertTo(small, CV_32F);
+
+    // 与相邻的已放置图像配准，取相关最强的一个；都不可用时相对任一邻居按标称偏移放置
+    cv::Point2d position(column * step.x, row * step.y);
+    bool haveNeighbor = false;
+    const int neighbors[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    for (const auto& n : neighbors)
+    {
+        int c = column + n[0];
+        int r = row + n[1];
+        if (c < 0 || c >= m_columns || r < 0 || r >= m_rows || !m_placed[r * m_columns + c].valid)
+            continue;
+
+        const Placed& neighbor = m_placed[r * m_columns + c];
+        cv::Point2d offset(-n[0] * step.x, -n[1] * step.y);
+        cv::Point2d candidate;
+        double response = 0.0;
+        if (registerTo(neighbor, offset, small, gray, candidate, response))
+        {
+            if (!placement.registered || response > placement.response)
+            {
+                position = candidate;
+                placement.response = response;
+                placement.registered = true;
+            }
+        }
+        else if (!haveNeighbor && !placement.registered)
+        {
+            position = neighbor.position + offset;
+        }
+        haveNeighbor = true;
+    }
+
+    Placed& placed = m_placed[row * m_columns + column];
+    placed.valid = true;
+    placed.small = small;
+    placed.gray = gray;
+    placed.position = position;
+    releaseFinished(column, row);
+
+    if (m_alpha.size() != image.size())
+    {
+        // 羽化宽度为重叠宽度的一半，边缘权重最低
+        double feather = qMax(1.0, qMin(image.cols, image.rows) * m_overlap / 2.0);
+        cv::Mat ax(1, image.cols, CV_32F), ay(image.rows, 1, CV_32F);
+        for (int x = 0; x < image.cols; ++x)
+            ax.at<float>(0, x) = float(qMin(1.0, (qMin(x, image.cols - 1 - x) + 1) / feather));
+        for (int y = 0; y < image.rows; ++y)
+            ay.at<float>(y, 0) = float(qMin(1.0, (qMin(y, image.rows - 1 - y) + 1) / feather));
+        cv::min(cv::repeat(ax, image.rows, 1), cv::repeat(ay, 1, image.cols), m_alpha);
+    }
+
+    cv::Point origin(cvRound(position.x), cvRound(position.y));
+    blend(image, origin);
+
+    placement.x = position.x;
+    placement.y = position.y;
+    return placement;
+}
+
+bool Mosaic::registerTo(const Placed &neighbor, const cv::Point2d &offset, const cv::Mat &small, const cv::Mat &gray,
+                        cv::Point2d &position, double &response) const
+{
+    // 缩小后的整数偏移下两图的重叠区
+    cv::Point shift(cvRound(offset.x / RegistrationScale), cvRound(offset.y / RegistrationScale));
+    cv::Rect inNeighbor = cv::Rect(shift, small.size()) & cv::Rect(cv::Point(), neighbor.small.size());
+    if (inNeighbor.width < 16 || inNeighbor.height < 16)
+        return false;
+    cv::Rect inTile = inNeighbor - shift;
+
+    cv::Mat window;
+    cv::createHanningWindow(window, inNeighbor.size(), CV_32F);
+    cv::Point2d measured = cv::phaseCorrelate(neighbor.small(inNeighbor), small(inTile), window, &response);
+
+    // 本图内容相对邻居平移 measured，即位置比标称多 -measured；超过重叠区 1/4 的结果不可信
+    if (response < MinResponse || std::abs(measured.x) > inNeighbor.width / 4.0 || std::abs(measured.y) > inNeighbor.height / 4.0)
+        return false;
+    cv::Point2d relative = cv::Point2d(shift.x - measured.x, shift.y - measured.y) * double(RegistrationScale);
+
+    // 缩小后的亚像素结果仍有 1~2 像素误差，在全分辨率重叠区中心再求一次
+    cv::Point coarse(cvRound(relative.x), cvRound(relative.y));
+    cv::Rect overlap = cv::Rect(coarse, gray.size()) & cv::Rect(cv::Point(), neighbor.gray.size());
+    cv::Size size(qMin(int(RefineSize), overlap.width), qMin(int(RefineSize), overlap.height));
+    if (!neighbor.gray.empty() && size.width >= 16 && size.height >= 16)
+    {
+        cv::Rect refine(overlap.x + (overlap.width - size.width) / 2, overlap.y + (overlap.height - size.height) / 2, size.width, size.height);
+        cv::Mat a, b;
+        neighbor.gray(refine).convertTo(a, CV_32F);
+        gray(refine - coarse).convertTo(b, CV_32F);
+        cv::createHanningWindow(window, size, CV_32F);
+        double fineResponse = 0.0;
+        cv::Point2d fine = cv::phaseCorrelate(a, b, window, &fineResponse);
+        if (fineResponse >= MinResponse && std::abs(fine.x) < size.width / 4.0 && std::abs(fine.y) < size.height / 4.0)
+        {
+            relative = cv::Point2d(coarse.x - fine.x, coarse.y - fine.y);
+            response = fineResponse;
+        }
+    }
+
+    position = neighbor.position + relative;
+    return true;
+}
+
+void Mosaic::releaseFinished(int column, int row)
+{
+    // 上下左右都已放置(或在网格外)的图像不会再被配准
+    const int neighbors[5][2] = { { 0, 0 }, { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    for (const auto& n : neighbors)
+    {
+        int c = column + n[0];
+        int r = row + n[1];
+        if (c < 0 || c >= m_columns || r < 0 || r >= m_rows || !m_placed[r * m_columns + c].valid)
+            continue;
+        bool finished = true;
+        for (int k = 1; k < 5 && finished; ++k)
+        {
+            int nc = c + neighbors[k][0];
+            int nr = r + neighbors[k][1];
+            if (nc >= 0 && nc < m_columns && nr >= 0 && nr < m_rows && !m_placed[nr * m_columns + nc].valid)
+                finished = false;
+        }
+        if (finished)
+        {
+            m_placed[r * m_columns + c].small.release();
+            m_placed[r * m_columns + c].gray.release();
+        }
+    }
+}
+
+void Mosaic::blend(const cv::Mat &image, const cv::Point &origin)
+{
+    cv::Rect placed(origin, image.size());
+    m_bounds = m_bounds.area() ? (m_bounds | placed) : placed;
+
+    // 先在单线程中建好所有受影响的块，并行部分不修改 m_tiles
+    std::vector<Key> keys;
+    std::vector<Tile*> tiles;
+    for (int ty = floorDiv(placed.y, TileSize); ty <= floorDiv(placed.br().y - 1, TileSize); ++ty)
+    {
+        for (int tx = floorDiv(placed.x, TileSize); tx <= floorDiv(placed.br().x - 1, TileSize); ++tx)
+        {
+            Key key = { 0, tx, ty };
+            keys.push_back(key);
+            tiles.push_back(&tile(key));
+        }
+    }
+
+    const cv::Mat& alpha = m_alpha;
+    cv::parallel_for_(cv::Range(0, int(keys.size())), [&](const cv::Range &range) {
+        cv::Mat src, dst, weight, weight3;
+        for (int i = range.start; i < range.end; ++i)
+        {
+            cv::Rect tileRect(keys[i].x * TileSize, keys[i].y * TileSize, TileSize, TileSize);
+            cv::Rect overlap = tileRect & placed;
+            cv::Rect inImage = overlap - origin;
+            cv::Rect inTile = overlap - tileRect.tl();
+
+            // 块内尚无图像处直接写入，已有图像处按羽化权重混合
+            cv::Mat target = tiles[i]->image(inTile);
+            cv::Mat coverage = tiles[i]->coverage(inTile);
+            weight = alpha(inImage).clone();
+            weight.setTo(1.0f, coverage == 0);
+            cv::merge(std::vector<cv::Mat>(3, weight), weight3);
+
+            image(inImage).convertTo(src, CV_32FC3);
+            target.convertTo(dst, CV_32FC3);
+            dst += (src - dst).mul(weight3);
+            dst.convertTo(target, CV_8UC3);
+            coverage.setTo(255);
+        }
+    });
+
+    updatePyramid(keys);
+}
+
+void Mosaic::updatePyramid(std::vector<Key> dirty)
+{
+    for (int level = 1; level < MaxLevels && !dirty.empty(); ++level)
+    {
+        std::set<Key> parents;
+        for (const Key& key : dirty)
+        {
+            Key parent = { level, floorDiv(key.x, 2), floorDiv(key.y, 2) };
+            parents.insert(parent);
+        }
+
+        dirty.assign(parents.begin(), parents.end());
+        std::vector<Tile*> tiles;
+        for (const Key& key : dirty)
+            tiles.push_back(&tile(key));
+
+        // 上一级块由下一级的 2x2 个块缩小得到
+        cv::parallel_for_(cv::Range(0, int(dirty.size())), [&](const cv::Range &range) {
+            cv::Mat canvas(2 * TileSize, 2 * TileSize, CV_8UC3);
+            for (int i = range.start; i < range.end; ++i)
+            {
+                canvas.setTo(cv::Scalar::all(0));
+                for (int cy = 0; cy < 2; ++cy)
+                {
+                    for (int cx = 0; cx < 2; ++cx)
+                    {
+                        Key child = { dirty[i].level - 1, dirty[i].x * 2 + cx, dirty[i].y * 2 + cy };
+                        auto it = m_tiles.find(child);
+                        if (it != m_tiles.end())
+                            it->second.image.copyTo(canvas(cv::Rect(cx * TileSize, cy * TileSize, TileSize, TileSize)));
+                    }
+                }
+                cv::resize(canvas, tiles[i]->image, tiles[i]->image.size(), 0, 0, cv::INTER_AREA);
+            }
+        });
+    }
+}
+
+int Mosaic::levels() const
+{
+    int size = qMax(m_bounds.width, m_bounds.height);
+    int levels = 1;
+    while (levels < MaxLevels && (size >> (levels - 1)) > TileSize)
+        ++levels;
+    return levels;
+}
+
+bool Mosaic::save(const QString &directory) const
+{
+    // 原点对齐到最高一级块的边界，各级块的划分保持一致
+    int levels = this->levels();
+    int span = TileSize << (levels - 1);
+    cv::Point origin(floorDiv(m_bounds.x, span) * span, floorDiv(m_bounds.y, span) * span);
+
+    QDir dir(directory);
+    std::vector<std::pair<Key, const Tile*>> tiles;
+    for (int level = 0; level < levels; ++level)
+    {
+        if (!dir.mkpath(QString::number(level)))
+            return false;
+    }
+    for (const auto& entry : m_tiles)
+    {
+        if (entry.first.level < levels)
+            tiles.push_back(std::make_pair(entry.first, &entry.second));
+    }
+
+    std::atomic<int> failures(0);
+    cv::parallel_for_(cv::Range(0, int(tiles.size())), [&](const cv::Range &range) {
+        for (int i = range.start; i < range.end; ++i)
+        {
+            const Key& key = tiles[i].first;
+            int x = key.x - origin.x / (TileSize << key.level);
+            int y = key.y - origin.y / (TileSize << key.level);
+            const cv::Mat& image = tiles[i].second->image;
+            QImage tileImage(image.data, image.cols, image.rows, int(image.step), QImage::Format_RGB888);
+            if (!tileImage.save(dir.filePath(QString("%1/%2_%3.jpg").arg(key.level).arg(x).arg(y)), "JPG", 90))
+                ++failures;
+        }
+    });
+    if (failures > 0)
+        return false;
+
+    QSettings settings(dir.filePath("mosaic.ini"), QSettings::IniFormat);
+    settings.beginGroup("mosaic");
+    settings.setValue("width", m_bounds.width);
+    settings.setValue("height", m_bounds.height);
+    settings.setValue("offsetX", m_bounds.x - origin.x);
+    settings.setValue("offsetY", m_bounds.y - origin.y);
+    settings.setValue("tileSize", int(TileSize));
+    settings.setValue("levels", levels);
+    settings.setValue("format", "jpg");
+    settings.endGroup();
+    settings.sync();
+    return settings.status() == QSettings::NoError;
+}
+
+MosaicBuilder::MosaicBuilder(QObject *parent)
+    : QObject(parent), m_pending(0)
+{
+    // 图像须按到达顺序逐张拼接，单张内部已经并行
+    m_pool.setMaxThreadCount(1);
+}
+
+MosaicBuilder::~MosaicBuilder()
+{
+    m_pool.waitForDone();
+}
+
+void MosaicBuilder::start(int columns, int rows, double overlap)
+{
+    m_mosaic = QSharedPointer<Mosaic>(new Mosaic(columns, rows, overlap));
+}
+
+void MosaicBuilder::addTile(const Frame &frame, int column, int row)
+{
+    if (!m_mosaic)
+        return;
+    ++m_pending;
+    m_pool.start(new AddTileTask(this, m_mosaic, frame, column, row));
+}
+
+void MosaicBuilder::finish(const QString &directory)
+{
+    if (!m_mosaic)
+    {
+        emit finished(false, directory);
+        return;
+    }
+    ++m_pending;
+    m_pool.start(new SaveTask(this, m_mosaic, directory));
+    m_mosaic.clear();
+}
+
+void MosaicBuilder::tileFinished(int column, int row, double x, double y, double response, bool registered)
+{
+    --m_pending;
+    emit tilePlaced(column, row, x, y, response, registered);
+}
+
+void MosaicBuilder::saveFinished(bool ok, const QString &directory)
+{
+    --m_pending;
+    emit finished(ok, directory);
+}
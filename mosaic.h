@@ -0,0 +1,126 @@
+#ifndef MOSAIC_H
+#define MOSAIC_H
+
+#include <map>
+#include <opencv2/core.hpp>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include "frame.h"
+
+// 拼接图像
+// 图像按扫描顺序逐张加入: 先在缩小 RegistrationScale 倍的灰度图上与已放置的相邻图像做相位相关，
+// 修正标称位置(列/行 x 图像尺寸 x (1 - 重叠))的误差，再在全分辨率重叠区中心的 RefineSize 窗口内求亚像素偏移，
+// 然后在重叠区按到边缘的距离羽化融合；
+// 结果保存为 TileSize 的分块金字塔，每加入一张只更新受影响的块及其上层，扫描结束时几乎不需要额外计算
+// 全分辨率的块在保存前都保留在内存中
+// 非线程安全，由 MosaicBuilder 在单个工作线程中调用，块内的计算用 cv::parallel_for_ 并行
+class Mosaic
+{
+public:
+    enum
+    {
+        TileSize = 256,
+        RegistrationScale = 4,
+        RefineSize = 256,
+        MaxLevels = 12
+    };
+
+    struct Placement
+    {
+        double x;           // 全分辨率下的位置
+        double y;
+        double response;    // 相位相关的峰值，未配准时为 0
+        bool   registered;  // false 表示没有可用的相邻图像或相关太弱，按标称位置放置
+    };
+
+    Mosaic(int columns, int rows, double overlap);
+
+    // 加入第 column 列第 row 行的图像，返回最终放置的位置
+    Placement add(const Frame &frame, int column, int row);
+
+    bool isEmpty() const { return m_bounds.area() == 0; }
+    // 全分辨率下已覆盖的范围
+    cv::Rect bounds() const { return m_bounds; }
+    // 金字塔级数，最高一级的宽高不超过一个块
+    int levels() const;
+
+    // 写出 <directory>/<level>/<x>_<y>.jpg 与 mosaic.ini，level 0 为全分辨率，块序号从 0 开始
+    bool save(const QString &directory) const;
+
+private:
+    struct Key
+    {
+        int level;
+        int x;
+        int y;
+        bool operator<(const Key &other) const
+        {
+            if (level != other.level)
+                return level < other.level;
+            return y != other.y ? y < other.y : x < other.x;
+        }
+    };
+
+    struct Tile
+    {
+        cv::Mat image;      // TileSize x TileSize RGB24
+        cv::Mat coverage;   // 仅 level 0，非 0 表示已有图像
+    };
+
+    struct Placed
+    {
+        bool        valid;
+        cv::Mat     small;      // 缩小后的灰度图(CV_32F)
+        cv::Mat     gray;       // 全分辨率灰度图，四周的图像都放置后释放
+        cv::Point2d position;
+    };
+
+    bool registerTo(const Placed &neighbor, const cv::Point2d &offset, const cv::Mat &small, const cv::Mat &gray,
+                    cv::Point2d &position, double &response) const;
+    void releaseFinished(int column, int row);
+    void blend(const cv::Mat &image, const cv::Point &origin);
+    void updatePyramid(std::vector<Key> dirty);
+    Tile& tile(const Key &key);
+
+    int                  m_columns;
+    int                  m_rows;
+    double               m_overlap;
+    QVector<Placed>      m_placed;
+    std::map<Key, Tile>  m_tiles;
+    cv::Rect             m_bounds;
+    cv::Mat              m_alpha;   // 羽化权重，与图像同尺寸
+};
+
+// 在后台线程中逐张拼接，扫描过程中图像到达即开始配准与融合
+class MosaicBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MosaicBuilder(QObject *parent = nullptr);
+    ~MosaicBuilder();
+
+    void start(int columns, int rows, double overlap);
+    void addTile(const Frame &frame, int column, int row);
+    // 等已提交的图像拼完后保存到 directory
+    void finish(const QString &directory);
+    bool isBusy() const { return m_pending > 0; }
+
+signals:
+    void tilePlaced(int column, int row, double x, double y, double response, bool registered);
+    void finished(bool ok, const QString &directory);
+
+private slots:
+    void tileFinished(int column, int row, double x, double y, double response, bool registered);
+    void saveFinished(bool ok, const QString &directory);
+
+private:
+    QThreadPool             m_pool;
+    QSharedPointer<Mosaic>  m_mosaic;
+    int                     m_pending;
+};
+
+#endif // MOSAIC_H
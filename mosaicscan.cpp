@@ -0,0 +1,103 @@
+#include "mosaicscan.h"
+
+MosaicScan::MosaicScan(QObject *parent)
+    : QObject(parent)
+    , m_state(Idle)
+    , m_columns(0), m_rows(0), m_stepX(0), m_stepY(0)
+    , m_index(0), m_x(0), m_y(0), m_snapTime(0)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &MosaicScan::timeout);
+}
+
+void MosaicScan::start(int columns, int rows, qint32 stepX, qint32 stepY)
+{
+    m_columns = qMax(1, columns);
+    m_rows = qMax(1, rows);
+    m_stepX = stepX;
+    m_stepY = stepY;
+    m_x = m_y = 0;
+    emit progress(0, m_columns * m_rows);
+    moveTo(0);
+}
+
+void MosaicScan::stop()
+{
+    if (isRunning())
+        finish(false, u8"已停止");
+}
+
+void MosaicScan::moveTo(int index)
+{
+    m_index = index;
+    qint32 x = column(index) * m_stepX;
+    qint32 y = row(index) * m_stepY;
+    qint32 dx = x - m_x;
+    qint32 dy = y - m_y;
+    m_x = x;
+    m_y = y;
+    if (!dx && !dy)
+    {
+        m_state = Settling;
+        m_timer->start(SettleTime);
+        return;
+    }
+    m_state = Moving;
+    m_timer->start(MoveTimeout);
+    emit move(dx, dy);
+}
+
+void MosaicScan::moveSent()
+{
+    if (Moving != m_state)
+        return;
+    m_state = Settling;
+    m_timer->start(SettleTime);
+}
+
+void MosaicScan::timeout()
+{
+    if (Moving == m_state)
+    {
+        finish(false, u8"等待移动指令发出超时");
+    }
+    else if (Settling == m_state)
+    {
+        m_state = Snapping;
+        m_snapTime = frameClockNs();
+        m_timer->start(SnapTimeout);
+        emit snap();
+    }
+    else if (Snapping == m_state)
+    {
+        finish(false, u8"等待抓拍图像超时");
+    }
+}
+
+void MosaicScan::addFrame(const Frame &frame)
+{
+    if (Snapping != m_state || frame.isNull() || frame.arrival() < m_snapTime)
+        return;
+
+    m_timer->stop();
+    int total = m_columns * m_rows;
+    emit tileAcquired(frame, column(m_index), row(m_index));
+    emit progress(m_index + 1, total);
+    if (m_index + 1 < total)
+        moveTo(m_index + 1);
+    else
+        finish(true, QString());
+}
+
+void MosaicScan::finish(bool ok, const QString &message)
+{
+    m_timer->stop();
+    m_state = Idle;
+
+    // 回到起点
+    if (m_x || m_y)
+        emit move(-m_x, -m_y);
+    m_x = m_y = 0;
+    emit finished(ok, message);
+}
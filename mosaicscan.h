@@ -0,0 +1,75 @@
+#ifndef MOSAICSCAN_H
+#define MOSAICSCAN_H
+
+#include <QObject>
+#include <QTimer>
+#include "frame.h"
+
+// XY 蛇形扫描
+// 以当前位置为第 0 列第 0 行，逐行扫描，奇数行反向，相邻两张图像的间隔为 stepX / stepY 步；
+// 调用方确认移动指令已全部发出(moveSent)后稳定 SettleTime 再请求一次抓拍，
+// 收到图像后交给调用方并移动到下一个位置；全部完成后回到起点
+// 与 ZStack 相同，移动和抓拍通过信号交给调用方
+class MosaicScan : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum
+    {
+        SettleTime = 120,       // 最后一包移动指令发出后的稳定时间，XY 移动距离较大，比 Z 轴长(ms)
+        MoveTimeout = 5000,     // 等待移动指令发出的最长时间(ms)
+        SnapTimeout = 5000      // 等待抓拍图像的最长时间(ms)
+    };
+
+    explicit MosaicScan(QObject *parent = nullptr);
+
+    void start(int columns, int rows, qint32 stepX, qint32 stepY);
+    void stop();
+    bool isRunning() const { return m_state != Idle; }
+
+    // move 请求的指令已全部写出串口
+    void moveSent();
+
+    // 交给抓拍得到的静态图像
+    void addFrame(const Frame &frame);
+
+signals:
+    // 请求 X/Y 轴分别移动 dx / dy 步
+    void move(qint32 dx, qint32 dy);
+    void snap();
+    void tileAcquired(const Frame &frame, int column, int row);
+    void finished(bool ok, const QString &message);
+    void progress(int done, int total);
+
+private slots:
+    void timeout();
+
+private:
+    enum State
+    {
+        Idle,
+        Moving,
+        Settling,
+        Snapping
+    };
+
+    // 第 index 张图像的列号，奇数行从右向左
+    int column(int index) const { return (index / m_columns) % 2 ? m_columns - 1 - index % m_columns : index % m_columns; }
+    int row(int index) const { return index / m_columns; }
+    void moveTo(int index);
+    void finish(bool ok, const QString &message);
+
+    State   m_state;
+    int     m_columns;
+    int     m_rows;
+    qint32  m_stepX;
+    qint32  m_stepY;
+    int     m_index;     // 当前位置的序号
+    qint32  m_x;         // 相对起点的步数
+    qint32  m_y;
+    qint64  m_snapTime;  // 请求抓拍的时刻(ns)，更早到达的图像不属于本位置
+    QTimer* m_timer;
+};
+
+#endif // MOSAICSCAN_H
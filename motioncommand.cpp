@@ -0,0 +1,75 @@
+#include "crc16.h"
+#include "motioncommand.h"
+
+namespace
+{
+
+void writeUInt32(uchar *p, quint32 v)
+{
+    p[0] = uchar(v >> 24);
+    p[1] = uchar(v >> 16);
+    p[2] = uchar(v >> 8);
+    p[3] = uchar(v);
+}
+
+void writeUInt16(uchar *p, quint16 v)
+{
+    p[0] = uchar(v >> 8);
+    p[1] = uchar(v);
+}
+
+}
+
+MotionCommand::MotionCommand()
+    : m_locked(false)
+{
+    stop();
+}
+
+void MotionCommand::stop()
+{
+    for (int a = 0; a < StageModel::AxisCount; ++a)
+        m_steps[a] = 0;
+    m_bigShift = false;
+}
+
+void MotionCommand::setSteps(StageModel::Axis axis, qint32 steps)
+{
+    // 0x0200 - steps 须落在 uint16 范围内
+    if (StageModel::X == axis || StageModel::Y == axis || StageModel::Z == axis)
+        steps = qBound(qint32(AxisNeutral) - 0xFFFF, steps, qint32(AxisNeutral));
+    m_steps[axis] = steps;
+}
+
+void MotionCommand::encode(uchar *packet) const
+{
+    uchar *payload = packet + 1;
+    packet[0] = PacketFramer::StartByte;
+    writeUInt32(payload, quint32(m_steps[StageModel::T]));
+    writeUInt32(payload + 4, quint32(m_steps[StageModel::R]));
+    writeUInt16(payload + 8, quint16(AxisNeutral - m_steps[StageModel::X]));
+    writeUInt16(payload + 10, quint16(AxisNeutral - m_steps[StageModel::Y]));
+    writeUInt16(payload + 12, quint16(AxisNeutral - m_steps[StageModel::Z]));
+    payload[14] = m_bigShift ? BigShiftFlag : 0;
+    payload[15] = m_locked ? 0x01 : 0x00;
+
+    uint16_t crc = CRC16::calculate(payload, PacketFramer::PayloadSize + 1);
+    packet[PacketFramer::PayloadSize + 2] = uchar(crc & 0xFF);
+    packet[PacketFramer::PayloadSize + 3] = uchar(crc >> 8);
+    packet[PacketFramer::PacketSize - 1] = PacketFramer::EndByte;
+}
+
+MotionPacket MotionCommand::packet() const
+{
+    MotionPacket packet;
+    encode(packet.bytes);
+    return packet;
+}
+
+MotionCommand MotionCommand::move(StageModel::Axis axis, qint32 steps, bool locked)
+{
+    MotionCommand command;
+    command.setLocked(locked);
+    command.setSteps(axis, steps);
+    return command;
+}
@@ -0,0 +1,73 @@
+#ifndef MOTIONCOMMAND_H
+#define MOTIONCOMMAND_H
+
+#include <cstring>
+#include <QMetaType>
+#include "packetframer.h"
+#include "stagemodel.h"
+
+// 编码好的指令包，定长值类型，复制和跨线程传递都不分配内存
+struct MotionPacket
+{
+    uchar bytes[PacketFramer::PacketSize];
+
+    const char* data() const { return reinterpret_cast<const char*>(bytes); }
+    const uchar* payload() const { return bytes + 1; }
+    static int size() { return PacketFramer::PacketSize; }
+
+    bool operator==(const MotionPacket &other) const { return 0 == memcmp(bytes, other.bytes, sizeof(bytes)); }
+    bool operator!=(const MotionPacket &other) const { return !(*this == other); }
+};
+
+Q_DECLARE_METATYPE(MotionPacket)
+
+// 位移台运动指令
+// 0x55 | T(int32) R(int32) X Y Z(uint16) 标志 | 锁定位 | CRC16/MODBUS(小端) | 0xAA，数值均为大端
+// 各轴给出每包移动的步数，正数为正向: T/R 直接写入，X/Y/Z 写入 0x0200 - 步数(0x0200 静止)
+class MotionCommand
+{
+public:
+    // T/R 轴各速度档每包的步数
+    enum Speed
+    {
+        LowSpeed = 1,
+        MediumSpeed = 100,
+        HighSpeed = 1000
+    };
+
+    enum
+    {
+        AxisNeutral = 0x0200,
+        BigShiftFlag = 0x20
+    };
+
+    MotionCommand();
+
+    // 所有轴静止并清除大步进，锁定位保留
+    void stop();
+
+    // X/Y/Z 超出字段范围时截断
+    void setSteps(StageModel::Axis axis, qint32 steps);
+    qint32 steps(StageModel::Axis axis) const { return m_steps[axis]; }
+
+    void setLocked(bool locked) { m_locked = locked; }
+    bool locked() const { return m_locked; }
+
+    void setBigShift(bool bigShift) { m_bigShift = bigShift; }
+    bool bigShift() const { return m_bigShift; }
+
+    // 编码到调用方提供的 PacketFramer::PacketSize 字节缓冲
+    void encode(uchar *packet) const;
+    void encode(MotionPacket &packet) const { encode(packet.bytes); }
+    MotionPacket packet() const;
+
+    // 单轴运动，其余轴静止
+    static MotionCommand move(StageModel::Axis axis, qint32 steps, bool locked);
+
+private:
+    qint32 m_steps[StageModel::AxisCount];
+    bool   m_locked;
+    bool   m_bigShift;
+};
+
+#endif // MOTIONCOMMAND_H
@@ -76,6 +76,7 @@ public:
     void startDrawingLineAt(const QPointF& startPoint) {
         currentLineItem = new QGraphicsLineItem(QLineF(startPoint, startPoint));
         currentLineItem->setFlag(QGraphicsItem::ItemIsSelectable);
+        currentLineItem->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
         addItem(currentLineItem);
     }
 
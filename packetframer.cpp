@@ -0,0 +1,111 @@
+#include <cstring>
+#include "crc16.h"
+#include "frame.h"
+#include "packetframer.h"
+
+namespace
+{
+
+qint32 readInt32(const uchar *p)
+{
+    return qint32((quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]));
+}
+
+quint16 readUInt16(const uchar *p)
+{
+    return quint16((p[0] << 8) | p[1]);
+}
+
+}
+
+PacketFramer::PacketFramer()
+    : m_length(0)
+{
+    resetStats();
+}
+
+void PacketFramer::resetStats()
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool PacketFramer::validate(const uchar *packet)
+{
+    if (packet[0] != StartByte || packet[PacketSize - 1] != EndByte)
+        return false;
+    uint16_t crc = CRC16::calculate(packet + 1, PayloadSize + 1);
+    return crc == uint16_t(packet[PayloadSize + 2] | (packet[PayloadSize + 3] << 8));
+}
+
+StageStatus PacketFramer::decode(const uchar *packet)
+{
+    const uchar *payload = packet + 1;
+    StageStatus status;
+    status.t = readInt32(payload);
+    status.r = readInt32(payload + 4);
+    status.x = readUInt16(payload + 8);
+    status.y = readUInt16(payload + 10);
+    status.z = readUInt16(payload + 12);
+    status.flags = payload[14];
+    status.locked = payload[15] != 0;
+    status.arrival = frameClockNs();
+    return status;
+}
+
+int PacketFramer::feed(const char *data, int size, QVector<StageStatus> &out)
+{
+    const uchar *p = reinterpret_cast<const uchar*>(data);
+    const uchar *end = p + size;
+    int count = 0;
+
+    while (p < end)
+    {
+        // 寻找帧头
+        if (0 == m_length)
+        {
+            const uchar *start = static_cast<const uchar*>(memchr(p, StartByte, size_t(end - p)));
+            if (!start)
+            {
+                m_stats.discarded += quint64(end - p);
+                break;
+            }
+            m_stats.discarded += quint64(start - p);
+            p = start;
+        }
+
+        // 尽量整段拷贝，凑满一个包再检查
+        int n = qMin(int(end - p), PacketSize - m_length);
+        memcpy(m_buffer + m_length, p, size_t(n));
+        m_length += n;
+        p += n;
+        if (m_length < PacketSize)
+            break;
+
+        if (validate(m_buffer))
+        {
+            out.append(decode(m_buffer));
+            ++m_stats.packets;
+            ++count;
+            m_length = 0;
+        }
+        else
+        {
+            if (m_buffer[PacketSize - 1] != EndByte)
+                ++m_stats.framingErrors;
+            else
+                ++m_stats.crcErrors;
+            resync();
+        }
+    }
+    return count;
+}
+
+void PacketFramer::resync()
+{
+    // 坏包中下一个帧头之前的字节全部丢弃
+    const uchar *next = static_cast<const uchar*>(memchr(m_buffer + 1, StartByte, size_t(m_length - 1)));
+    int skip = next ? int(next - m_buffer) : m_length;
+    m_stats.discarded += quint64(skip);
+    m_length -= skip;
+    memmove(m_buffer, m_buffer + skip, size_t(m_length));
+}
@@ -0,0 +1,70 @@
+#ifndef PACKETFRAMER_H
+#define PACKETFRAMER_H
+
+#include <QMetaType>
+#include <QVector>
+#include <QtGlobal>
+
+// 位移台控制器应答，帧格式与 MotionCommand 编码的指令相同:
+// 0x55 | 15 字节数据 | 锁定位 | CRC16/MODBUS(数据 + 锁定位，小端) | 0xAA
+// 数据区按指令的字段布局解码，数值均为大端
+struct StageStatus
+{
+    qint32  t;          // T 轴
+    qint32  r;          // R 轴
+    quint16 x;          // X/Y/Z 轴字段，0x0200 为静止
+    quint16 y;
+    quint16 z;
+    quint8  flags;      // 第 15 字节，0x20 为大步进
+    bool    locked;     // 锁定位
+    qint64  arrival;    // 收齐该包的时间(ns)，见 frameClockNs()
+};
+
+Q_DECLARE_METATYPE(StageStatus)
+
+// 串口字节流的增量分帧
+// 每次读到的数据可以是半个包或多个包；帧头/帧尾/CRC 校验失败时从失败包内的下一个帧头重新同步，
+// 不会因为一个坏包丢掉紧随其后的好包
+class PacketFramer
+{
+public:
+    enum
+    {
+        StartByte = 0x55,
+        EndByte = 0xAA,
+        PayloadSize = 15,
+        PacketSize = PayloadSize + 5
+    };
+
+    struct Stats
+    {
+        quint64 packets;        // 校验通过的包
+        quint64 crcErrors;      // 帧头帧尾正确但 CRC 错误
+        quint64 framingErrors;  // 帧尾错误
+        quint64 discarded;      // 重新同步时丢弃的字节
+    };
+
+    PacketFramer();
+
+    // 追加收到的数据，解出的完整包追加到 out，返回解出的包数
+    int feed(const char *data, int size, QVector<StageStatus> &out);
+
+    // 丢弃未完成的半包，统计保留
+    void reset() { m_length = 0; }
+
+    const Stats& stats() const { return m_stats; }
+    void resetStats();
+
+    // 检查一个完整包的帧头、帧尾与 CRC
+    static bool validate(const uchar *packet);
+    static StageStatus decode(const uchar *packet);
+
+private:
+    void resync();
+
+    uchar m_buffer[PacketSize];
+    int   m_length;
+    Stats m_stats;
+};
+
+#endif // PACKETFRAMER_H
@@ -0,0 +1,127 @@
+#include <cmath>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QWheelEvent>
+#include "previewview.h"
+#include "profiler.h"
+
+PreviewView::PreviewView(QGraphicsScene *scene, QWidget *parent)
+    : QGraphicsView(scene, parent)
+    , m_zoom(1.0), m_maxZoom(1.0), m_panning(false)
+{
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+}
+
+void PreviewView::setFrame(const QImage &image, const QRectF &region)
+{
+    // 只保留最新一帧的引用，上一帧的缓冲交还采集线程
+    m_frame = image;
+    m_region = region;
+    viewport()->update();
+}
+
+void PreviewView::setMaxZoom(double zoom)
+{
+    m_maxZoom = qMax(1.0, zoom);
+}
+
+void PreviewView::fitToWindow()
+{
+    resetTransform();
+    m_zoom = 1.0;
+    emit viewChanged();
+}
+
+QRectF PreviewView::visibleSceneRect() const
+{
+    return mapToScene(viewport()->rect()).boundingRect() & sceneRect();
+}
+
+void PreviewView::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawBackground(painter, rect);
+    if (m_frame.isNull())
+        return;
+
+    // 预览图已按可见区域裁剪并缩小到屏幕尺寸，这里接近 1:1 拷贝；放大超过传感器像素时按最近邻放大
+    ProfileScope scope(Profiler::Paint);
+    QRectF bounds = sceneRect();
+    QRectF target(bounds.left() + m_region.x() * bounds.width(), bounds.top() + m_region.y() * bounds.height(),
+                  m_region.width() * bounds.width(), m_region.height() * bounds.height());
+    painter->drawImage(target, m_frame);
+}
+
+void PreviewView::scrollContentsBy(int dx, int dy)
+{
+    QGraphicsView::scrollContentsBy(dx, dy);
+    emit viewChanged();
+}
+
+void PreviewView::wheelEvent(QWheelEvent *event)
+{
+    // 一格(120)约 1.2 倍，最小为适应窗口
+    double zoom = qBound(1.0, m_zoom * std::pow(1.0015, event->angleDelta().y()), m_maxZoom);
+    if (zoom <= 1.0)
+    {
+        fitToWindow();
+    }
+    else
+    {
+        scale(zoom / m_zoom, zoom / m_zoom);
+        m_zoom = zoom;
+        emit viewChanged();
+    }
+    event->accept();
+}
+
+void PreviewView::mousePressEvent(QMouseEvent *event)
+{
+    // 左键留给叠加矩形与测量线
+    if (Qt::MiddleButton != event->button())
+    {
+        QGraphicsView::mousePressEvent(event);
+        return;
+    }
+    m_panning = true;
+    m_panStart = event->pos();
+    viewport()->setCursor(Qt::ClosedHandCursor);
+    event->accept();
+}
+
+void PreviewView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_panning)
+    {
+        QGraphicsView::mouseMoveEvent(event);
+        return;
+    }
+    QPoint delta = event->pos() - m_panStart;
+    m_panStart = event->pos();
+    horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta.x());
+    verticalScrollBar()->setValue(verticalScrollBar()->value() - delta.y());
+    event->accept();
+}
+
+void PreviewView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (!m_panning || Qt::MiddleButton != event->button())
+    {
+        QGraphicsView::mouseReleaseEvent(event);
+        return;
+    }
+    m_panning = false;
+    viewport()->unsetCursor();
+    event->accept();
+}
+
+void PreviewView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if (Qt::MiddleButton != event->button())
+    {
+        QGraphicsView::mouseDoubleClickEvent(event);
+        return;
+    }
+    fitToWindow();
+    event->accept();
+}
@@ -0,0 +1,52 @@
+#ifndef PREVIEWVIEW_H
+#define PREVIEWVIEW_H
+
+#include <QGraphicsView>
+#include <QImage>
+
+// 实时预览视图
+// 预览帧不是场景中的图元，而是在 drawBackground 中直接绘制到窗口：新帧到达只重绘视口，
+// 场景索引与叠加图元(AE/AWB/ABB 矩形、测量线、位移台坐标)不因此失效。叠加图元应使用 DeviceCoordinateCache，
+// 重绘时只是贴上缓存，只有图元本身改变时才重新绘制。
+// 场景坐标为适应窗口时的预览坐标；滚轮以光标为中心缩放，中键拖动平移，中键双击恢复适应窗口
+class PreviewView : public QGraphicsView
+{
+    Q_OBJECT
+
+public:
+    explicit PreviewView(QGraphicsScene *scene, QWidget *parent = nullptr);
+
+    // region 为 image 覆盖的传感器区域(相对整个视野归一化)；Format_RGB32 的图像绘制时不需要转换
+    void setFrame(const QImage &image, const QRectF &region);
+
+    // 相对适应窗口的放大倍数
+    double zoom() const { return m_zoom; }
+    void setMaxZoom(double zoom);
+    void fitToWindow();
+
+    // 视图中可见的场景区域
+    QRectF visibleSceneRect() const;
+
+signals:
+    // 缩放或平移后发出
+    void viewChanged();
+
+protected:
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    QImage  m_frame;
+    QRectF  m_region;
+    double  m_zoom;
+    double  m_maxZoom;
+    bool    m_panning;
+    QPoint  m_panStart;
+};
+
+#endif // PREVIEWVIEW_H
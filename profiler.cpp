@@ -0,0 +1,192 @@
+#include <QFile>
+#include <QTextStream>
+#include "profiler.h"
+
+namespace
+{
+
+// 每个线程一个小整数编号，作为 trace 中的 tid
+quint32 currentThreadId()
+{
+    static std::atomic<quint32> nextId(1);
+    thread_local quint32 id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+const char* Profiler::stageName(Stage stage)
+{
+    switch (stage)
+    {
+    case Callback:  return "callback";
+    case Pull:      return "pull";
+    case Scale:     return "scale";
+    case Deliver:   return "deliver";
+    case Paint:     return "paint";
+    case Encode:    return "encode";
+    case Write:     return "write";
+    case SerialSend:    return "serial send";
+    case SerialJitter:  return "serial jitter";
+    default:        return "unknown";
+    }
+}
+
+Profiler::Profiler()
+    : m_enabled(true), m_trace(new TraceEvent[TraceCapacity]), m_traceIndex(0)
+{
+    reset();
+}
+
+int Profiler::bucketIndex(quint64 value)
+{
+    if (value < SubBuckets)
+        return int(value);
+
+    // 最高位所在的倍程 + 其后 3 位作为档位
+    int exponent = 0;
+    for (quint64 v = value; v >>= 1; )
+        ++exponent;
+    int index = (exponent - 2) * SubBuckets + int((value >> (exponent - 3)) & (SubBuckets - 1));
+    return qMin(index, int(BucketCount) - 1);
+}
+
+qint64 Profiler::bucketValue(int index)
+{
+    // 返回档位中点
+    if (index < SubBuckets)
+        return index;
+    int exponent = index / SubBuckets + 2;
+    qint64 lower = qint64(SubBuckets + index % SubBuckets) << (exponent - 3);
+    return lower + (qint64(1) << (exponent - 3)) / 2;
+}
+
+void Profiler::record(Stage stage, qint64 start, qint64 end)
+{
+    if (!isEnabled() || stage < 0 || stage >= StageCount)
+        return;
+
+    qint64 duration = qMax(Q_INT64_C(0), end - start);
+    Histogram& histogram = m_histograms[stage];
+    histogram.buckets[bucketIndex(quint64(duration))].fetch_add(1, std::memory_order_relaxed);
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.sum.fetch_add(quint64(duration), std::memory_order_relaxed);
+    qint64 max = histogram.max.load(std::memory_order_relaxed);
+    while (duration > max && !histogram.max.compare_exchange_weak(max, duration, std::memory_order_relaxed))
+        ;
+
+    // 事件环写满后覆盖最旧的事件；stamp 最后写入，导出时据此跳过正在写的槽位
+    quint64 index = m_traceIndex.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = m_trace[index % TraceCapacity];
+    event.stamp.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.stage.store(quint32(stage), std::memory_order_relaxed);
+    event.thread.store(currentThreadId(), std::memory_order_relaxed);
+    event.stamp.store(index + 1, std::memory_order_release);
+}
+
+qint64 Profiler::percentile(const Histogram &histogram, quint64 count, double fraction) const
+{
+    quint64 target = quint64(count * fraction);
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i)
+    {
+        seen += histogram.buckets[i].load(std::memory_order_relaxed);
+        if (seen > target)
+            return bucketValue(i);
+    }
+    return histogram.max.load(std::memory_order_relaxed);
+}
+
+Profiler::Stats Profiler::stats(Stage stage) const
+{
+    const Histogram& histogram = m_histograms[stage];
+    Stats stats;
+    stats.count = histogram.count.load(std::memory_order_relaxed);
+    stats.max = histogram.max.load(std::memory_order_relaxed);
+    stats.mean = stats.count ? qint64(histogram.sum.load(std::memory_order_relaxed) / stats.count) : 0;
+    stats.p50 = stats.count ? qMin(percentile(histogram, stats.count, 0.50), stats.max) : 0;
+    stats.p99 = stats.count ? qMin(percentile(histogram, stats.count, 0.99), stats.max) : 0;
+    return stats;
+}
+
+void Profiler::reset()
+{
+    for (int s = 0; s < StageCount; ++s)
+    {
+        Histogram& histogram = m_histograms[s];
+        for (int i = 0; i < BucketCount; ++i)
+            histogram.buckets[i].store(0, std::memory_order_relaxed);
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.sum.store(0, std::memory_order_relaxed);
+        histogram.max.store(0, std::memory_order_relaxed);
+    }
+    for (int i = 0; i < TraceCapacity; ++i)
+        m_trace[i].stamp.store(0, std::memory_order_relaxed);
+    m_traceIndex.store(0, std::memory_order_release);
+}
+
+bool Profiler::exportCsv(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "stage,count,p50_us,p99_us,max_us,mean_us\n";
+    for (int s = 0; s < StageCount; ++s)
+    {
+        Stats st = stats(Stage(s));
+        out << stageName(Stage(s)) << "," << st.count << ","
+            << QString::number(st.p50 / 1000.0, 'f', 3) << ","
+            << QString::number(st.p99 / 1000.0, 'f', 3) << ","
+            << QString::number(st.max / 1000.0, 'f', 3) << ","
+            << QString::number(st.mean / 1000.0, 'f', 3) << "\n";
+    }
+    return true;
+}
+
+bool Profiler::exportTrace(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    // Trace Event Format，完整事件(ph = X)，时间单位 us
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    quint64 end = m_traceIndex.load(std::memory_order_acquire);
+    quint64 begin = end > quint64(TraceCapacity) ? end - TraceCapacity : 0;
+    bool first = true;
+    for (quint64 index = begin; index < end; ++index)
+    {
+        // 先复制再确认 stamp 未变，复制期间被覆盖的事件丢弃
+        const TraceEvent& event = m_trace[index % TraceCapacity];
+        if (event.stamp.load(std::memory_order_acquire) != index + 1)
+            continue;
+        qint64 start = event.start.load(std::memory_order_relaxed);
+        qint64 duration = event.duration.load(std::memory_order_relaxed);
+        quint32 stage = event.stage.load(std::memory_order_relaxed);
+        quint32 thread = event.thread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (event.stamp.load(std::memory_order_relaxed) != index + 1)
+            continue;
+
+        if (!first)
+            out << ",";
+        first = false;
+        out << "\n{\"name\":\"" << stageName(Stage(stage)) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+            << ",\"ts\":" << QString::number(start / 1000.0, 'f', 3)
+            << ",\"dur\":" << QString::number(duration / 1000.0, 'f', 3) << "}";
+    }
+    out << "\n]}\n";
+    return true;
+}
@@ -0,0 +1,107 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <QString>
+#include "frame.h"
+
+// 帧处理链路各阶段的耗时统计
+// 每个阶段一个无锁对数直方图(每倍程 8 档，相对误差约 6%)，采集线程、GUI 线程、录像线程可并发记录；
+// 另有一个定长事件环保存最近的事件，用于导出 Chrome trace (chrome://tracing / Perfetto)
+class Profiler
+{
+public:
+    enum Stage
+    {
+        Callback,       // SDK 回调总耗时
+        Pull,           // PullImageV3 / 推送模式拷贝
+        Scale,          // 生成缩小的预览图
+        Deliver,        // 帧到达回调 -> GUI 线程取到帧
+        Paint,          // 预览帧绘制到窗口
+        Encode,         // 录像颜色转换
+        Write,          // 录像编码(VideoWriter)并写文件
+        SerialSend,     // 产生串口指令 -> 串口线程写出
+        SerialJitter,   // 保活发送间隔与设定周期之差
+        StageCount
+    };
+
+    struct Stats
+    {
+        quint64 count;
+        qint64  p50;    // ns
+        qint64  p99;
+        qint64  max;
+        qint64  mean;
+    };
+
+    static Profiler& instance();
+    static const char* stageName(Stage stage);
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    // 记录一次耗时，start/end 为 frameClockNs() 的值
+    void record(Stage stage, qint64 start, qint64 end);
+
+    Stats stats(Stage stage) const;
+    // 不应与 record() 并发调用: 清零期间记录的计数与事件可能部分保留(都是原子操作，不会破坏数据)
+    // 需要精确清零时(基准测试)在没有线程记录时调用；诊断窗口在采集过程中重置，之后的统计只是近似
+    void reset();
+
+    bool exportCsv(const QString &fileName) const;
+    bool exportTrace(const QString &fileName) const;
+
+private:
+    enum
+    {
+        SubBuckets = 8,
+        BucketCount = 320,          // 覆盖到约 2^40 ns
+        TraceCapacity = 65536
+    };
+
+    struct Histogram
+    {
+        std::atomic<quint64> buckets[BucketCount];
+        std::atomic<quint64> count;
+        std::atomic<quint64> sum;
+        std::atomic<qint64>  max;
+    };
+
+    // 顺序锁: 写入前 stamp 置 0，写完后置为序号 + 1；导出时复制字段后再读一次 stamp，变化则丢弃
+    // 字段也用原子变量(relaxed 访问)，与写入并发读取时不构成数据竞争
+    struct TraceEvent
+    {
+        std::atomic<quint64> stamp;     // 写入序号 + 1，0 表示空
+        std::atomic<qint64>  start;
+        std::atomic<qint64>  duration;
+        std::atomic<quint32> stage;
+        std::atomic<quint32> thread;
+    };
+
+    Profiler();
+    Profiler(const Profiler&);
+    Profiler& operator=(const Profiler&);
+
+    static int bucketIndex(quint64 value);
+    static qint64 bucketValue(int index);
+    qint64 percentile(const Histogram &histogram, quint64 count, double fraction) const;
+
+    std::atomic<bool>    m_enabled;
+    Histogram            m_histograms[StageCount];
+    TraceEvent*          m_trace;
+    std::atomic<quint64> m_traceIndex;
+};
+
+// 作用域计时
+class ProfileScope
+{
+public:
+    explicit ProfileScope(Profiler::Stage stage) : m_stage(stage), m_start(frameClockNs()) {}
+    ~ProfileScope() { Profiler::instance().record(m_stage, m_start, frameClockNs()); }
+
+private:
+    Profiler::Stage m_stage;
+    qint64          m_start;
+};
+
+#endif // PROFILER_H
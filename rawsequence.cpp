@@ -0,0 +1,355 @@
+#include <cstring>
+#include <QFileInfo>
+#include "rawsequence.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const char RawSequenceMagic[8] = { 'C', 'V', 'R', 'A', 'W', 'S', 'E', 'Q' };
+static const quint32 RawSequenceVersion = 2;
+
+// 版本 1 的记录不含位移台位置，是版本 2 记录的前缀
+static const quint32 RawFrameRecordSizeV1 = 72;
+
+static_assert(sizeof(RawFrameRecord) == 96, "RawFrameRecord layout must not change");
+
+struct RawSequenceHeader
+{
+    char    magic[8];
+    quint32 version;
+    quint32 recordSize;
+};
+
+QString rawSegmentFileName(const QString &fileName, int segment)
+{
+    QFileInfo info(fileName);
+    return info.path() + "/" + info.completeBaseName() + QString::asprintf("_%04d.raw", segment);
+}
+
+void removeRawSequence(const QString &fileName)
+{
+    QFile::remove(fileName);
+    for (int segment = 0; QFile::exists(rawSegmentFileName(fileName, segment)); ++segment)
+        QFile::remove(rawSegmentFileName(fileName, segment));
+}
+
+RawFrameRecord rawFrameRecord(const Frame &frame)
+{
+    RawFrameRecord record;
+    memset(&record, 0, sizeof(record));
+    record.width = frame.width();
+    record.height = frame.height();
+    record.stride = frame.stride();
+    record.bits = 24;
+    record.flag = frame.info().flag;
+    record.seq = frame.info().seq;
+    record.expoTime = frame.params().expoTime;
+    record.timestamp = frame.info().timestamp;
+    record.expoGain = frame.params().expoGain;
+    record.temp = frame.params().temp;
+    record.tint = frame.params().tint;
+    record.arrival = frame.arrival();
+    memcpy(record.stage, frame.params().stage, sizeof(record.stage));
+    record.stageSource = quint32(frame.params().stageSource);
+    return record;
+}
+
+void applyRawFrameRecord(Frame &frame, const RawFrameRecord &record)
+{
+    NncamFrameInfoV3 info;
+    memset(&info, 0, sizeof(info));
+    info.width = record.width;
+    info.height = record.height;
+    info.flag = record.flag;
+    info.seq = record.seq;
+    info.timestamp = record.timestamp;
+    info.expotime = record.expoTime;
+    info.expogain = record.expoGain;
+    frame.setInfo(info);
+
+    FrameParams params;
+    params.expoTime = record.expoTime;
+    params.expoGain = record.expoGain;
+    params.temp = record.temp;
+    params.tint = record.tint;
+    memcpy(params.stage, record.stage, sizeof(params.stage));
+    params.stageSource = int(record.stageSource);
+    frame.setParams(params);
+    frame.setArrival(record.arrival);
+}
+
+// 为分段真正分配磁盘空间
+// QFile::resize 在 Linux/macOS 上只产生稀疏文件，磁盘写满时映射内存的写入会触发 SIGBUS，
+// 必须在映射之前确认空间已经分配
+static bool preallocate(QFile &file, qint64 bytes)
+{
+    int fd = file.handle();
+    if (fd < 0)
+        return false;
+#if defined(_WIN32)
+    // NTFS 上 SetEndOfFile 会分配簇(非稀疏文件)，空间不足时失败
+    HANDLE handle = HANDLE(_get_osfhandle(fd));
+    LARGE_INTEGER size;
+    size.QuadPart = bytes;
+    return INVALID_HANDLE_VALUE != handle
+        && SetFilePointerEx(handle, size, nullptr, FILE_BEGIN)
+        && SetEndOfFile(handle);
+#elif defined(__APPLE__)
+    fstore_t store;
+    memset(&store, 0, sizeof(store));
+    store.fst_flags = F_ALLOCATEALL;
+    store.fst_posmode = F_PEOFPOSMODE;
+    store.fst_length = bytes;
+    if (-1 == fcntl(fd, F_PREALLOCATE, &store))
+        return false;
+    return 0 == ftruncate(fd, off_t(bytes));
+#else
+    return 0 == posix_fallocate(fd, 0, off_t(bytes));
+#endif
+}
+
+RawSequenceWriter::RawSequenceWriter()
+    : m_segmentBytes(DefaultSegmentBytes), m_map(nullptr), m_offset(0), m_segmentIndex(-1)
+    , m_frames(0), m_bytes(0)
+{
+}
+
+RawSequenceWriter::~RawSequenceWriter()
+{
+    close();
+}
+
+bool RawSequenceWriter::open(const QString &fileName, qint64 segmentBytes)
+{
+    close();
+
+    m_fileName = fileName;
+    m_segmentBytes = segmentBytes;
+    m_frames = 0;
+    m_bytes = 0;
+
+    m_index.setFileName(fileName);
+    if (!m_index.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    RawSequenceHeader header;
+    memcpy(header.magic, RawSequenceMagic, sizeof(header.magic));
+    header.version = RawSequenceVersion;
+    header.recordSize = sizeof(RawFrameRecord);
+    m_index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!openSegment(0))
+    {
+        m_index.close();
+        return false;
+    }
+    return true;
+}
+
+bool RawSequenceWriter::openSegment(int segment)
+{
+    // 预先为分段分配最终大小的磁盘空间并整体映射，写帧时只做顺序内存拷贝
+    // 空间不足时在这里失败，而不是在拷贝时
+    m_segment.setFileName(rawSegmentFileName(m_fileName, segment));
+    if (!m_segment.open(QIODevice::ReadWrite | QIODevice::Truncate))
+        return false;
+    if (!preallocate(m_segment, m_segmentBytes))
+    {
+        m_segment.close();
+        m_segment.remove();
+        return false;
+    }
+    m_map = m_segment.map(0, m_segmentBytes);
+    if (!m_map)
+    {
+        m_segment.close();
+        m_segment.remove();
+        return false;
+    }
+    m_segmentIndex = segment;
+    m_offset = 0;
+    return true;
+}
+
+void RawSequenceWriter::closeSegment()
+{
+    if (m_map)
+    {
+        m_segment.unmap(m_map);
+        m_map = nullptr;
+    }
+    if (m_segment.isOpen())
+    {
+        // 截掉未使用的预分配空间
+        m_segment.resize(m_offset);
+        m_segment.close();
+    }
+}
+
+bool RawSequenceWriter::write(const Frame &frame)
+{
+    if (!m_map || frame.isNull())
+        return false;
+
+    qint64 bytes = qint64(frame.byteCount());
+    if (bytes > m_segmentBytes)
+        return false;
+
+    if (m_offset + bytes > m_segmentBytes)
+    {
+        closeSegment();
+        if (!openSegment(m_segmentIndex + 1))
+            return false;
+    }
+
+    memcpy(m_map + m_offset, frame.data(), size_t(bytes));
+
+    RawFrameRecord record = rawFrameRecord(frame);
+    record.segment = quint32(m_segmentIndex);
+    record.offset = quint64(m_offset);
+    m_index.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+    m_offset += bytes;
+    m_bytes += quint64(bytes);
+    ++m_frames;
+    return true;
+}
+
+void RawSequenceWriter::close()
+{
+    closeSegment();
+    if (m_index.isOpen())
+        m_index.close();
+}
+
+RawSequenceReader::RawSequenceReader()
+{
+}
+
+RawSequenceReader::~RawSequenceReader()
+{
+    close();
+}
+
+bool RawSequenceReader::open(const QString &fileName)
+{
+    close();
+
+    QFile index(fileName);
+    if (!index.open(QIODevice::ReadOnly))
+        return false;
+
+    RawSequenceHeader header;
+    if (index.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header))
+        || memcmp(header.magic, RawSequenceMagic, sizeof(header.magic)) != 0
+        || !((1 == header.version && RawFrameRecordSizeV1 == header.recordSize)
+             || (RawSequenceVersion == header.version && sizeof(RawFrameRecord) == header.recordSize)))
+        return false;
+
+    // 录制中断时最后一条记录可能不完整，忽略
+    qint64 recordSize = header.recordSize;
+    int count = int((index.size() - qint64(sizeof(header))) / recordSize);
+    qint64 bytes = qint64(count) * recordSize;
+    if (qint64(sizeof(RawFrameRecord)) == recordSize)
+    {
+        m_records.resize(count);
+        if (index.read(reinterpret_cast<char*>(m_records.data()), bytes) != bytes)
+        {
+            m_records.clear();
+            return false;
+        }
+    }
+    else
+    {
+        // 旧版本记录逐条读入，缺少的字段为 0
+        QByteArray data = index.read(bytes);
+        if (data.size() != bytes)
+            return false;
+        m_records.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            memset(&m_records[i], 0, sizeof(RawFrameRecord));
+            memcpy(&m_records[i], data.constData() + qint64(i) * recordSize, size_t(recordSize));
+        }
+    }
+
+    // 分段从 0 开始连续编号，记录引用的分段不能超出实际存在的分段
+    int segments = 0;
+    while (QFile::exists(rawSegmentFileName(fileName, segments)))
+        ++segments;
+    m_segments.fill(nullptr, segments);
+    m_maps.fill(nullptr, segments);
+
+    m_fileName = fileName;
+    return true;
+}
+
+void RawSequenceReader::close()
+{
+    for (int i = 0; i < m_segments.size(); ++i)
+    {
+        if (m_maps[i])
+            m_segments[i]->unmap(m_maps[i]);
+        delete m_segments[i];
+    }
+    m_segments.clear();
+    m_maps.clear();
+    m_records.clear();
+}
+
+const uchar* RawSequenceReader::segmentData(int segment)
+{
+    if (segment < 0 || segment >= m_segments.size())
+        return nullptr;
+
+    // 分段在第一次访问时才映射
+    if (!m_segments[segment])
+    {
+        QFile* file = new QFile(rawSegmentFileName(m_fileName, segment));
+        uchar* map = nullptr;
+        if (file->open(QIODevice::ReadOnly))
+            map = file->map(0, file->size());
+        m_segments[segment] = file;
+        m_maps[segment] = map;
+    }
+    return m_maps[segment];
+}
+
+const uchar* RawSequenceReader::frameData(int index)
+{
+    if (index < 0 || index >= m_records.size())
+        return nullptr;
+
+    // 索引来自磁盘，可能损坏: 分段号、偏移与尺寸都须落在已打开的分段文件内
+    const RawFrameRecord& record = m_records.at(index);
+    if (record.segment >= quint32(m_segments.size()) || 0 == record.width || 0 == record.height
+        || record.stride != quint32(TDIBWIDTHBYTES(quint64(record.width) * 24)))
+        return nullptr;
+    const uchar* data = segmentData(int(record.segment));
+    quint64 size = data ? quint64(m_segments[int(record.segment)]->size()) : 0;
+    quint64 bytes = quint64(record.stride) * record.height;
+    if (!data || bytes > size || record.offset > size - bytes)
+        return nullptr;
+    return data + record.offset;
+}
+
+Frame RawSequenceReader::readFrame(int index)
+{
+    const uchar* data = frameData(index);
+    if (!data)
+        return Frame();
+
+    const RawFrameRecord& record = m_records.at(index);
+    Frame frame = Frame::allocate(record.width, record.height);
+    if (frame.stride() != record.stride)
+        return Frame();
+    memcpy(frame.bits(), data, frame.byteCount());
+
+    applyRawFrameRecord(frame, record);
+    return frame;
+}
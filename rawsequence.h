@@ -0,0 +1,105 @@
+#ifndef RAWSEQUENCE_H
+#define RAWSEQUENCE_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include "frame.h"
+
+// 无损原始帧序列
+// 索引文件(用户选择的 *.rawseq)保存文件头和每帧的定长元数据记录，
+// 像素按顺序写入若干预分配(真正占用磁盘空间)并内存映射的分段文件 <name>_0000.raw, <name>_0001.raw ...，
+// 分段写满后切换到下一个分段
+struct RawFrameRecord
+{
+    quint32 segment;        // 分段序号
+    quint32 width;
+    quint32 height;
+    quint32 stride;
+    quint64 offset;         // 分段内的字节偏移
+    quint32 bits;           // 24 = RGB24
+    quint32 flag;           // NNCAM_FRAMEINFO_FLAG_xxxx
+    quint32 seq;
+    quint32 expoTime;
+    quint64 timestamp;      // 传感器时间戳(us)
+    quint16 expoGain;
+    quint16 reserved0;
+    qint32  temp;
+    qint32  tint;
+    quint32 reserved1;
+    qint64  arrival;        // 主机到达时间(ns)
+    // 版本 2 起
+    qint32  stage[5];       // 位移台 T/R/X/Y/Z 位置(步)
+    quint32 stageSource;    // StageModel::Source，0 表示没有位置信息
+};
+
+class RawSequenceWriter
+{
+public:
+    static const qint64 DefaultSegmentBytes = Q_INT64_C(2) * 1024 * 1024 * 1024;
+
+    RawSequenceWriter();
+    ~RawSequenceWriter();
+
+    bool open(const QString &fileName, qint64 segmentBytes = DefaultSegmentBytes);
+    bool write(const Frame &frame);
+    void close();
+
+    bool isOpen() const { return m_index.isOpen(); }
+    quint64 frameCount() const { return m_frames; }
+    quint64 bytesWritten() const { return m_bytes; }
+
+private:
+    bool openSegment(int segment);
+    void closeSegment();
+
+    QString m_fileName;
+    qint64  m_segmentBytes;
+    QFile   m_index;
+    QFile   m_segment;
+    uchar*  m_map;
+    qint64  m_offset;
+    int     m_segmentIndex;
+    quint64 m_frames;
+    quint64 m_bytes;
+};
+
+class RawSequenceReader
+{
+public:
+    RawSequenceReader();
+    ~RawSequenceReader();
+
+    bool open(const QString &fileName);
+    void close();
+
+    int frameCount() const { return m_records.size(); }
+    const RawFrameRecord& record(int index) const { return m_records.at(index); }
+
+    // 按序号随机读取一帧，返回带元数据的自有内存帧
+    Frame readFrame(int index);
+
+    // 第 index 帧在分段映射中的像素(按 record 的宽高与 stride)，不复制；
+    // 记录无效时返回 nullptr，指针在 close() 之前有效
+    const uchar* frameData(int index);
+
+private:
+    const uchar* segmentData(int segment);
+
+    QString                 m_fileName;
+    QVector<RawFrameRecord> m_records;
+    QVector<QFile*>         m_segments;
+    QVector<uchar*>         m_maps;
+};
+
+// 分段文件名
+QString rawSegmentFileName(const QString &fileName, int segment);
+
+// 删除索引文件与全部分段
+void removeRawSequence(const QString &fileName);
+
+// 帧元数据与定长记录之间的转换，segment/offset 由调用者填写
+RawFrameRecord rawFrameRecord(const Frame &frame);
+void applyRawFrameRecord(Frame &frame, const RawFrameRecord &record);
+
+#endif // RAWSEQUENCE_H
@@ -0,0 +1,173 @@
+#include <cmath>
+#include "recordthread.h"
+#include "profiler.h"
+
+// 两帧之间最多补齐的重复帧数(秒)，避免相机暂停后生成大量重复帧
+static const double MaxGapSeconds = 2.0;
+
+recordThread::recordThread(int maxQueue, QObject *parent)
+    : QThread(parent), rawMode(false), timingMode(ConstantFrameRate), frameRate(10.0), firstTimeUs(-1), nextIndex(0)
+    , maxQueue(maxQueue), stopping(false), written(0), dropped(0), duplicated(0), skipped(0)
+{
+}
+
+recordThread::~recordThread()
+{
+    stop();
+    wait();
+}
+
+bool recordThread::open(const QString &fileName, double fps, unsigned width, unsigned height, TimingMode mode)
+{
+    frameRate = fps > 0 ? fps : 10.0;
+    timingMode = mode;
+    firstTimeUs = -1;
+    nextIndex = 0;
+    frameSize = cv::Size(int(width), int(height));
+    // writer.open(fileName.toStdString(), cv::VideoWriter::fourcc('X','2','6','4'), fps, frameSize, true);  // .mp4 .mkv
+    writer.open(fileName.toStdString(), cv::VideoWriter::fourcc('M','J','P','G'), frameRate, frameSize, true);  // .avi .mov
+    // writer.open(fileName.toStdString(), cv::VideoWriter::fourcc('X','V','I','D'), fps, frameSize, true);  // .avi .mp4 .mkv
+    if (!writer.isOpened())
+        return false;
+
+    // 可变帧率: 写出 mkvmerge 可用的逐帧时间戳文件
+    if (VariableFrameRate == timingMode)
+    {
+        timestampFile.setFileName(fileName + ".timestamps.txt");
+        if (!timestampFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            writer.release();
+            return false;
+        }
+        timestampStream.setDevice(&timestampFile);
+        timestampStream << "# timestamp format v2\n";
+    }
+    return true;
+}
+
+bool recordThread::openRaw(const QString &fileName, qint64 segmentBytes)
+{
+    rawMode = true;
+    return rawWriter.open(fileName, segmentBytes);
+}
+
+bool recordThread::enqueue(const Frame &frame)
+{
+    QMutexLocker locker(&mutex);
+    if (stopping || queue.size() >= maxQueue)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    queue.enqueue(frame);
+    notEmpty.wakeOne();
+    return true;
+}
+
+void recordThread::stop()
+{
+    QMutexLocker locker(&mutex);
+    stopping = true;
+    notEmpty.wakeOne();
+}
+
+int recordThread::queueDepth()
+{
+    QMutexLocker locker(&mutex);
+    return queue.size();
+}
+
+void recordThread::run()
+{
+    for (;;)
+    {
+        Frame frame;
+        {
+            QMutexLocker locker(&mutex);
+            while (queue.isEmpty() && !stopping)
+                notEmpty.wait(&mutex);
+            if (queue.isEmpty())
+                break;
+            frame = queue.dequeue();
+        }
+        writeFrame(frame);
+    }
+    writer.release();
+    rawWriter.close();
+    if (timestampFile.isOpen())
+    {
+        timestampStream.flush();
+        timestampFile.close();
+    }
+}
+
+qint64 recordThread::frameTimeUs(const Frame &frame)
+{
+    if (frame.timestamp())
+        return qint64(frame.timestamp());
+    return frame.arrival() / 1000;
+}
+
+void recordThread::writeFrame(const Frame &frame)
+{
+    // 原始序列保留每一帧及其时间戳，不做帧率对齐
+    if (rawMode)
+    {
+        ProfileScope scope(Profiler::Write);
+        if (rawWriter.write(frame))
+            written.fetch_add(1, std::memory_order_relaxed);
+        else
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // 分辨率与文件不一致的帧无法写入
+    if (int(frame.width()) != frameSize.width || int(frame.height()) != frameSize.height)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    qint64 timeUs = frameTimeUs(frame);
+    if (firstTimeUs < 0)
+        firstTimeUs = timeUs;
+    qint64 elapsedUs = timeUs - firstTimeUs;
+
+    if (ConstantFrameRate == timingMode)
+    {
+        // 该帧在固定帧率时间轴上的位置
+        qint64 index = qint64(std::llround(elapsedUs * frameRate / 1000000.0));
+        if (index < nextIndex)
+        {
+            skipped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // 缺失的位置重复上一帧
+        qint64 maxGap = qint64(MaxGapSeconds * frameRate);
+        qint64 gap = index - nextIndex;
+        if (nextIndex > 0 && gap > 0)
+        {
+            for (qint64 i = 0; i < qMin(gap, maxGap); ++i)
+            {
+                writer.write(bgr);
+                duplicated.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        nextIndex = index + 1;
+    }
+    else
+    {
+        timestampStream << QString::number(elapsedUs / 1000.0, 'f', 3) << "\n";
+    }
+
+    cv::Mat rgb(frameSize, CV_8UC3, const_cast<uchar*>(frame.data()), frame.stride());
+    qint64 start = frameClockNs();
+    cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
+    qint64 encoded = frameClockNs();
+    writer.write(bgr);
+    Profiler& profiler = Profiler::instance();
+    profiler.record(Profiler::Encode, start, encoded);
+    profiler.record(Profiler::Write, encoded, frameClockNs());
+    written.fetch_add(1, std::memory_order_relaxed);
+}
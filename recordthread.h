@@ -0,0 +1,79 @@
+#ifndef RECORDTHREAD_H
+#define RECORDTHREAD_H
+#include <atomic>
+#include <opencv2/opencv.hpp>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QString>
+#include <QFile>
+#include <QTextStream>
+#include "frame.h"
+#include "rawsequence.h"
+
+// 录像编码线程: GUI 线程只把 Frame 句柄放入有界队列，编码与写文件在本线程完成
+class recordThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum TimingMode
+    {
+        ConstantFrameRate,  // 按帧时间戳对齐到固定帧率，缺帧重复上一帧，多余的帧丢弃
+        VariableFrameRate   // 每帧只写一次，另存逐帧时间戳文件(timestamp format v2)
+    };
+
+    explicit recordThread(int maxQueue = 2, QObject *parent = nullptr);
+    ~recordThread();
+
+    // fps 为实测采集帧率，作为容器的标称帧率
+    bool open(const QString &fileName, double fps, unsigned width, unsigned height, TimingMode mode = ConstantFrameRate);
+
+    // 无损录制: 原始 RGB24 帧与逐帧元数据写入预分配的分段文件
+    bool openRaw(const QString &fileName, qint64 segmentBytes = RawSequenceWriter::DefaultSegmentBytes);
+
+    // 非阻塞入队，队列已满时丢弃该帧并计数
+    bool enqueue(const Frame &frame);
+
+    // 停止接收新帧，编码完队列中剩余的帧后关闭文件
+    void stop();
+
+    int queueDepth();
+    quint64 writtenCount() const { return written.load(std::memory_order_relaxed); }
+    quint64 droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    quint64 duplicatedCount() const { return duplicated.load(std::memory_order_relaxed); }
+    quint64 skippedCount() const { return skipped.load(std::memory_order_relaxed); }
+
+protected:
+    void run() override;
+
+private:
+    void writeFrame(const Frame &frame);
+
+    // 帧时间(us)，优先使用传感器时间戳
+    static qint64 frameTimeUs(const Frame &frame);
+
+    cv::VideoWriter writer;
+    RawSequenceWriter rawWriter;
+    bool rawMode;
+    cv::Mat bgr;
+    cv::Size frameSize;
+    TimingMode timingMode;
+    double frameRate;
+    qint64 firstTimeUs;
+    qint64 nextIndex;
+    QFile timestampFile;
+    QTextStream timestampStream;
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QQueue<Frame> queue;
+    int maxQueue;
+    bool stopping;
+    std::atomic<quint64> written;
+    std::atomic<quint64> dropped;
+    std::atomic<quint64> duplicated;
+    std::atomic<quint64> skipped;
+};
+
+#endif // RECORDTHREAD_H
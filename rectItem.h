@@ -16,6 +16,8 @@ public:
     explicit RectItem(QGraphicsItem* parent = nullptr)
         : QGraphicsRectItem(parent), resizing(false), moving(false) {
         setFlags(QGraphicsItem::ItemIsSelectable | QGraphicsItem::ItemIsMovable);
+        // 预览每帧重绘视口，矩形本身不变时只贴缓存
+        setCacheMode(QGraphicsItem::DeviceCoordinateCache);
     }
 
     void initRect(float left, float top, float right, float bottom, int width, int height)
@@ -0,0 +1,107 @@
+#include <QBrush>
+#include <QDateTime>
+#include "seriallogmodel.h"
+
+SerialLogModel::SerialLogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_ring(qMax(1, capacity))
+    , m_head(0)
+    , m_count(0)
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FlushInterval);
+    connect(m_flushTimer, &QTimer::timeout, this, &SerialLogModel::flush);
+}
+
+void SerialLogModel::append(Kind kind, const QString &text)
+{
+    // 视图来不及刷新时待处理队列也只保留最近 capacity 条
+    if (m_pending.size() >= m_ring.size())
+        m_pending.removeFirst();
+
+    Entry e;
+    e.time = QDateTime::currentMSecsSinceEpoch();
+    e.kind = kind;
+    e.text = text;
+    m_pending.append(e);
+
+    if (!m_flushTimer->isActive())
+        m_flushTimer->start();
+}
+
+void SerialLogModel::clear()
+{
+    m_flushTimer->stop();
+    beginResetModel();
+    m_pending.clear();
+    m_head = 0;
+    m_count = 0;
+    endResetModel();
+}
+
+void SerialLogModel::flush()
+{
+    int n = m_pending.size();
+    if (0 == n)
+        return;
+
+    int capacity = m_ring.size();
+    if (n >= capacity)
+    {
+        // 一次就填满整个缓冲，直接重置
+        beginResetModel();
+        for (int i = 0; i < capacity; ++i)
+            m_ring[i] = m_pending[n - capacity + i];
+        m_head = 0;
+        m_count = capacity;
+        endResetModel();
+    }
+    else
+    {
+        int overflow = m_count + n - capacity;
+        if (overflow > 0)
+        {
+            beginRemoveRows(QModelIndex(), 0, overflow - 1);
+            m_head = (m_head + overflow) % capacity;
+            m_count -= overflow;
+            endRemoveRows();
+        }
+
+        beginInsertRows(QModelIndex(), m_count, m_count + n - 1);
+        for (int i = 0; i < n; ++i)
+            m_ring[(m_head + m_count + i) % capacity] = m_pending[i];
+        m_count += n;
+        endInsertRows();
+    }
+    m_pending.clear();
+}
+
+int SerialLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant SerialLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count)
+        return QVariant();
+
+    const Entry& e = entry(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    {
+        static const char* const prefixes[] = { "", u8"发送：", u8"接收：", "" };
+        return QDateTime::fromMSecsSinceEpoch(e.time).toString("hh:mm:ss.zzz ") + QString::fromUtf8(prefixes[e.kind]) + e.text;
+    }
+    case Qt::ForegroundRole:
+        if (Error == e.kind)
+            return QBrush(Qt::red);
+        return QVariant();
+    case KindRole:
+        return int(e.kind);
+    default:
+        return QVariant();
+    }
+}
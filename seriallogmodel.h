@@ -0,0 +1,66 @@
+#ifndef SERIALLOGMODEL_H
+#define SERIALLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include <QVector>
+
+// 串口消息日志
+// 定长环形缓冲，写满后丢弃最早的消息；append 只写入待处理队列，由定时器合并后每秒刷新几次视图，
+// 配合 uniformItemSizes 的 QListView 只绘制可见行，消息再多界面开销也不增长
+class SerialLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Kind
+    {
+        Info,
+        Sent,
+        Received,
+        Error
+    };
+
+    enum Roles
+    {
+        KindRole = Qt::UserRole + 1
+    };
+
+    enum
+    {
+        DefaultCapacity = 5000,
+        FlushInterval = 250     // ms
+    };
+
+    explicit SerialLogModel(int capacity = DefaultCapacity, QObject *parent = nullptr);
+
+    void append(Kind kind, const QString &text);
+    void clear();
+
+    int capacity() const { return m_ring.size(); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+public slots:
+    // 把待处理的消息并入模型
+    void flush();
+
+private:
+    struct Entry
+    {
+        qint64  time;       // ms since epoch
+        Kind    kind;
+        QString text;
+    };
+
+    const Entry& entry(int row) const { return m_ring[(m_head + row) % m_ring.size()]; }
+
+    QVector<Entry> m_ring;
+    int            m_head;      // 最早一条消息的位置
+    int            m_count;
+    QVector<Entry> m_pending;
+    QTimer*        m_flushTimer;
+};
+
+#endif // SERIALLOGMODEL_H
@@ -0,0 +1,239 @@
+#include <cstring>
+#include <QtEndian>
+#include "frame.h"
+#include "profiler.h"
+#include "serialworker.h"
+
+SerialWorker::SerialWorker(QObject *parent)
+    : QObject(parent)
+    , m_port(new QSerialPort(this))
+    , m_keepAliveTimer(new QTimer(this))
+    , m_pulseTimer(new QTimer(this))
+    , m_stage(nullptr)
+    , m_keepAlivePeriod(0)
+    , m_lastSendNs(0)
+{
+    // 保活间隔只有几十毫秒，默认的 CoarseTimer 允许 5% 的误差
+    m_keepAliveTimer->setTimerType(Qt::PreciseTimer);
+    m_pulseTimer->setTimerType(Qt::PreciseTimer);
+    m_pulseTimer->setSingleShot(true);
+
+    // 未设置空闲指令时发送静止、未锁定的指令
+    MotionCommand().encode(m_idlePacket);
+    m_packet = m_idlePacket;
+    memset(&m_lastSent, 0, sizeof(m_lastSent));
+
+    connect(m_keepAliveTimer, &QTimer::timeout, this, &SerialWorker::keepAlive);
+    connect(m_pulseTimer, &QTimer::timeout, this, &SerialWorker::endPulse);
+    connect(m_port, &QSerialPort::readyRead, this, &SerialWorker::readData);
+    connect(m_port, &QSerialPort::bytesWritten, this, &SerialWorker::bytesWritten);
+    connect(m_port, &QSerialPort::errorOccurred, this, &SerialWorker::handleError);
+}
+
+SerialWorker::~SerialWorker()
+{
+    if (m_port->isOpen())
+        m_port->close();
+    if (m_dumpFile.isOpen())
+        m_dumpFile.close();
+}
+
+void SerialWorker::open(const QString &portName, qint32 baudRate)
+{
+    if (m_port->isOpen())
+        m_port->close();
+
+    m_port->setPortName(portName);
+    m_port->setBaudRate(baudRate);
+    m_port->setDataBits(QSerialPort::Data8);
+    m_port->setParity(QSerialPort::NoParity);
+    m_port->setStopBits(QSerialPort::OneStop);
+    m_port->setFlowControl(QSerialPort::NoFlowControl);
+
+    if (!m_port->open(QIODevice::ReadWrite))
+    {
+        emit opened(false, m_port->errorString());
+        return;
+    }
+
+    // 打开后先发送一次空闲指令，与原先定时发送的第一包一致
+    m_packet = m_idlePacket;
+    memset(&m_lastSent, 0, sizeof(m_lastSent));     // 全 0 不是有效的包，打开后的第一包总会报告
+    m_framer.reset();
+    m_framer.resetStats();
+    m_lastSendNs = 0;
+    send(frameClockNs());
+    if (m_keepAlivePeriod > 0)
+        m_keepAliveTimer->start(m_keepAlivePeriod);
+    emit opened(true, QString());
+}
+
+void SerialWorker::close()
+{
+    m_keepAliveTimer->stop();
+    m_pulseTimer->stop();
+    if (m_port->isOpen())
+    {
+        m_port->close();
+        emit closed();
+    }
+    bytesWritten();
+}
+
+void SerialWorker::setPacket(const MotionPacket &packet, qint64 requested)
+{
+    m_pulseTimer->stop();
+    m_packet = packet;
+    if (m_packet != m_lastSent)
+        send(requested);
+}
+
+void SerialWorker::setIdlePacket(const MotionPacket &packet)
+{
+    m_idlePacket = packet;
+}
+
+void SerialWorker::pulse(const MotionPacket &packet, int duration, qint64 requested)
+{
+    setPacket(packet, requested);
+    m_pulseTimer->start(duration);
+}
+
+void SerialWorker::setKeepAlive(int period)
+{
+    m_keepAlivePeriod = qMax(0, period);
+    if (m_keepAlivePeriod > 0 && m_port->isOpen())
+        m_keepAliveTimer->start(m_keepAlivePeriod);
+    else
+        m_keepAliveTimer->stop();
+}
+
+void SerialWorker::drain(int tag)
+{
+    m_drainTags.append(tag);
+    bytesWritten();
+}
+
+void SerialWorker::bytesWritten()
+{
+    if (m_drainTags.isEmpty() || (m_port->isOpen() && m_port->bytesToWrite() > 0))
+        return;
+
+    QVector<int> tags;
+    tags.swap(m_drainTags);
+    for (int tag : tags)
+        emit drained(tag);
+}
+
+void SerialWorker::keepAlive()
+{
+    // 实际间隔与设定周期之差记为抖动
+    qint64 now = frameClockNs();
+    if (m_lastSendNs > 0)
+    {
+        qint64 deviation = qAbs(now - m_lastSendNs - qint64(m_keepAlivePeriod) * 1000000);
+        Profiler::instance().record(Profiler::SerialJitter, now - deviation, now);
+    }
+    send(now, true);
+}
+
+void SerialWorker::endPulse()
+{
+    setPacket(m_idlePacket, frameClockNs());
+}
+
+void SerialWorker::send(qint64 requested, bool keepAlive)
+{
+    if (!m_port->isOpen())
+        return;
+
+    m_port->write(m_packet.data(), MotionPacket::size());
+    m_lastSendNs = frameClockNs();
+    Profiler::instance().record(Profiler::SerialSend, requested, m_lastSendNs);
+    dump(1, m_packet.data(), MotionPacket::size(), m_lastSendNs);
+    if (m_stage)
+        m_stage->applyCommand(m_packet.payload(), m_lastSendNs);
+    if (!keepAlive && m_packet != m_lastSent)
+        emit sent(m_packet);
+    m_lastSent = m_packet;
+
+    // 状态变化立即发送后，保活计时从本次发送重新开始
+    if (m_keepAliveTimer->isActive())
+        m_keepAliveTimer->start(m_keepAlivePeriod);
+}
+
+void SerialWorker::readData()
+{
+    QByteArray data = m_port->readAll();
+    if (data.isEmpty())
+        return;
+    dump(0, data.constData(), data.size(), frameClockNs());
+    emit received(data);
+
+    // 在串口线程中分帧、校验，GUI 只收到解码后的应答
+    PacketFramer::Stats before = m_framer.stats();
+    m_statuses.clear();
+    m_framer.feed(data.constData(), data.size(), m_statuses);
+    for (const StageStatus& status : m_statuses)
+    {
+        if (m_stage)
+            m_stage->applyStatus(status);
+        emit statusReceived(status);
+    }
+
+    const PacketFramer::Stats& after = m_framer.stats();
+    if (after.crcErrors != before.crcErrors || after.framingErrors != before.framingErrors)
+        emit receiveError(after.crcErrors, after.framingErrors);
+}
+
+void SerialWorker::handleError(QSerialPort::SerialPortError error)
+{
+    // 打开失败由 opened 报告
+    if (QSerialPort::NoError == error || QSerialPort::TimeoutError == error || !m_port->isOpen())
+        return;
+
+    QString message = m_port->errorString();
+    close();
+    emit errorOccurred(message);
+}
+
+void SerialWorker::setDumpFile(const QString &fileName)
+{
+    if (m_dumpFile.isOpen())
+        m_dumpFile.close();
+    if (fileName.isEmpty())
+        return;
+
+    m_dumpFile.setFileName(fileName);
+    if (!m_dumpFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        emit dumpError(m_dumpFile.errorString());
+        return;
+    }
+    m_dumpFile.write("CVSERIAL", 8);
+}
+
+void SerialWorker::dump(int direction, const char *data, int size, qint64 time)
+{
+    if (!m_dumpFile.isOpen())
+        return;
+
+    // 单条记录最长 65535 字节，readAll 一次读到更多时分成多条
+    for (int offset = 0; offset < size; offset += 0xFFFF)
+    {
+        int length = qMin(size - offset, 0xFFFF);
+        uchar header[12];
+        qToLittleEndian<qint64>(time, header);
+        header[8] = uchar(direction);
+        header[9] = 0;
+        qToLittleEndian<quint16>(quint16(length), header + 10);
+        if (m_dumpFile.write(reinterpret_cast<const char*>(header), sizeof(header)) != qint64(sizeof(header))
+            || m_dumpFile.write(data + offset, length) != length)
+        {
+            QString message = m_dumpFile.errorString();
+            m_dumpFile.close();
+            emit dumpError(message);
+            return;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QObject>
+#include <QSerialPort>
+#include <QTimer>
+#include "motioncommand.h"
+#include "packetframer.h"
+#include "stagemodel.h"
+
+// 微位移台串口收发，运行在独立线程的事件循环中，GUI 卡顿不影响运动指令的发送时机
+// 指令在状态变化时立即发送；保活周期 > 0 时按周期重发当前指令(控制器据此判断按键仍按住)
+// 所有槽函数都应通过排队连接或 QMetaObject::invokeMethod 从其他线程调用
+//
+// 转储文件: 8 字节 "CVSERIAL"，之后每条记录为
+// int64 时间(ns，frameClockNs) + uint8 方向(0 接收，1 发送) + uint8 保留 + uint16 长度(小端) + 数据
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SerialWorker(QObject *parent = nullptr);
+    ~SerialWorker();
+
+    // 发出的指令与收到的应答累计到 model，须在线程启动前设置
+    void setStageModel(StageModel *model) { m_stage = model; }
+
+public slots:
+    void open(const QString &portName, qint32 baudRate);
+    void close();
+
+    // 设置当前指令，与上次发送的内容不同时立即发送
+    // requested 为调用方产生该指令的时刻(frameClockNs)，用于统计排队延迟
+    void setPacket(const MotionPacket &packet, qint64 requested);
+
+    // 空闲指令: 松开按键、脉冲结束后恢复发送的内容
+    void setIdlePacket(const MotionPacket &packet);
+
+    // 发送 packet 并保持 duration 毫秒，之后恢复为空闲指令
+    void pulse(const MotionPacket &packet, int duration, qint64 requested);
+
+    // 保活周期(ms)，0 表示只在状态变化时发送
+    void setKeepAlive(int period);
+
+    // 把收发的原始字节转储到文件，fileName 为空时停止
+    void setDumpFile(const QString &fileName);
+
+    // 此前排队的指令全部写出串口后发出 drained(tag)，串口未打开时立即发出
+    // 调用方据此从最后一包实际发出的时刻开始计算位移台的稳定时间
+    void drain(int tag);
+
+signals:
+    void opened(bool ok, const QString &message);
+    void closed();
+    void errorOccurred(const QString &message);
+    void received(const QByteArray &data);
+    void sent(const MotionPacket &packet);      // 只在指令变化时发出，保活重发不发出
+    void dumpError(const QString &message);
+    void statusReceived(const StageStatus &status);
+    void receiveError(quint64 crcErrors, quint64 framingErrors);
+    void drained(int tag);
+
+private slots:
+    void keepAlive();
+    void endPulse();
+    void readData();
+    void bytesWritten();
+    void handleError(QSerialPort::SerialPortError error);
+
+private:
+    void send(qint64 requested, bool keepAlive = false);
+    void dump(int direction, const char *data, int size, qint64 time);
+
+    QSerialPort* m_port;
+    QTimer*      m_keepAliveTimer;
+    QTimer*      m_pulseTimer;
+    PacketFramer m_framer;
+    StageModel*  m_stage;
+    QVector<StageStatus> m_statuses;
+    QVector<int> m_drainTags;       // 等待串口缓冲写空的 drain 请求
+    MotionPacket m_packet;
+    MotionPacket m_idlePacket;
+    MotionPacket m_lastSent;
+    QFile        m_dumpFile;
+    int          m_keepAlivePeriod;
+    qint64       m_lastSendNs;
+};
+
+#endif // SERIALWORKER_H
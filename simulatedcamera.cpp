@@ -0,0 +1,674 @@
+#include <cstring>
+#include <random>
+#include <QStringList>
+#include "simulatedcamera.h"
+
+// 非 Windows 平台上 nncam.h 默认不定义错误码
+#ifndef S_OK
+#define S_OK            HRESULT(0x00000000)
+#endif
+#ifndef E_INVALIDARG
+#define E_INVALIDARG    HRESULT(0x80070057)
+#endif
+#ifndef E_UNEXPECTED
+#define E_UNEXPECTED    HRESULT(0x8000ffff)
+#endif
+#ifndef E_PENDING
+#define E_PENDING       HRESULT(0x8000000a)
+#endif
+
+namespace
+{
+
+const unsigned NoiseRows = 61;      // 噪声表行数，取质数使相邻帧的噪声错开
+
+NncamModelV2 makeModel()
+{
+    NncamModelV2 model;
+    memset(&model, 0, sizeof(model));
+#if defined(_WIN32)
+    model.name = L"Simulated Camera";
+#else
+    model.name = "Simulated Camera";
+#endif
+    model.flag = NNCAM_FLAG_CMOS;
+    model.preview = 3;
+    model.still = 3;
+    model.xpixsz = 2.4f;
+    model.ypixsz = 2.4f;
+    model.res[0].width = 5440;
+    model.res[0].height = 3648;
+    model.res[1].width = 2720;
+    model.res[1].height = 1824;
+    model.res[2].width = 1360;
+    model.res[2].height = 912;
+    return model;
+}
+
+}
+
+const NncamModelV2* SimulatedCamera::model()
+{
+    static const NncamModelV2 model = makeModel();
+    return &model;
+}
+
+SimulatedCamera::Config SimulatedCamera::configFromString(const QString &text)
+{
+    Config config;
+    const QStringList items = text.split(',', QString::SkipEmptyParts);
+    for (const QString &item : items)
+    {
+        QString key = item.section('=', 0, 0).trimmed();
+        QString value = item.section('=', 1).trimmed();
+        if (key == "fps")
+            config.fps = value.toDouble();
+        else if (key == "noise")
+            config.noise = qBound(0, value.toInt(), 127);
+        else if (key == "motion")
+            config.motion = value.toInt();
+        else if (key == "error")
+            config.errorAt = value.toUInt();
+        else if (key == "disconnect")
+            config.disconnectAt = value.toUInt();
+    }
+    return config;
+}
+
+SimulatedCamera::SimulatedCamera(const Config &config)
+    : m_config(config), m_running(false)
+    , m_funEvent(nullptr), m_ctxEvent(nullptr), m_funData(nullptr), m_ctxData(nullptr)
+    , m_stillReady(false), m_expoChanged(false), m_tempTintChanged(false), m_snapIndex(-1)
+    , m_res(0), m_seq(0), m_expoTime(2000), m_expoGain(NNCAM_EXPOGAIN_DEF), m_expoTarget(NNCAM_AETARGET_DEF)
+    , m_autoExpo(0), m_temp(NNCAM_TEMP_DEF), m_tint(NNCAM_TINT_DEF)
+    , m_patternWidth(0), m_patternHeight(0), m_frameIndex(0)
+    , m_startTime(std::chrono::steady_clock::now()), m_rateTime(m_startTime)
+    , m_totalFrames(0), m_rateFrames(0)
+{
+    memset(m_aSub, 0, sizeof(m_aSub));
+    memset(m_roi, 0, sizeof(m_roi));
+    memset(&m_aeRect, 0, sizeof(m_aeRect));
+    memset(&m_awbRect, 0, sizeof(m_awbRect));
+    memset(&m_abbRect, 0, sizeof(m_abbRect));
+
+    // 噪声表只生成一次，每行按帧序号错开使用
+    unsigned maxStride = TDIBWIDTHBYTES(model()->res[0].width * 24);
+    m_noise.resize(size_t(maxStride) * NoiseRows);
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> dist(-m_config.noise, m_config.noise);
+    for (size_t i = 0; i < m_noise.size(); ++i)
+        m_noise[i] = static_cast<signed char>(dist(rng));
+}
+
+SimulatedCamera::~SimulatedCamera()
+{
+    Stop();
+}
+
+HRESULT SimulatedCamera::StartPullModeWithCallback(PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent)
+{
+    if (m_running.load())
+        return E_UNEXPECTED;
+    m_funData = nullptr;
+    m_ctxData = nullptr;
+    m_funEvent = funEvent;
+    m_ctxEvent = ctxEvent;
+    return start();
+}
+
+HRESULT SimulatedCamera::StartPushModeV4(PNNCAM_DATA_CALLBACK_V4 funData, void* ctxData, PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent)
+{
+    if (m_running.load() || !funData)
+        return E_UNEXPECTED;
+    m_funData = funData;
+    m_ctxData = ctxData;
+    m_funEvent = funEvent;
+    m_ctxEvent = ctxEvent;
+    return start();
+}
+
+HRESULT SimulatedCamera::start()
+{
+    // 模拟断开后线程已自行退出，回收后再启动
+    if (m_thread.joinable())
+    {
+        if (m_thread.get_id() == std::this_thread::get_id())
+            return E_UNEXPECTED;
+        m_thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_rateTime = std::chrono::steady_clock::now();
+        m_rateFrames = m_totalFrames;
+    }
+    m_running.store(true);
+    m_thread = std::thread(&SimulatedCamera::run, this);
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::Stop()
+{
+    // 与 SDK 一样不允许在回调中停止: 回调线程无法等待自身结束，分离后又会在相机析构后继续运行
+    if (m_thread.joinable() && m_thread.get_id() == std::this_thread::get_id())
+        return E_UNEXPECTED;
+
+    m_running.store(false);
+    if (m_thread.joinable())
+        m_thread.join();
+    return S_OK;
+}
+
+void SimulatedCamera::run()
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration period = m_config.fps > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_config.fps))
+        : Clock::duration::zero();
+    Clock::time_point next = Clock::now();
+
+    while (m_running.load())
+    {
+        if (period > Clock::duration::zero())
+        {
+            next += period;
+            Clock::time_point now = Clock::now();
+            if (next > now)
+                std::this_thread::sleep_until(next);
+            else if (now - next > period)
+                next = now;     // 落后超过一帧时不再追赶
+        }
+
+        unsigned long long timestamp = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_startTime).count();
+
+        bool expoChanged, tempTintChanged;
+        int snapIndex;
+        unsigned totalFrames;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            renderFrame(timestamp);
+            totalFrames = ++m_totalFrames;
+
+            snapIndex = m_snapIndex;
+            m_snapIndex = -1;
+            if (snapIndex >= 0)
+                renderStill(unsigned(snapIndex), timestamp);
+
+            expoChanged = m_expoChanged;
+            tempTintChanged = m_tempTintChanged;
+            m_expoChanged = false;
+            m_tempTintChanged = false;
+        }
+
+        // 回调时不持有锁，回调中可以调用 PullImageV3 等接口；帧数据只由本线程修改
+        if (m_funEvent)
+        {
+            if (expoChanged)
+                m_funEvent(NNCAM_EVENT_EXPOSURE, m_ctxEvent);
+            if (tempTintChanged)
+                m_funEvent(NNCAM_EVENT_TEMPTINT, m_ctxEvent);
+        }
+
+        if (m_funData)
+            m_funData(m_frame.data.data(), &m_frame.info, 0, m_ctxData);
+        else if (m_funEvent)
+            m_funEvent(NNCAM_EVENT_IMAGE, m_ctxEvent);
+
+        if (snapIndex >= 0)
+        {
+            if (m_funData)
+            {
+                m_funData(m_still.data.data(), &m_still.info, 1, m_ctxData);
+            }
+            else if (m_funEvent)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stillReady = true;
+                }
+                m_funEvent(NNCAM_EVENT_STILLIMAGE, m_ctxEvent);
+            }
+        }
+
+        // 注入的故障事件，断开后不再产生帧
+        if (m_funEvent && m_config.errorAt && totalFrames == m_config.errorAt)
+            m_funEvent(NNCAM_EVENT_ERROR, m_ctxEvent);
+        if (m_config.disconnectAt && totalFrames == m_config.disconnectAt)
+        {
+            if (m_funEvent)
+                m_funEvent(NNCAM_EVENT_DISCONNECTED, m_ctxEvent);
+            m_running.store(false);
+        }
+    }
+}
+
+void SimulatedCamera::drawPattern(unsigned char* data, unsigned width, unsigned height, unsigned stride)
+{
+    // 水平/垂直渐变 + 8x8 的随机块纹理 + 128 像素网格，便于观察运动并为对焦、配准提供细节
+    for (unsigned y = 0; y < height; ++y)
+    {
+        unsigned char* row = data + size_t(stride) * y;
+        for (unsigned x = 0; x < width; ++x)
+        {
+            unsigned hash = ((x >> 3) * 73856093u) ^ ((y >> 3) * 19349663u);
+            hash ^= hash >> 13;
+            hash *= 0x5bd1e995u;
+            int texture = int((hash >> 24) & 0x3F) - 32;
+            bool grid = (x % 128) < 2 || (y % 128) < 2;
+
+            int r = int(x * 200 / width) + 28 + texture;
+            int g = int(y * 200 / height) + 28 + texture;
+            int b = 128 + texture;
+            if (grid)
+                r = g = b = 16;
+            row[x * 3 + 0] = static_cast<unsigned char>(qBound(0, r, 255));
+            row[x * 3 + 1] = static_cast<unsigned char>(qBound(0, g, 255));
+            row[x * 3 + 2] = static_cast<unsigned char>(qBound(0, b, 255));
+        }
+    }
+}
+
+void SimulatedCamera::addNoise(unsigned char* row, unsigned bytes, unsigned salt) const
+{
+    if (0 == m_config.noise)
+        return;
+
+    const signed char* noise = m_noise.data() + size_t(salt % NoiseRows) * (m_noise.size() / NoiseRows);
+    for (unsigned i = 0; i < bytes; ++i)
+    {
+        int v = int(row[i]) + noise[i];
+        row[i] = static_cast<unsigned char>(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+}
+
+void SimulatedCamera::fillInfo(Image &image, unsigned flag, unsigned long long timestamp)
+{
+    memset(&image.info, 0, sizeof(image.info));
+    image.info.width = image.width;
+    image.info.height = image.height;
+    image.info.flag = NNCAM_FRAMEINFO_FLAG_SEQ | NNCAM_FRAMEINFO_FLAG_TIMESTAMP
+                    | NNCAM_FRAMEINFO_FLAG_EXPOTIME | NNCAM_FRAMEINFO_FLAG_EXPOGAIN | flag;
+    image.info.seq = ++m_seq;
+    image.info.timestamp = timestamp;
+    image.info.expotime = m_expoTime;
+    image.info.expogain = m_expoGain;
+}
+
+void SimulatedCamera::renderFrame(unsigned long long timestamp)
+{
+    const NncamResolution& res = model()->res[m_res];
+    unsigned stride = TDIBWIDTHBYTES(res.width * 24);
+    if (m_patternWidth != res.width || m_patternHeight != res.height)
+    {
+        m_pattern.resize(size_t(stride) * res.height);
+        drawPattern(m_pattern.data(), res.width, res.height, stride);
+        m_patternWidth = res.width;
+        m_patternHeight = res.height;
+    }
+
+    // 设置了 ROI 时只输出该区域，帧尺寸随之变小
+    unsigned left = 0, top = 0, width = res.width, height = res.height;
+    if (m_roi[2] && m_roi[3])
+    {
+        left = m_roi[0];
+        top = m_roi[1];
+        width = m_roi[2];
+        height = m_roi[3];
+    }
+    m_frame.width = width;
+    m_frame.height = height;
+    m_frame.stride = TDIBWIDTHBYTES(width * 24);
+    m_frame.data.resize(size_t(m_frame.stride) * height);
+
+    // 图案按帧纵向滚动，逐行拷贝后叠加噪声
+    ++m_frameIndex;
+    unsigned shift = unsigned((m_frameIndex * unsigned(qAbs(m_config.motion))) % res.height);
+    for (unsigned y = 0; y < height; ++y)
+    {
+        unsigned char* row = m_frame.data.data() + size_t(m_frame.stride) * y;
+        memcpy(row, m_pattern.data() + size_t(stride) * ((top + y + shift) % res.height) + left * 3, width * 3);
+        addNoise(row, width * 3, unsigned(m_frameIndex) * 7 + y);
+    }
+    fillInfo(m_frame, 0, timestamp);
+}
+
+void SimulatedCamera::renderStill(unsigned index, unsigned long long timestamp)
+{
+    const NncamResolution& res = model()->res[index];
+    m_still.width = res.width;
+    m_still.height = res.height;
+    m_still.stride = TDIBWIDTHBYTES(res.width * 24);
+    m_still.data.resize(size_t(m_still.stride) * res.height);
+    drawPattern(m_still.data.data(), res.width, res.height, m_still.stride);
+    for (unsigned y = 0; y < res.height; ++y)
+        addNoise(m_still.data.data() + size_t(m_still.stride) * y, res.width * 3, y);
+    fillInfo(m_still, NNCAM_FRAMEINFO_FLAG_STILL, timestamp);
+}
+
+HRESULT SimulatedCamera::copyImage(const Image &image, void* pImageData, int bits, int rowPitch, NncamFrameInfoV3* pInfo)
+{
+    if (24 != bits)
+        return E_INVALIDARG;
+
+    // rowPitch: 0 表示按 4 字节对齐，-1 表示紧密排列
+    unsigned pitch = (0 == rowPitch) ? TDIBWIDTHBYTES(image.width * 24)
+                   : (-1 == rowPitch) ? image.width * 3 : unsigned(rowPitch);
+    if (pitch < image.width * 3)
+        return E_INVALIDARG;
+
+    if (pImageData)
+    {
+        unsigned char* dst = static_cast<unsigned char*>(pImageData);
+        if (pitch == image.stride)
+        {
+            memcpy(dst, image.data.data(), image.data.size());
+        }
+        else
+        {
+            for (unsigned y = 0; y < image.height; ++y)
+                memcpy(dst + size_t(pitch) * y, image.data.data() + size_t(image.stride) * y, image.width * 3);
+        }
+    }
+    if (pInfo)
+        *pInfo = image.info;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::PullImageV3(void* pImageData, int bStill, int bits, int rowPitch, NncamFrameInfoV3* pInfo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (bStill)
+    {
+        if (!m_stillReady)
+            return E_PENDING;
+        m_stillReady = false;
+        return copyImage(m_still, pImageData, bits, rowPitch, pInfo);
+    }
+    if (0 == m_frame.width)
+        return E_PENDING;
+    return copyImage(m_frame, pImageData, bits, rowPitch, pInfo);
+}
+
+HRESULT SimulatedCamera::PullStillImage(void* pImageData, int bits, unsigned* pnWidth, unsigned* pnHeight)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_stillReady)
+        return E_PENDING;
+    if (pnWidth)
+        *pnWidth = m_still.width;
+    if (pnHeight)
+        *pnHeight = m_still.height;
+
+    // pImageData 为空时只查询尺寸(peek)
+    if (!pImageData)
+        return S_OK;
+    m_stillReady = false;
+    return copyImage(m_still, pImageData, bits, 0, nullptr);
+}
+
+HRESULT SimulatedCamera::Snap(unsigned nResolutionIndex)
+{
+    if (nResolutionIndex >= model()->still)
+        return E_INVALIDARG;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_snapIndex = int(nResolutionIndex);
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_FrameRate(unsigned* nFrame, unsigned* nTime, unsigned* nTotalFrame)
+{
+    // 与 SDK 一致: 返回自上次调用以来的帧数与毫秒数
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (nFrame)
+        *nFrame = m_totalFrames - m_rateFrames;
+    if (nTime)
+        *nTime = unsigned(std::chrono::duration_cast<std::chrono::milliseconds>(now - m_rateTime).count());
+    if (nTotalFrame)
+        *nTotalFrame = m_totalFrames;
+    m_rateTime = now;
+    m_rateFrames = m_totalFrames;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_eSize(unsigned* pnResolutionIndex)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *pnResolutionIndex = m_res;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_eSize(unsigned nResolutionIndex)
+{
+    if (nResolutionIndex >= model()->preview)
+        return E_INVALIDARG;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_res = nResolutionIndex;
+    memset(m_roi, 0, sizeof(m_roi));
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_StillResolution(unsigned nResolutionIndex, int* pWidth, int* pHeight)
+{
+    if (nResolutionIndex >= model()->still)
+        return E_INVALIDARG;
+    *pWidth = int(model()->res[nResolutionIndex].width);
+    *pHeight = int(model()->res[nResolutionIndex].height);
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_PixelSize(unsigned nResolutionIndex, float* x, float* y)
+{
+    if (nResolutionIndex >= model()->preview)
+        return E_INVALIDARG;
+    // 低分辨率按 binning 处理，像素尺寸等比放大
+    float bin = float(model()->res[0].width) / model()->res[nResolutionIndex].width;
+    *x = model()->xpixsz * bin;
+    *y = model()->ypixsz * bin;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_Roi(unsigned xOffset, unsigned yOffset, unsigned xWidth, unsigned yHeight)
+{
+    if ((xOffset | yOffset | xWidth | yHeight) & 1)
+        return E_INVALIDARG;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const NncamResolution& res = model()->res[m_res];
+    if (0 == xWidth && 0 == yHeight)
+    {
+        memset(m_roi, 0, sizeof(m_roi));
+        return S_OK;
+    }
+    if (0 == xWidth || 0 == yHeight || xOffset + xWidth > res.width || yOffset + yHeight > res.height)
+        return E_INVALIDARG;
+    m_roi[0] = xOffset;
+    m_roi[1] = yOffset;
+    m_roi[2] = xWidth;
+    m_roi[3] = yHeight;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_Roi(unsigned* pxOffset, unsigned* pyOffset, unsigned* pxWidth, unsigned* pyHeight)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const NncamResolution& res = model()->res[m_res];
+    bool full = 0 == m_roi[2];
+    *pxOffset = full ? 0 : m_roi[0];
+    *pyOffset = full ? 0 : m_roi[1];
+    *pxWidth = full ? res.width : m_roi[2];
+    *pyHeight = full ? res.height : m_roi[3];
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_AutoExpoEnable(int* bAutoExposure)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *bAutoExposure = m_autoExpo;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_AutoExpoEnable(int bAutoExposure)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_autoExpo = bAutoExposure;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_AutoExpoTarget(unsigned short* Target)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *Target = m_expoTarget;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_AutoExpoTarget(unsigned short Target)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_expoTarget = Target;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_ExpTimeRange(unsigned* nMin, unsigned* nMax, unsigned* nDef)
+{
+    *nMin = 100;
+    *nMax = 5000000;
+    *nDef = 2000;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_ExpoTime(unsigned* Time)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *Time = m_expoTime;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_ExpoTime(unsigned Time)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_expoTime = Time;
+    m_expoChanged = true;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_ExpoAGainRange(unsigned short* nMin, unsigned short* nMax, unsigned short* nDef)
+{
+    *nMin = 100;
+    *nMax = 5000;
+    *nDef = NNCAM_EXPOGAIN_DEF;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_ExpoAGain(unsigned short* Gain)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *Gain = m_expoGain;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_ExpoAGain(unsigned short Gain)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_expoGain = Gain;
+    m_expoChanged = true;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_AEAuxRect(RECT* pAuxRect)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *pAuxRect = m_aeRect;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_AEAuxRect(const RECT* pAuxRect)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_aeRect = *pAuxRect;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_TempTint(int* nTemp, int* nTint)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *nTemp = m_temp;
+    *nTint = m_tint;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_TempTint(int nTemp, int nTint)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_temp = nTemp;
+    m_tint = nTint;
+    m_tempTintChanged = true;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::AwbOnce(PINNCAM_TEMPTINT_CALLBACK funTT, void* ctxTT)
+{
+    // 合成图案没有色偏，直接回到默认色温
+    int nTemp = NNCAM_TEMP_DEF, nTint = NNCAM_TINT_DEF;
+    put_TempTint(nTemp, nTint);
+    if (funTT)
+        funTT(nTemp, nTint, ctxTT);
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_AWBAuxRect(RECT* pAuxRect)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *pAuxRect = m_awbRect;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_AWBAuxRect(const RECT* pAuxRect)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_awbRect = *pAuxRect;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_BlackBalance(unsigned short aSub[3])
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    memcpy(aSub, m_aSub, sizeof(m_aSub));
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_BlackBalance(unsigned short aSub[3])
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    memcpy(m_aSub, aSub, sizeof(m_aSub));
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::AbbOnce(PINNCAM_BLACKBALANCE_CALLBACK funBB, void* ctxBB)
+{
+    unsigned short aSub[3] = { 0, 0, 0 };
+    put_BlackBalance(aSub);
+    if (funBB)
+        funBB(aSub, ctxBB);
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::get_ABBAuxRect(RECT* pAuxRect)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    *pAuxRect = m_abbRect;
+    return S_OK;
+}
+
+HRESULT SimulatedCamera::put_ABBAuxRect(const RECT* pAuxRect)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_abbRect = *pAuxRect;
+    return S_OK;
+}
+
+// 颜色调整不影响合成图像
+HRESULT SimulatedCamera::put_Hue(int) { return S_OK; }
+HRESULT SimulatedCamera::put_Saturation(int) { return S_OK; }
+HRESULT SimulatedCamera::put_Brightness(int) { return S_OK; }
+HRESULT SimulatedCamera::put_Contrast(int) { return S_OK; }
+HRESULT SimulatedCamera::put_Gamma(int) { return S_OK; }
+HRESULT SimulatedCamera::put_Option(unsigned, int) { return S_OK; }
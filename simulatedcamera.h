@@ -0,0 +1,154 @@
+#ifndef SIMULATEDCAMERA_H
+#define SIMULATEDCAMERA_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <QString>
+#include "cameradevice.h"
+
+// 模拟相机
+// 在内部线程中按设定帧率生成合成 RGB24 帧(滚动的测试图案 + 噪声)，
+// 按 Nncam SDK 的语义触发 IMAGE/STILLIMAGE 事件或推送回调，
+// 并可在指定帧序号注入 ERROR/DISCONNECTED 事件
+class SimulatedCamera : public CameraDevice
+{
+public:
+    struct Config
+    {
+        double   fps;           // 帧率，<= 0 表示不限速
+        int      noise;         // 噪声幅度(灰度级)
+        int      motion;        // 图案每帧滚动的像素数
+        unsigned errorAt;       // 第 N 帧后触发 NNCAM_EVENT_ERROR，0 表示不触发
+        unsigned disconnectAt;  // 第 N 帧后触发 NNCAM_EVENT_DISCONNECTED，0 表示不触发
+
+        Config() : fps(30.0), noise(6), motion(2), errorAt(0), disconnectAt(0) {}
+    };
+
+    // 解析 "fps=30,noise=6,motion=2,error=0,disconnect=0"，未给出的项使用默认值
+    static Config configFromString(const QString &text);
+
+    // 模拟相机的型号信息，分辨率按从大到小排列
+    static const NncamModelV2* model();
+
+    explicit SimulatedCamera(const Config &config = Config());
+    ~SimulatedCamera() override;
+
+    const Config& config() const { return m_config; }
+
+    HRESULT StartPullModeWithCallback(PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent) override;
+    HRESULT StartPushModeV4(PNNCAM_DATA_CALLBACK_V4 funData, void* ctxData, PNNCAM_EVENT_CALLBACK funEvent, void* ctxEvent) override;
+    HRESULT Stop() override;
+    HRESULT PullImageV3(void* pImageData, int bStill, int bits, int rowPitch, NncamFrameInfoV3* pInfo) override;
+    HRESULT PullStillImage(void* pImageData, int bits, unsigned* pnWidth, unsigned* pnHeight) override;
+    HRESULT Snap(unsigned nResolutionIndex) override;
+    HRESULT get_FrameRate(unsigned* nFrame, unsigned* nTime, unsigned* nTotalFrame) override;
+
+    HRESULT get_eSize(unsigned* pnResolutionIndex) override;
+    HRESULT put_eSize(unsigned nResolutionIndex) override;
+    HRESULT get_StillResolution(unsigned nResolutionIndex, int* pWidth, int* pHeight) override;
+    HRESULT get_PixelSize(unsigned nResolutionIndex, float* x, float* y) override;
+    HRESULT put_Roi(unsigned xOffset, unsigned yOffset, unsigned xWidth, unsigned yHeight) override;
+    HRESULT get_Roi(unsigned* pxOffset, unsigned* pyOffset, unsigned* pxWidth, unsigned* pyHeight) override;
+
+    HRESULT get_AutoExpoEnable(int* bAutoExposure) override;
+    HRESULT put_AutoExpoEnable(int bAutoExposure) override;
+    HRESULT get_AutoExpoTarget(unsigned short* Target) override;
+    HRESULT put_AutoExpoTarget(unsigned short Target) override;
+    HRESULT get_ExpTimeRange(unsigned* nMin, unsigned* nMax, unsigned* nDef) override;
+    HRESULT get_ExpoTime(unsigned* Time) override;
+    HRESULT put_ExpoTime(unsigned Time) override;
+    HRESULT get_ExpoAGainRange(unsigned short* nMin, unsigned short* nMax, unsigned short* nDef) override;
+    HRESULT get_ExpoAGain(unsigned short* Gain) override;
+    HRESULT put_ExpoAGain(unsigned short Gain) override;
+    HRESULT get_AEAuxRect(RECT* pAuxRect) override;
+    HRESULT put_AEAuxRect(const RECT* pAuxRect) override;
+
+    HRESULT get_TempTint(int* nTemp, int* nTint) override;
+    HRESULT put_TempTint(int nTemp, int nTint) override;
+    HRESULT AwbOnce(PINNCAM_TEMPTINT_CALLBACK funTT, void* ctxTT) override;
+    HRESULT get_AWBAuxRect(RECT* pAuxRect) override;
+    HRESULT put_AWBAuxRect(const RECT* pAuxRect) override;
+    HRESULT get_BlackBalance(unsigned short aSub[3]) override;
+    HRESULT put_BlackBalance(unsigned short aSub[3]) override;
+    HRESULT AbbOnce(PINNCAM_BLACKBALANCE_CALLBACK funBB, void* ctxBB) override;
+    HRESULT get_ABBAuxRect(RECT* pAuxRect) override;
+    HRESULT put_ABBAuxRect(const RECT* pAuxRect) override;
+    HRESULT put_Hue(int Hue) override;
+    HRESULT put_Saturation(int Saturation) override;
+    HRESULT put_Brightness(int Brightness) override;
+    HRESULT put_Contrast(int Contrast) override;
+    HRESULT put_Gamma(int Gamma) override;
+
+    HRESULT put_Option(unsigned iOption, int iValue) override;
+
+private:
+    struct Image
+    {
+        std::vector<unsigned char> data;
+        unsigned                   width;
+        unsigned                   height;
+        unsigned                   stride;
+        NncamFrameInfoV3           info;
+
+        Image() : width(0), height(0), stride(0) {}
+    };
+
+    HRESULT start();
+    void run();
+    void renderFrame(unsigned long long timestamp);
+    void renderStill(unsigned index, unsigned long long timestamp);
+    void fillInfo(Image &image, unsigned flag, unsigned long long timestamp);
+    void addNoise(unsigned char* row, unsigned bytes, unsigned salt) const;
+    static void drawPattern(unsigned char* data, unsigned width, unsigned height, unsigned stride);
+    static HRESULT copyImage(const Image &image, void* pImageData, int bits, int rowPitch, NncamFrameInfoV3* pInfo);
+
+    SimulatedCamera(const SimulatedCamera&);
+    SimulatedCamera& operator=(const SimulatedCamera&);
+
+    Config                     m_config;
+    std::thread                m_thread;
+    std::atomic<bool>          m_running;
+    PNNCAM_EVENT_CALLBACK      m_funEvent;
+    void*                      m_ctxEvent;
+    PNNCAM_DATA_CALLBACK_V4    m_funData;
+    void*                      m_ctxData;
+
+    std::mutex                 m_mutex;         // 保护以下帧数据与参数
+    Image                      m_frame;
+    Image                      m_still;
+    bool                       m_stillReady;
+    bool                       m_expoChanged;   // 下一帧前触发 NNCAM_EVENT_EXPOSURE
+    bool                       m_tempTintChanged;
+    int                        m_snapIndex;     // 待处理的抓拍分辨率，-1 表示无
+    unsigned                   m_res;
+    unsigned                   m_roi[4];        // xOffset, yOffset, xWidth, yHeight，宽度为 0 表示整个视野
+    unsigned                   m_seq;
+    unsigned                   m_expoTime;
+    unsigned short             m_expoGain;
+    unsigned short             m_expoTarget;
+    int                        m_autoExpo;
+    int                        m_temp;
+    int                        m_tint;
+    unsigned short             m_aSub[3];
+    RECT                       m_aeRect;
+    RECT                       m_awbRect;
+    RECT                       m_abbRect;
+
+    // 合成图案(预览分辨率变化时重新生成)与噪声表，只由采集线程访问
+    std::vector<unsigned char> m_pattern;
+    std::vector<signed char>   m_noise;
+    unsigned                   m_patternWidth;
+    unsigned                   m_patternHeight;
+    unsigned long long         m_frameIndex;
+
+    // get_FrameRate 统计
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_rateTime;
+    unsigned                   m_totalFrames;
+    unsigned                   m_rateFrames;
+};
+
+#endif // SIMULATEDCAMERA_H
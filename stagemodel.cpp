@@ -0,0 +1,76 @@
+#include <cstring>
+#include "motioncommand.h"
+#include "stagemodel.h"
+
+namespace
+{
+
+qint32 readInt32(const uchar *p)
+{
+    return qint32((quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]));
+}
+
+qint32 readUInt16(const uchar *p)
+{
+    return qint32((p[0] << 8) | p[1]);
+}
+
+}
+
+StageModel::StageModel()
+    : m_lastAck(0)
+{
+    memset(&m_position, 0, sizeof(m_position));
+    m_position.source = None;
+}
+
+void StageModel::applyCommand(const uchar *payload, qint64 time)
+{
+    qint32 delta[AxisCount];
+    delta[T] = readInt32(payload);
+    delta[R] = readInt32(payload + 4);
+    delta[X] = qint32(MotionCommand::AxisNeutral) - readUInt16(payload + 8);
+    delta[Y] = qint32(MotionCommand::AxisNeutral) - readUInt16(payload + 10);
+    delta[Z] = qint32(MotionCommand::AxisNeutral) - readUInt16(payload + 12);
+
+    QMutexLocker locker(&m_mutex);
+    // 应答正常时以应答为准，避免同一个指令计两次
+    if (m_lastAck && time - m_lastAck < qint64(AckTimeout) * 1000000)
+        return;
+    integrate(delta, Commanded, time);
+}
+
+void StageModel::applyStatus(const StageStatus &status)
+{
+    qint32 delta[AxisCount];
+    delta[T] = status.t;
+    delta[R] = status.r;
+    delta[X] = qint32(MotionCommand::AxisNeutral) - qint32(status.x);
+    delta[Y] = qint32(MotionCommand::AxisNeutral) - qint32(status.y);
+    delta[Z] = qint32(MotionCommand::AxisNeutral) - qint32(status.z);
+
+    QMutexLocker locker(&m_mutex);
+    m_lastAck = status.arrival;
+    integrate(delta, Acknowledged, status.arrival);
+}
+
+void StageModel::integrate(const qint32 delta[AxisCount], Source source, qint64 time)
+{
+    for (int a = 0; a < AxisCount; ++a)
+        m_position.axis[a] = qint32(quint32(m_position.axis[a]) + quint32(delta[a]));
+    m_position.source = source;
+    m_position.time = time;
+}
+
+void StageModel::zero()
+{
+    QMutexLocker locker(&m_mutex);
+    for (int a = 0; a < AxisCount; ++a)
+        m_position.axis[a] = 0;
+}
+
+StageModel::Position StageModel::position() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_position;
+}
@@ -0,0 +1,63 @@
+#ifndef STAGEMODEL_H
+#define STAGEMODEL_H
+
+#include <QMutex>
+#include <QtGlobal>
+#include "packetframer.h"
+
+// 位移台各轴位置(控制器步数)
+// 指令是"按住即动"的速度指令: 每个发出的指令包使 T/R 移动 int32 字段的值，X/Y/Z 移动 0x0200 - 字段值；
+// 收到控制器应答后改为按应答(控制器实际执行的指令)累计，应答中断超过 AckTimeout 后退回按发出的指令累计
+// 串口线程写入，采集线程、GUI 线程随时读取快照
+class StageModel
+{
+public:
+    enum Axis
+    {
+        T,
+        R,
+        X,
+        Y,
+        Z,
+        AxisCount
+    };
+
+    enum Source
+    {
+        None,           // 尚未发送过运动指令
+        Commanded,      // 按发出的指令估计
+        Acknowledged    // 按控制器应答累计
+    };
+
+    enum
+    {
+        AckTimeout = 500    // ms
+    };
+
+    struct Position
+    {
+        qint32 axis[AxisCount];
+        Source source;
+        qint64 time;        // 最近一次更新(ns)，见 frameClockNs()
+    };
+
+    StageModel();
+
+    // payload 为指令包的 15 字节数据区
+    void applyCommand(const uchar *payload, qint64 time);
+    void applyStatus(const StageStatus &status);
+
+    // 以当前位置为原点
+    void zero();
+
+    Position position() const;
+
+private:
+    void integrate(const qint32 delta[AxisCount], Source source, qint64 time);
+
+    mutable QMutex m_mutex;
+    Position       m_position;
+    qint64         m_lastAck;
+};
+
+#endif // STAGEMODEL_H
@@ -0,0 +1,99 @@
+#include <opencv2/opencv.hpp>
+#include <QDir>
+#include <QMutexLocker>
+#include <QSettings>
+#include "tilesource.h"
+
+RawTileSource::RawTileSource(const QString &path, const RawFrameRecord &record)
+    : m_file(path), m_record(record), m_map(nullptr), m_levels(1), m_valid(false)
+{
+    qint64 bytes = qint64(record.stride) * record.height;
+    if (24 != record.bits || 0 == record.width || 0 == record.height || !m_file.open(QIODevice::ReadOnly)
+        || m_file.size() < qint64(record.offset) + bytes)
+        return;
+
+    // 映射失败(地址空间不足)时退回按行读取
+    m_map = m_file.map(qint64(record.offset), bytes);
+    int size = int(qMax(record.width, record.height));
+    while ((size >> (m_levels - 1)) > TileSize)
+        ++m_levels;
+    m_valid = true;
+}
+
+RawTileSource::~RawTileSource()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+QImage RawTileSource::tile(int level, int x, int y) const
+{
+    int span = TileSize << level;
+    QRect region = QRect(x * span, y * span, span, span) & bounds();
+    if (!m_valid || level < 0 || level >= m_levels || region.isEmpty())
+        return QImage();
+
+    // 尺寸向上取整，相邻块之间不留缝
+    int width = (region.width() + (1 << level) - 1) >> level;
+    int height = (region.height() + (1 << level) - 1) >> level;
+    QImage image(width, height, QImage::Format_RGB32);
+    cv::Mat dst(height, width, CV_8UC4, image.bits(), size_t(image.bytesPerLine()));
+
+    cv::Mat src;
+    cv::Rect rect(region.x(), region.y(), region.width(), region.height());
+    if (m_map)
+    {
+        src = cv::Mat(int(m_record.height), int(m_record.width), CV_8UC3, m_map, m_record.stride)(rect);
+    }
+    else
+    {
+        QMutexLocker locker(&m_mutex);
+        src.create(rect.height, rect.width, CV_8UC3);
+        qint64 rowBytes = qint64(rect.width) * 3;
+        for (int row = 0; row < rect.height; ++row)
+        {
+            if (!m_file.seek(qint64(m_record.offset) + qint64(rect.y + row) * m_record.stride + rect.x * 3)
+                || m_file.read(reinterpret_cast<char*>(src.ptr(row)), rowBytes) != rowBytes)
+                return QImage();
+        }
+    }
+
+    // RGB24 -> Format_RGB32(内存中为 B G R FF)，绘制时不再需要转换
+    if (0 == level)
+    {
+        cv::cvtColor(src, dst, cv::COLOR_RGB2BGRA);
+    }
+    else
+    {
+        cv::Mat small;
+        cv::resize(src, small, dst.size(), 0, 0, cv::INTER_AREA);
+        cv::cvtColor(small, dst, cv::COLOR_RGB2BGRA);
+    }
+    return image;
+}
+
+MosaicTileSource::MosaicTileSource(const QString &directory)
+    : m_directory(directory), m_levels(0)
+{
+    QSettings settings(QDir(directory).filePath("mosaic.ini"), QSettings::IniFormat);
+    settings.beginGroup("mosaic");
+    if (settings.value("tileSize").toInt() != TileSize)
+        return;
+    m_bounds = QRect(settings.value("offsetX").toInt(), settings.value("offsetY").toInt(),
+                     settings.value("width").toInt(), settings.value("height").toInt());
+    m_format = settings.value("format", "jpg").toString();
+    if (!m_bounds.isEmpty())
+        m_levels = qMax(0, settings.value("levels").toInt());
+}
+
+QImage MosaicTileSource::tile(int level, int x, int y) const
+{
+    if (level < 0 || level >= m_levels)
+        return QImage();
+
+    // 没有图像的区域不写块文件
+    QImage image;
+    if (!image.load(QString("%1/%2/%3_%4.%5").arg(m_directory).arg(level).arg(x).arg(y).arg(m_format)))
+        return QImage();
+    return image.convertToFormat(QImage::Format_RGB32);
+}
@@ -0,0 +1,73 @@
+#ifndef TILESOURCE_H
+#define TILESOURCE_H
+
+#include <QFile>
+#include <QImage>
+#include <QMutex>
+#include <QRect>
+#include <QString>
+#include "rawsequence.h"
+
+// 分块金字塔图像源，供 TileViewer 按需取块
+// level 0 为全分辨率，level n 缩小 2^n 倍；第 level 级的块 (x, y) 覆盖全分辨率下
+// [x, x + 1) * (TileSize << level) x [y, y + 1) * (TileSize << level) 的区域，边缘的块可以小于 TileSize
+// tile() 在 TileViewer 的工作线程中并发调用，实现须线程安全
+class TileSource
+{
+public:
+    enum
+    {
+        TileSize = 256
+    };
+
+    virtual ~TileSource() {}
+
+    // 全分辨率下有图像的区域，块序号从 0 开始
+    virtual QRect bounds() const = 0;
+    virtual int levels() const = 0;
+    // 返回 Format_RGB32 图像，没有图像的块返回空图像
+    virtual QImage tile(int level, int x, int y) const = 0;
+};
+
+// 抓拍的原始文件(CaptureStore 的临时文件)，块在请求时从文件映射缩放生成
+class RawTileSource : public TileSource
+{
+public:
+    RawTileSource(const QString &path, const RawFrameRecord &record);
+    ~RawTileSource();
+
+    bool isValid() const { return m_valid; }
+
+    QRect bounds() const override { return QRect(0, 0, int(m_record.width), int(m_record.height)); }
+    int levels() const override { return m_levels; }
+    QImage tile(int level, int x, int y) const override;
+
+private:
+    mutable QFile  m_file;
+    mutable QMutex m_mutex;     // 不能映射时逐行读取，QFile 的读位置须互斥
+    RawFrameRecord m_record;
+    uchar*         m_map;
+    int            m_levels;
+    bool           m_valid;
+};
+
+// Mosaic::save 写出的拼接目录: <directory>/<level>/<x>_<y>.jpg 与 mosaic.ini
+class MosaicTileSource : public TileSource
+{
+public:
+    explicit MosaicTileSource(const QString &directory);
+
+    bool isValid() const { return m_levels > 0; }
+
+    QRect bounds() const override { return m_bounds; }
+    int levels() const override { return m_levels; }
+    QImage tile(int level, int x, int y) const override;
+
+private:
+    QString m_directory;
+    QString m_format;
+    QRect   m_bounds;
+    int     m_levels;
+};
+
+#endif // TILESOURCE_H
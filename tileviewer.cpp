@@ -0,0 +1,250 @@
+#include <climits>
+#include <cmath>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QRunnable>
+#include <QThread>
+#include <QWheelEvent>
+#include "tileviewer.h"
+
+namespace
+{
+
+class TileTask : public QRunnable
+{
+public:
+    TileTask(TileViewer *viewer, const QSharedPointer<TileSource> &source, quint64 key, int level, int x, int y)
+        : m_viewer(viewer), m_source(source), m_key(key), m_level(level), m_x(x), m_y(y)
+    {
+    }
+
+    void run() override
+    {
+        QImage image = m_source->tile(m_level, m_x, m_y);
+        QMetaObject::invokeMethod(m_viewer, "tileLoaded", Qt::QueuedConnection, Q_ARG(quint64, m_key), Q_ARG(QImage, image));
+    }
+
+private:
+    TileViewer*                m_viewer;
+    QSharedPointer<TileSource> m_source;
+    quint64                    m_key;
+    int                        m_level;
+    int                        m_x;
+    int                        m_y;
+};
+
+}
+
+TileViewer::TileViewer(const QSharedPointer<TileSource> &source, QWidget *parent)
+    : QWidget(parent)
+    , m_source(source)
+    , m_cache(DefaultCacheBytes / 1024)
+    , m_scale(1.0), m_fitted(true), m_dragging(false)
+{
+    // 留出采集与串口线程
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setCursor(Qt::OpenHandCursor);
+}
+
+TileViewer::~TileViewer()
+{
+    // 工作线程持有本对象的指针，须在析构前结束
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void TileViewer::setPreview(const QImage &preview)
+{
+    m_preview = preview.convertToFormat(QImage::Format_RGB32);
+    update();
+}
+
+void TileViewer::setCacheBytes(qint64 bytes)
+{
+    m_cache.setMaxCost(int(qBound(Q_INT64_C(1), bytes / 1024, qint64(INT_MAX))));
+}
+
+double TileViewer::fitScale() const
+{
+    QRect bounds = m_source->bounds();
+    if (bounds.isEmpty())
+        return 1.0;
+    return qMin(width() / double(bounds.width()), height() / double(bounds.height()));
+}
+
+void TileViewer::fitToWindow()
+{
+    m_scale = fitScale();
+    m_origin = QRectF(m_source->bounds()).center() - QPointF(width(), height()) / (2.0 * m_scale);
+    m_fitted = true;
+    viewChanged();
+}
+
+void TileViewer::viewChanged()
+{
+    m_pool.clear();
+    m_pending.clear();
+    update();
+}
+
+void TileViewer::request(int level, int x, int y)
+{
+    quint64 key = tileKey(level, x, y);
+    if (m_pending.contains(key))
+        return;
+    m_pending.insert(key);
+    m_pool.start(new TileTask(this, m_source, key, level, x, y));
+}
+
+void TileViewer::tileLoaded(quint64 key, const QImage &image)
+{
+    // 空图像也放入缓存，没有图像的块不会反复请求
+    m_pending.remove(key);
+    m_cache.insert(key, new QImage(image), qMax(1, image.bytesPerLine() * image.height() / 1024));
+    update();
+}
+
+void TileViewer::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+
+    QRect bounds = m_source->bounds();
+    QRectF visible = QRectF(m_origin, QSizeF(width(), height()) / m_scale) & QRectF(bounds);
+    if (visible.isEmpty())
+        return;
+
+    // 选择缩小倍数不超过 1 / m_scale 的最粗一级，块绘制时的缩放在 (0.5, 1] 之间
+    int level = 0;
+    while (level + 1 < m_source->levels() && 1.0 / m_scale >= double(2 << level))
+        ++level;
+    if (m_scale < 1.0)
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    painter.translate(-m_origin * m_scale);
+    painter.scale(m_scale, m_scale);
+
+    int span = TileSize << level;
+    int x0 = int(visible.left()) / span;
+    int y0 = int(visible.top()) / span;
+    int x1 = (int(std::ceil(visible.right())) - 1) / span;
+    int y1 = (int(std::ceil(visible.bottom())) - 1) / span;
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            QImage *image = m_cache.object(tileKey(level, x, y));
+            if (image)
+            {
+                if (!image->isNull())
+                    painter.drawImage(QRectF(x * span, y * span, image->width() << level, image->height() << level), *image);
+                continue;
+            }
+            request(level, x, y);
+            drawFallback(painter, level, x, y, QRectF(x * span, y * span, span, span) & QRectF(bounds));
+        }
+    }
+}
+
+bool TileViewer::drawFallback(QPainter &painter, int level, int x, int y, const QRectF &region)
+{
+    // painter 已换算到图像坐标，region 为缺失块在全分辨率下的范围
+    for (int l = level + 1; l < m_source->levels(); ++l)
+    {
+        int shift = l - level;
+        QImage *parent = m_cache.object(tileKey(l, x >> shift, y >> shift));
+        if (!parent || parent->isNull())
+            continue;
+        QPointF origin(double(x >> shift) * (TileSize << l), double(y >> shift) * (TileSize << l));
+        painter.drawImage(region, *parent, QRectF((region.topLeft() - origin) / (1 << l), region.size() / (1 << l)));
+        return true;
+    }
+
+    if (m_preview.isNull())
+        return false;
+    QRect bounds = m_source->bounds();
+    double sx = m_preview.width() / double(bounds.width());
+    double sy = m_preview.height() / double(bounds.height());
+    painter.drawImage(region, m_preview, QRectF((region.left() - bounds.left()) * sx, (region.top() - bounds.top()) * sy,
+                                                region.width() * sx, region.height() * sy));
+    return true;
+}
+
+void TileViewer::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    if (m_fitted)
+        fitToWindow();
+    else
+        viewChanged();
+}
+
+void TileViewer::hideEvent(QHideEvent *event)
+{
+    // 隐藏的标签页不占用缓存
+    m_pool.clear();
+    m_pending.clear();
+    m_cache.clear();
+    QWidget::hideEvent(event);
+}
+
+void TileViewer::wheelEvent(QWheelEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QPointF pos = event->position();
+#else
+    QPointF pos = event->posF();
+#endif
+    // 一格(120)约 1.2 倍，光标下的图像位置保持不动
+    double scale = m_scale * std::pow(1.0015, event->angleDelta().y());
+    scale = qBound(qMin(fitScale(), 1.0) / 2.0, scale, double(MaxZoom));
+    QPointF anchor = m_origin + pos / m_scale;
+    m_scale = scale;
+    m_origin = anchor - pos / m_scale;
+    m_fitted = false;
+    viewChanged();
+    event->accept();
+}
+
+void TileViewer::mousePressEvent(QMouseEvent *event)
+{
+    if (Qt::LeftButton != event->button())
+    {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    m_dragging = true;
+    m_dragStart = event->pos();
+    setCursor(Qt::ClosedHandCursor);
+}
+
+void TileViewer::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!m_dragging)
+    {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+    m_origin -= QPointF(event->pos() - m_dragStart) / m_scale;
+    m_dragStart = event->pos();
+    m_fitted = false;
+    viewChanged();
+}
+
+void TileViewer::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (Qt::LeftButton == event->button())
+    {
+        m_dragging = false;
+        setCursor(Qt::OpenHandCursor);
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void TileViewer::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    Q_UNUSED(event);
+    fitToWindow();
+}
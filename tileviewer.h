@@ -0,0 +1,75 @@
+#ifndef TILEVIEWER_H
+#define TILEVIEWER_H
+
+#include <QCache>
+#include <QImage>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWidget>
+#include "tilesource.h"
+
+// 分块金字塔图像查看器
+// 每次绘制只取可见区域内、与当前缩放最接近的一级的块；缓存中没有的块交给工作线程从 TileSource 生成，
+// 到达后重绘，等待期间用缓存中更粗一级的块或整幅缩略图代替。块按最近使用淘汰，总量不超过 setCacheBytes 的设置
+// 滚轮以光标为中心缩放，左键拖动平移，双击恢复适应窗口
+class TileViewer : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum
+    {
+        DefaultCacheBytes = 256 * 1024 * 1024,
+        MaxZoom = 16                        // 最大放大倍数(屏幕像素/图像像素)
+    };
+
+    explicit TileViewer(const QSharedPointer<TileSource> &source, QWidget *parent = nullptr);
+    ~TileViewer();
+
+    // 块加载完成前显示的整幅缩略图
+    void setPreview(const QImage &preview);
+
+    void fitToWindow();
+    // 隐藏时缓存即清空，只有当前显示的查看器占用内存
+    void setCacheBytes(qint64 bytes);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private slots:
+    void tileLoaded(quint64 key, const QImage &image);
+
+private:
+    static quint64 tileKey(int level, int x, int y)
+    {
+        return (quint64(level) << 56) | (quint64(quint32(x) & 0x0fffffff) << 28) | (quint32(y) & 0x0fffffff);
+    }
+
+    double fitScale() const;
+    // 视图改变后丢弃尚未开始的请求，只加载新的可见块
+    void viewChanged();
+    void request(int level, int x, int y);
+    // 用缓存中更粗一级的块填充 target(屏幕坐标)对应的区域，找到时返回 true
+    bool drawFallback(QPainter &painter, int level, int x, int y, const QRectF &target);
+
+    QSharedPointer<TileSource> m_source;
+    QCache<quint64, QImage>    m_cache;     // 代价以 KB 计
+    QSet<quint64>              m_pending;
+    QThreadPool                m_pool;
+    QImage                     m_preview;
+    double                     m_scale;     // 屏幕像素/图像像素
+    QPointF                    m_origin;    // 窗口左上角对应的图像坐标
+    bool                       m_fitted;    // 未手动缩放平移时随窗口大小适应
+    bool                       m_dragging;
+    QPoint                     m_dragStart;
+};
+
+#endif // TILEVIEWER_H
@@ -0,0 +1,121 @@
+#include "zstack.h"
+
+ZStack::ZStack(QObject *parent)
+    : QObject(parent)
+    , m_state(Idle)
+    , m_planes(0), m_step(0), m_position(0), m_snapTime(0)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &ZStack::timeout);
+}
+
+void ZStack::start(int planes, qint32 step, const QString &fileName)
+{
+    m_planes = qMax(1, planes);
+    m_step = step;
+    m_position = 0;
+    m_fileName = fileName;
+    if (!m_writer.open(fileName, SegmentBytes))
+    {
+        removeRawSequence(fileName);
+        emit finished(false, u8"无法创建临时文件 " + fileName);
+        return;
+    }
+    emit progress(0, m_planes);
+    moveTo(planePosition(0));
+}
+
+void ZStack::stop()
+{
+    if (isRunning())
+        finish(false, u8"已停止");
+}
+
+void ZStack::moveTo(qint32 position)
+{
+    qint32 steps = position - m_position;
+    m_position = position;
+    if (!steps)
+    {
+        m_state = Settling;
+        m_timer->start(SettleTime);
+        return;
+    }
+    m_state = Moving;
+    m_timer->start(MoveTimeout);
+    emit move(steps);
+}
+
+void ZStack::moveSent()
+{
+    if (Moving != m_state)
+        return;
+    m_state = Settling;
+    m_timer->start(SettleTime);
+}
+
+void ZStack::timeout()
+{
+    if (Moving == m_state)
+    {
+        finish(false, u8"等待移动指令发出超时");
+    }
+    else if (Settling == m_state)
+    {
+        m_state = Snapping;
+        m_snapTime = frameClockNs();
+        m_timer->start(SnapTimeout);
+        emit snap();
+    }
+    else if (Snapping == m_state)
+    {
+        finish(false, u8"等待抓拍图像超时");
+    }
+}
+
+void ZStack::addFrame(const Frame &frame)
+{
+    if (Snapping != m_state || frame.isNull() || frame.arrival() < m_snapTime)
+        return;
+
+    m_timer->stop();
+    if (!m_writer.write(frame))
+    {
+        finish(false, u8"写入临时文件失败");
+        return;
+    }
+    int planes = int(m_writer.frameCount());
+    emit progress(planes, m_planes);
+    if (planes < m_planes)
+    {
+        moveTo(planePosition(planes));
+        return;
+    }
+
+    m_writer.close();
+    QString fileName = m_fileName;
+    m_fileName.clear();
+    finish(true, QString());
+    emit acquired(fileName, planes);
+}
+
+void ZStack::finish(bool ok, const QString &message)
+{
+    m_timer->stop();
+    m_state = Idle;
+
+    // 未完成的序列不再需要
+    m_writer.close();
+    if (!m_fileName.isEmpty())
+    {
+        removeRawSequence(m_fileName);
+        m_fileName.clear();
+    }
+
+    // 回到起点
+    if (m_position)
+        emit move(-m_position);
+    m_position = 0;
+    emit finished(ok, message);
+}
@@ -0,0 +1,78 @@
+#ifndef ZSTACK_H
+#define ZSTACK_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "frame.h"
+#include "rawsequence.h"
+
+// Z 堆栈采集
+// 以当前位置为中心，按 step 步的间隔依次移动到各层，调用方确认移动指令已全部发出(moveSent)后
+// 稳定 SettleTime 再请求一次抓拍，收到抓拍图像再移动到下一层；全部采集完成后回到起点
+// 各层收到后立即写入原始帧序列，内存中不保留全分辨率图像，层数只受磁盘空间限制
+// 与 Autofocus 相同，移动和抓拍通过信号交给调用方
+class ZStack : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum
+    {
+        SettleTime = 80,        // 最后一包移动指令发出后的稳定时间(ms)
+        MoveTimeout = 5000,     // 等待移动指令发出的最长时间(ms)
+        SnapTimeout = 5000      // 等待抓拍图像的最长时间(ms)
+    };
+
+    // 序列分段预分配的大小，关闭时截掉未用部分
+    static const qint64 SegmentBytes = Q_INT64_C(512) * 1024 * 1024;
+
+    explicit ZStack(QObject *parent = nullptr);
+
+    // 各层写入原始帧序列 fileName，成功时由 acquired 交给调用方，失败或停止时删除
+    void start(int planes, qint32 step, const QString &fileName);
+    void stop();
+    bool isRunning() const { return m_state != Idle; }
+
+    // move 请求的指令已全部写出串口
+    void moveSent();
+
+    // 交给抓拍得到的静态图像
+    void addFrame(const Frame &frame);
+
+signals:
+    // 请求 Z 轴移动 steps 步，正数为正向
+    void move(qint32 steps);
+    void snap();
+    // 全部层已写入原始帧序列 fileName(按 Z 从小到大排列)，之后由调用方负责删除
+    void acquired(const QString &fileName, int planes);
+    void finished(bool ok, const QString &message);
+    void progress(int done, int total);
+
+private slots:
+    void timeout();
+
+private:
+    enum State
+    {
+        Idle,
+        Moving,
+        Settling,
+        Snapping
+    };
+
+    qint32 planePosition(int index) const { return (index - (m_planes - 1) / 2) * m_step; }
+    void moveTo(qint32 position);
+    void finish(bool ok, const QString &message);
+
+    State             m_state;
+    int               m_planes;
+    qint32            m_step;
+    qint32            m_position;   // 相对起点的步数
+    qint64            m_snapTime;   // 请求抓拍的时刻(ns)，更早到达的图像不属于本层
+    QString           m_fileName;   // 正在写入的原始帧序列
+    RawSequenceWriter m_writer;
+    QTimer*           m_timer;
+};
+
+#endif // ZSTACK_H